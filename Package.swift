@@ -120,13 +120,27 @@ let unsafeFlags = [
 let playAudio = "0"
 // Set to 1 to enable low-pass filter in sample generation.
 let enableLowPassFilter = "0"
+// Set to 1 to skip the low-pass filter when it is fully open with no resonance.
+let enableLowPassFilterBypass = "1"
+// Set to 1 to render in 32-bit floating-point instead of 64-bit. Sample positions are always kept in 64-bit.
+let singlePrecision = "0"
+// Tracing backend: 0 = none, 1 = os_signpost (Apple only), 2 = lock-free ring buffers exported via SF2::Trace::Collector.
+// Off by default: os_signpost is not guaranteed to be real-time safe, and the collector needs the host to drain it.
+let traceBackend = "0"
+// Set to 1 to measure the render cost of voices by pipeline stage, preset, and zone. Adds overhead to every sample.
+let voiceProfiling = "0"
+
+// Apple frameworks are only linked on Apple platforms. Elsewhere the library builds as a plain C++ render core.
+let applePlatforms: [Platform] = [.iOS, .macOS, .tvOS]
 
 let package = Package(
   name: "SF2Lib",
   platforms: [.iOS(.v16), .macOS(.v10_15), .tvOS(.v16)],
   products: [
     .library(name: "SF2Lib", targets: ["SF2Lib"]),
-    .library(name: "Engine", targets: ["Engine"])
+    .library(name: "Engine", targets: ["Engine"]),
+    .executable(name: "SF2Benchmarks", targets: ["SF2Benchmarks"]),
+    .executable(name: "SF2Render", targets: ["SF2Render"])
   ],
   targets: [
     .target(
@@ -134,6 +148,13 @@ let package = Package(
       dependencies: ["SF2Lib"],
       path: "Sources/Engine",
       publicHeadersPath: "include",
+      cxxSettings: [
+        .define("ENABLE_LOWPASS_FILTER", to: enableLowPassFilter, .none),
+        .define("SF2_SINGLE_PRECISION", to: singlePrecision, .none),
+        .define("ENABLE_LOWPASS_FILTER_BYPASS", to: enableLowPassFilterBypass, .none),
+        .define("SF2_TRACE_BACKEND", to: traceBackend, .none),
+        .define("SF2_VOICE_PROFILING", to: voiceProfiling, .none)
+      ],
       swiftSettings: [.interoperabilityMode(.Cxx)]
     ),
     .target(
@@ -150,8 +171,12 @@ let package = Package(
       resources: [.process("Resources")],
       publicHeadersPath: "include",
       cxxSettings: [
-        .define("USE_ACCELERATE", to: "1", .none),
+        .define("USE_ACCELERATE", to: "1", .when(platforms: applePlatforms)),
         .define("ENABLE_LOWPASS_FILTER", to: enableLowPassFilter, .none),
+        .define("SF2_SINGLE_PRECISION", to: singlePrecision, .none),
+        .define("ENABLE_LOWPASS_FILTER_BYPASS", to: enableLowPassFilterBypass, .none),
+        .define("SF2_TRACE_BACKEND", to: traceBackend, .none),
+        .define("SF2_VOICE_PROFILING", to: voiceProfiling, .none),
         // Set to 1 to assert if std::vector[] index is invalid
         .define("CHECKED_VECTOR_INDEXING", to: "0", .none),
         // .unsafeFlags(unsafeFlags)
@@ -160,9 +185,9 @@ let package = Package(
         .define("APPLICATION_EXTENSION_API_ONLY")
       ],
       linkerSettings: [
-        .linkedFramework("Accelerate", .none),
-        .linkedFramework("AudioToolbox", .none),
-        .linkedFramework("AVFoundation", .none),
+        .linkedFramework("Accelerate", .when(platforms: applePlatforms)),
+        .linkedFramework("AudioToolbox", .when(platforms: applePlatforms)),
+        .linkedFramework("AVFoundation", .when(platforms: applePlatforms)),
       ]
     ),
     .target(
@@ -174,15 +199,47 @@ let package = Package(
       cxxSettings: [
         // Set to 1 to play audio in tests. Set to 0 to keep silent.
         .define("ENABLE_LOWPASS_FILTER", to: enableLowPassFilter, .none),
+        .define("SF2_SINGLE_PRECISION", to: singlePrecision, .none),
+        .define("ENABLE_LOWPASS_FILTER_BYPASS", to: enableLowPassFilterBypass, .none),
+        .define("SF2_TRACE_BACKEND", to: traceBackend, .none),
+        .define("SF2_VOICE_PROFILING", to: voiceProfiling, .none),
         .define("PLAY_AUDIO", to: playAudio, .none),
       ]
     ),
+    .executableTarget(
+      name: "SF2Benchmarks",
+      dependencies: ["SF2Lib"],
+      path: "Sources/Benchmarks",
+      cxxSettings: [
+        .define("ENABLE_LOWPASS_FILTER", to: enableLowPassFilter, .none),
+        .define("SF2_SINGLE_PRECISION", to: singlePrecision, .none),
+        .define("ENABLE_LOWPASS_FILTER_BYPASS", to: enableLowPassFilterBypass, .none),
+        .define("SF2_TRACE_BACKEND", to: traceBackend, .none),
+        .define("SF2_VOICE_PROFILING", to: voiceProfiling, .none)
+      ]
+    ),
+    .executableTarget(
+      name: "SF2Render",
+      dependencies: ["SF2Lib"],
+      path: "Sources/Renderer",
+      cxxSettings: [
+        .define("ENABLE_LOWPASS_FILTER", to: enableLowPassFilter, .none),
+        .define("SF2_SINGLE_PRECISION", to: singlePrecision, .none),
+        .define("ENABLE_LOWPASS_FILTER_BYPASS", to: enableLowPassFilterBypass, .none),
+        .define("SF2_TRACE_BACKEND", to: traceBackend, .none),
+        .define("SF2_VOICE_PROFILING", to: voiceProfiling, .none)
+      ]
+    ),
     .testTarget(
       name: "EngineTests",
       dependencies: ["Engine", "TestUtils"],
       cxxSettings: [
         // Set to 1 to play audio in tests. Set to 0 to keep silent.
         .define("ENABLE_LOWPASS_FILTER", to: enableLowPassFilter, .none),
+        .define("SF2_SINGLE_PRECISION", to: singlePrecision, .none),
+        .define("ENABLE_LOWPASS_FILTER_BYPASS", to: enableLowPassFilterBypass, .none),
+        .define("SF2_TRACE_BACKEND", to: traceBackend, .none),
+        .define("SF2_VOICE_PROFILING", to: voiceProfiling, .none),
         .define("PLAY_AUDIO", to: playAudio, .none),
       ]
     ),
@@ -191,6 +248,10 @@ let package = Package(
       dependencies: ["SF2Lib", "TestUtils"],
       cxxSettings: [
         .define("ENABLE_LOWPASS_FILTER", to: enableLowPassFilter, .none),
+        .define("SF2_SINGLE_PRECISION", to: singlePrecision, .none),
+        .define("ENABLE_LOWPASS_FILTER_BYPASS", to: enableLowPassFilterBypass, .none),
+        .define("SF2_TRACE_BACKEND", to: traceBackend, .none),
+        .define("SF2_VOICE_PROFILING", to: voiceProfiling, .none),
         .define("PLAY_AUDIO", to: playAudio, .none),
         .unsafeFlags([
           "-Wno-newline-eof", // resource_bundle_accessor.h is missing newline at end of file
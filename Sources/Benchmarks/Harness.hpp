@@ -0,0 +1,147 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <numeric>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace SF2::Benchmarks {
+
+/// Name/value pairs that describe a benchmark variant or hold extra measurements.
+template <typename T>
+using Fields = std::vector<std::pair<std::string, T>>;
+
+/// Settings that apply to all of the benchmarks in a run.
+struct Options {
+  /// Number of timed iterations of each benchmark
+  size_t iterations{20};
+  /// Number of untimed iterations run before the timed ones
+  size_t warmups{2};
+  /// Only run benchmarks whose name contains this text (all if empty)
+  std::string filter{};
+  /// Directory holding the SF2 files used by the tests
+  std::string resources{"Sources/TestUtils/Resources"};
+  /// Directory in which to write the synthetic SF2 files
+  std::string scratch{"/tmp"};
+  /// Where to write the JSON report (stdout if empty)
+  std::string output{};
+};
+
+/// Summary statistics of a set of timings, all in seconds.
+struct Statistics {
+  double minimum;
+  double median;
+  double mean;
+  double p90;
+  double p99;
+  double maximum;
+
+  /**
+   @param samples the timings to summarize
+   @returns the statistics of the given timings
+   */
+  static Statistics from(std::vector<double> samples) noexcept {
+    if (samples.empty()) return {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double fraction) {
+      return samples[std::min(samples.size() - 1, size_t(fraction * double(samples.size() - 1) + 0.5))];
+    };
+    return {samples.front(), percentile(0.5),
+      std::accumulate(samples.begin(), samples.end(), 0.0) / double(samples.size()), percentile(0.9),
+      percentile(0.99), samples.back()};
+  }
+};
+
+/**
+ Collection of benchmark results that can be written out as JSON. Each entry holds the raw timings of every timed
+ iteration along with their summary statistics so that later runs can be compared with whatever test suits the data.
+ */
+class Report {
+public:
+
+  /// The result of one benchmark.
+  struct Entry {
+    /// Unique name of the benchmark, such as "engine.render"
+    std::string name;
+    /// Values that identify the variant of the benchmark, such as the number of voices
+    Fields<std::string> params;
+    /// Number of items (samples, events, files) processed by one iteration
+    size_t itemsPerIteration;
+    /// The time in seconds of each timed iteration
+    std::vector<double> seconds;
+    /// Additional measurements
+    Fields<double> counters;
+  };
+
+  /**
+   Construct a report.
+
+   @param context values that describe the build and run, such as the floating-point precision
+   */
+  explicit Report(Fields<std::string> context) noexcept : context_{std::move(context)} {}
+
+  /**
+   Add a benchmark result.
+
+   @param entry the result to add
+   */
+  void add(Entry entry) { entries_.push_back(std::move(entry)); }
+
+  /// @returns the results added so far
+  const std::vector<Entry>& entries() const noexcept { return entries_; }
+
+  /**
+   Write the report as a JSON object.
+
+   @param os the stream to write to
+   */
+  void write(std::ostream& os) const;
+
+private:
+  Fields<std::string> context_;
+  std::vector<Entry> entries_{};
+};
+
+/**
+ Time a benchmark body. The body is invoked `warmups` times without timing and then `iterations` times with timing.
+ The body is given the iteration number, counting from 0 across the warmup and timed iterations. Any per-iteration
+ setup that should not be timed must be done by the `setup` function, which is also given the iteration number.
+
+ @param options the iteration counts to use
+ @param setup function to call before each iteration
+ @param body the function to time
+ @returns the duration of each timed iteration in seconds
+ */
+template <typename Setup, typename Body>
+std::vector<double> measure(const Options& options, Setup&& setup, Body&& body) {
+  std::vector<double> seconds;
+  seconds.reserve(options.iterations);
+  for (size_t iteration = 0; iteration < options.warmups + options.iterations; ++iteration) {
+    setup(iteration);
+    auto start = std::chrono::steady_clock::now();
+    body(iteration);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (iteration >= options.warmups) seconds.push_back(elapsed.count());
+  }
+  return seconds;
+}
+
+/**
+ Time a benchmark body that needs no untimed setup.
+
+ @param options the iteration counts to use
+ @param body the function to time
+ @returns the duration of each timed iteration in seconds
+ */
+template <typename Body>
+std::vector<double> measure(const Options& options, Body&& body) {
+  return measure(options, [](size_t) {}, std::forward<Body>(body));
+}
+
+} // end namespace SF2::Benchmarks
@@ -0,0 +1,107 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+
+#include "Harness.hpp"
+
+using namespace SF2::Benchmarks;
+
+namespace {
+
+void
+writeString(std::ostream& os, const std::string& value)
+{
+  os << '"';
+  for (auto c : value) {
+    switch (c) {
+      case '"': os << "\\\""; break;
+      case '\\': os << "\\\\"; break;
+      case '\n': os << "\\n"; break;
+      case '\t': os << "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char buffer[8];
+          std::snprintf(buffer, sizeof(buffer), "\\u%04x", unsigned(c));
+          os << buffer;
+        } else {
+          os << c;
+        }
+    }
+  }
+  os << '"';
+}
+
+void
+writeNumber(std::ostream& os, double value)
+{
+  // JSON has no representation for NaN or infinity
+  if (std::isfinite(value)) {
+    os << value;
+  } else {
+    os << "null";
+  }
+}
+
+template <typename T, typename Writer>
+void
+writeFields(std::ostream& os, const Fields<T>& fields, Writer writer)
+{
+  os << '{';
+  for (size_t index = 0; index < fields.size(); ++index) {
+    if (index > 0) os << ", ";
+    writeString(os, fields[index].first);
+    os << ": ";
+    writer(os, fields[index].second);
+  }
+  os << '}';
+}
+
+} // end namespace
+
+void
+Report::write(std::ostream& os) const
+{
+  auto flags = os.flags();
+  os << std::setprecision(9);
+
+  os << "{\n  \"schema\": 1,\n  \"context\": ";
+  writeFields(os, context_, writeString);
+  os << ",\n  \"benchmarks\": [";
+  for (size_t index = 0; index < entries_.size(); ++index) {
+    const auto& entry{entries_[index]};
+    auto stats = Statistics::from(entry.seconds);
+    auto items = double(entry.itemsPerIteration);
+
+    os << (index > 0 ? ",\n" : "\n") << "    {\"name\": ";
+    writeString(os, entry.name);
+    os << ", \"params\": ";
+    writeFields(os, entry.params, writeString);
+    os << ", \"iterations\": " << entry.seconds.size() << ", \"itemsPerIteration\": " << entry.itemsPerIteration;
+    os << ",\n     \"seconds\": {\"min\": ";
+    writeNumber(os, stats.minimum);
+    os << ", \"median\": ";
+    writeNumber(os, stats.median);
+    os << ", \"mean\": ";
+    writeNumber(os, stats.mean);
+    os << ", \"p90\": ";
+    writeNumber(os, stats.p90);
+    os << ", \"p99\": ";
+    writeNumber(os, stats.p99);
+    os << ", \"max\": ";
+    writeNumber(os, stats.maximum);
+    os << "},\n     \"itemsPerSecond\": ";
+    writeNumber(os, stats.median > 0.0 ? items / stats.median : 0.0);
+    os << ", \"counters\": ";
+    writeFields(os, entry.counters, writeNumber);
+    os << ",\n     \"samples\": [";
+    for (size_t sample = 0; sample < entry.seconds.size(); ++sample) {
+      if (sample > 0) os << ", ";
+      writeNumber(os, entry.seconds[sample]);
+    }
+    os << "]}";
+  }
+  os << "\n  ]\n}\n";
+  os.flags(flags);
+}
@@ -0,0 +1,52 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#pragma once
+
+#include <string>
+
+#include "Harness.hpp"
+
+namespace SF2::Benchmarks {
+
+/// State shared by the benchmark suites.
+struct Context {
+  const Options& options;
+  Report& report;
+
+  /**
+   @param name the name of a benchmark
+   @returns true if the benchmark should run
+   */
+  bool enabled(const std::string& name) const noexcept {
+    return options.filter.empty() || name.find(options.filter) != std::string::npos;
+  }
+
+  /**
+   @param name the name of a SF2 file in the resources directory
+   @returns the path to the file
+   */
+  std::string resource(const std::string& name) const { return options.resources + "/" + name; }
+};
+
+/// File parsing, sample normalization, and preset construction for the test files and synthetic large files.
+void runLoadSuite(Context& context);
+
+/// Note ON handling by the engine with and without voice stealing.
+void runNoteOnSuite(Context& context);
+
+/// Rendering of a single voice with each interpolator.
+void runVoiceSuite(Context& context);
+
+/// Generation of envelope and LFO values.
+void runModulationSuite(Context& context);
+
+/// Modulator updates while the engine handles a storm of MIDI controller changes.
+void runControllerSuite(Context& context);
+
+/// Full engine rendering from 32 to 512 voices.
+void runEngineSuite(Context& context);
+
+/// Throughput of the portable SIMD kernels for each instruction set against the scalar reference.
+void runVectorSuite(Context& context);
+
+} // end namespace SF2::Benchmarks
@@ -0,0 +1,488 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "SF2Lib/Accelerated.hpp"
+#include "SF2Lib/IO/File.hpp"
+#include "SF2Lib/MIDI/ChannelState.hpp"
+#include "SF2Lib/MIDI/MIDI.hpp"
+#include "SF2Lib/Render/Engine/Engine.hpp"
+#include "SF2Lib/Render/Engine/Mixer.hpp"
+#include "SF2Lib/Render/Envelope/Modulation.hpp"
+#include "SF2Lib/Render/Envelope/Volume.hpp"
+#include "SF2Lib/Render/ModLFO.hpp"
+#include "SF2Lib/Render/PresetCollection.hpp"
+#include "SF2Lib/Render/VibLFO.hpp"
+#include "SF2Lib/Render/Voice/Voice.hpp"
+#include "SF2Lib/Portable/SIMD.hpp"
+
+#include "Suites.hpp"
+#include "SyntheticFont.hpp"
+
+using namespace SF2;
+using namespace SF2::Benchmarks;
+using Engine = SF2::Render::Engine::Engine;
+using Mixer = SF2::Render::Engine::Mixer;
+using Interpolator = SF2::Render::Voice::Sample::Interpolator;
+
+namespace {
+
+constexpr Float sampleRate = 48'000.0_F;
+constexpr AUAudioFrameCount framesPerBlock = 512;
+
+/// Number of frames rendered by one iteration of the render benchmarks (about 1 second)
+constexpr size_t framesPerIteration = 94 * framesPerBlock;
+
+/// The file used for the render benchmarks
+const std::string renderFont{"FreeFont.sf2"};
+
+/// Prevents the compiler from removing computations whose results are not otherwise used.
+volatile Float sink;
+
+const char* interpolatorName(Interpolator interpolator) noexcept
+{
+  return interpolator == Interpolator::linear ? "linear" : "cubic4thOrder";
+}
+
+/**
+ Stereo dry, chorus, and reverb busses backed by plain memory, so that rendering does not depend on any audio
+ framework buffers.
+ */
+class Busses {
+public:
+  Busses() : storage_(6 * framesPerBlock, 0.0f) {
+    for (size_t bus = 0; bus < 3; ++bus) {
+      pointers_[bus] = {storage_.data() + (2 * bus) * framesPerBlock, storage_.data() + (2 * bus + 1) * framesPerBlock};
+    }
+  }
+
+  /// @returns new mixer that writes into the busses
+  Mixer mixer() noexcept {
+    return Mixer(DSPHeaders::BusBuffers(pointers_[0]), DSPHeaders::BusBuffers(pointers_[1]),
+                 DSPHeaders::BusBuffers(pointers_[2]));
+  }
+
+  /// Zero all of the samples.
+  void clear() noexcept { std::fill(storage_.begin(), storage_.end(), 0.0f); }
+
+  /// @returns the last sample in the left channel of the dry bus
+  AUValue last() const noexcept { return pointers_[0][0][framesPerBlock - 1]; }
+
+private:
+  std::vector<AUValue> storage_;
+  std::array<std::vector<AUValue*>, 3> pointers_{};
+};
+
+/// File and render presets for benchmarks that drive voices directly.
+struct Font {
+  explicit Font(const std::string& path) : file{path} {
+    file.load();
+    presets.build(file);
+  }
+
+  IO::File file;
+  Render::PresetCollection presets{};
+};
+
+/// Send a note ON without allocating, since it is timed by the note ON benchmarks.
+void noteOn(Engine& engine, int key, int velocity = 100)
+{
+  const std::array<uint8_t, 3> message{valueOf(MIDI::CoreEvent::noteOn), uint8_t(key), uint8_t(velocity)};
+  engine.processMIDIEvent(message);
+}
+
+void allSoundOff(Engine& engine)
+{
+  engine.processMIDIEvent(Engine::createChannelMessage(MIDI::ControlChange::allSoundOff));
+}
+
+std::unique_ptr<Engine> makeEngine(const Context& context, size_t voiceCount, Interpolator interpolator)
+{
+  auto engine = std::make_unique<Engine>(sampleRate, voiceCount, interpolator);
+  engine->processMIDIEvent(Engine::createLoadFileUsePreset(context.resource(renderFont), 0));
+  if (!engine->hasActivePreset()) {
+    std::fprintf(stderr, "failed to load %s\n", context.resource(renderFont).c_str());
+    return nullptr;
+  }
+  return engine;
+}
+
+/**
+ Start notes until the engine has the given number of active voices. A note may start more than one voice.
+
+ @param engine the engine to use
+ @param voiceCount the number of voices to start
+ */
+void fillVoices(Engine& engine, size_t voiceCount)
+{
+  for (int note = 0; engine.activeVoiceCount() < voiceCount && note < 4 * int(Engine::maxVoiceCount); ++note) {
+    noteOn(engine, 21 + note % 88);
+  }
+}
+
+void
+benchmarkLoad(Context& context, const std::string& label, const std::string& path)
+{
+  Fields<std::string> params{{"file", label}};
+  if (context.enabled("load.parse")) {
+    std::unique_ptr<IO::File> file;
+    auto seconds = measure(context.options,
+                           [&](size_t) { file = std::make_unique<IO::File>(path); },
+                           [&](size_t) { file->load(); });
+    auto presetCount = file->loaded() ? file->presets().size() : 0;
+    context.report.add({"load.parse", params, 1, seconds, {{"presets", double(presetCount)}}});
+  }
+
+  // The remaining steps need a valid file.
+  if (IO::File(path).load() != IO::File::LoadResponse::ok) return;
+
+  if (context.enabled("load.normalize")) {
+    std::unique_ptr<IO::File> file;
+    auto seconds = measure(context.options,
+                           [&](size_t) { file = std::make_unique<IO::File>(path); file->load(); },
+                           [&](size_t) { file->sampleSourceCollection(); });
+    auto sampleCount = file->sampleSourceCollection().size();
+    context.report.add({"load.normalize", params, 1, seconds, {{"samples", double(sampleCount)}}});
+  }
+
+  if (context.enabled("load.presets")) {
+    std::unique_ptr<IO::File> file;
+    std::unique_ptr<Render::PresetCollection> presets;
+    auto seconds = measure(context.options,
+                           [&](size_t) {
+      file = std::make_unique<IO::File>(path);
+      file->load();
+      presets = std::make_unique<Render::PresetCollection>();
+    },
+                           [&](size_t) { presets->build(*file); });
+    context.report.add({"load.presets", params, presets->size(), seconds, {}});
+  }
+}
+
+} // end namespace
+
+void
+SF2::Benchmarks::runLoadSuite(Context& context)
+{
+  if (!context.enabled("load.parse") && !context.enabled("load.normalize") && !context.enabled("load.presets")) return;
+
+  // ZZZ1 and ZZZ2 are invalid files, so they only measure how quickly a bad file is rejected.
+  for (const auto& name : {renderFont, std::string("ZZZ1.sf2"), std::string("ZZZ2.sf2")}) {
+    benchmarkLoad(context, name, context.resource(name));
+  }
+
+  const std::array<std::pair<const char*, SyntheticFont>, 2> synthetic{{
+    {"synthetic-medium", {128, 16, 256, 16'384}},
+    {"synthetic-large", {512, 32, 1'024, 32'768}}
+  }};
+  for (const auto& [label, font] : synthetic) {
+    auto path = context.options.scratch + "/SF2Benchmarks-" + label + ".sf2";
+    if (!font.write(path)) {
+      std::fprintf(stderr, "failed to write %s\n", path.c_str());
+      continue;
+    }
+    benchmarkLoad(context, label, path);
+    std::remove(path.c_str());
+  }
+}
+
+void
+SF2::Benchmarks::runNoteOnSuite(Context& context)
+{
+  if (!context.enabled("engine.noteOn")) return;
+
+  // Each note ON is timed on its own so the spread of latencies is visible.
+  auto options{context.options};
+  options.iterations = std::max<size_t>(200, 20 * options.iterations);
+
+  const std::array<std::pair<size_t, bool>, 2> variants{{{Engine::maxVoiceCount, false}, {32, true}}};
+  for (auto [voiceCount, stealing] : variants) {
+    auto engine = makeEngine(context, voiceCount, Interpolator::cubic4thOrder);
+    if (!engine) return;
+    Busses busses;
+    int note = 0;
+    auto seconds = measure(options,
+                           [&](size_t iteration) {
+      // Without stealing, stop all voices well before they run out. With stealing, the engine is always full.
+      if (!stealing && iteration % 32 == 0) allSoundOff(*engine);
+      if (iteration % 8 == 0) {
+        busses.clear();
+        engine->renderInto(busses.mixer(), framesPerBlock);
+      }
+    },
+                           [&](size_t) { noteOn(*engine, 21 + note++ % 88); });
+    context.report.add({"engine.noteOn", {{"voices", std::to_string(voiceCount)},
+      {"stealing", stealing ? "true" : "false"}}, 1, seconds,
+      {{"stolenVoices", double(engine->stolenVoiceCount())}}});
+  }
+}
+
+void
+SF2::Benchmarks::runVoiceSuite(Context& context)
+{
+  if (!context.enabled("voice.render")) return;
+
+  Font font{context.resource(renderFont)};
+  if (font.presets.empty()) return;
+  auto configs = font.presets[0].find(60, 100);
+  if (configs.empty()) return;
+
+  MIDI::ChannelState channelState;
+  for (auto interpolator : {Interpolator::linear, Interpolator::cubic4thOrder}) {
+    Render::Voice::Voice voice{sampleRate, channelState, 0, interpolator};
+    Busses busses;
+    auto mixer{busses.mixer()};
+
+    // Restart the voice for each iteration so that all of them render the same part of the note.
+    auto seconds = measure(context.options,
+                           [&](size_t) {
+      voice.configure(configs[0]);
+      voice.start();
+    },
+                           [&](size_t) {
+      for (size_t frame = 0; frame < framesPerIteration; frame += framesPerBlock) {
+        busses.clear();
+        voice.renderInto(mixer, framesPerBlock);
+      }
+      sink = busses.last();
+    });
+    context.report.add({"voice.render", {{"interpolator", interpolatorName(interpolator)}}, framesPerIteration,
+      seconds, {}});
+  }
+}
+
+void
+SF2::Benchmarks::runModulationSuite(Context& context)
+{
+  Font font{context.resource(renderFont)};
+  if (font.presets.empty()) return;
+  auto configs = font.presets[0].find(60, 100);
+  if (configs.empty()) return;
+
+  // Use the generator values of a real zone to configure the envelopes and LFOs.
+  MIDI::ChannelState channelState;
+  Render::Voice::Voice voice{sampleRate, channelState, 0};
+  voice.configure(configs[0]);
+  auto& state{voice.state()};
+
+  // Gate the envelopes for the first half of each iteration and release them for the second half.
+  auto runEnvelope = [&](const char* name, auto& envelope) {
+    if (!context.enabled(name)) return;
+    auto seconds = measure(context.options,
+                           [&](size_t) {
+      envelope.configure(state);
+      envelope.gate(true);
+    },
+                           [&](size_t) {
+      Float sum = 0_F;
+      for (size_t frame = 0; frame < framesPerIteration; ++frame) {
+        if (frame == framesPerIteration / 2) envelope.gate(false);
+        sum += envelope.getNextValue().val;
+      }
+      sink = sum;
+    });
+    context.report.add({name, {}, framesPerIteration, seconds, {}});
+  };
+
+  Render::Envelope::Volume volume{0};
+  runEnvelope("envelope.volume", volume);
+  Render::Envelope::Modulation modulation{0};
+  runEnvelope("envelope.modulation", modulation);
+
+  auto runLFO = [&](const char* name, auto& lfo) {
+    if (!context.enabled(name)) return;
+    auto seconds = measure(context.options,
+                           [&](size_t) { lfo.configure(state); },
+                           [&](size_t) {
+      Float sum = 0_F;
+      for (size_t frame = 0; frame < framesPerIteration; ++frame) sum += lfo.getNextValue().val;
+      sink = sum;
+    });
+    context.report.add({name, {}, framesPerIteration, seconds, {}});
+  };
+
+  Render::ModLFO modLFO{sampleRate};
+  runLFO("lfo.modulation", modLFO);
+  Render::VibLFO vibLFO{sampleRate};
+  runLFO("lfo.vibrato", vibLFO);
+}
+
+void
+SF2::Benchmarks::runControllerSuite(Context& context)
+{
+  if (!context.enabled("engine.controllerStorm")) return;
+
+  // Controllers that are the sources of default modulators, so every change reaches the voices.
+  const std::array<MIDI::ControlChange, 6> controllers{
+    MIDI::ControlChange::modulationWheelMSB, MIDI::ControlChange::volumeMSB, MIDI::ControlChange::panMSB,
+    MIDI::ControlChange::expressionMSB, MIDI::ControlChange::effectsDepth1, MIDI::ControlChange::effectsDepth3
+  };
+  constexpr size_t eventsPerIteration = 256;
+
+  for (size_t voiceCount : {32, 128}) {
+    auto engine = makeEngine(context, voiceCount, Interpolator::cubic4thOrder);
+    if (!engine) return;
+    Busses busses;
+    size_t activeVoices = 0;
+
+    std::array<uint8_t, 3> message{valueOf(MIDI::CoreEvent::controlChange), 0, 0};
+
+    auto seconds = measure(context.options,
+                           [&](size_t) {
+      fillVoices(*engine, voiceCount);
+      busses.clear();
+      engine->renderInto(busses.mixer(), framesPerBlock);
+      activeVoices = std::max(activeVoices, engine->activeVoiceCount());
+    },
+                           [&](size_t iteration) {
+      for (size_t index = 0; index < eventsPerIteration; ++index) {
+        message[1] = valueOf(controllers[index % controllers.size()]);
+        // Alternate values so that every event is a change.
+        message[2] = uint8_t((index / controllers.size() + iteration) % 2 == 0 ? 32 : 96);
+        engine->processMIDIEvent(message);
+      }
+    });
+    context.report.add({"engine.controllerStorm", {{"voices", std::to_string(voiceCount)}}, eventsPerIteration,
+      seconds, {{"activeVoices", double(activeVoices)}}});
+  }
+}
+
+void
+SF2::Benchmarks::runEngineSuite(Context& context)
+{
+  if (!context.enabled("engine.render")) return;
+
+  for (auto interpolator : {Interpolator::linear, Interpolator::cubic4thOrder}) {
+    for (size_t voiceCount : {32, 64, 128, 256, 512}) {
+
+      // An engine supports at most `Engine::maxVoiceCount` voices, so larger counts are spread over several engines
+      // rendering into the same busses, as a host would do with several instances.
+      auto engineCount = (voiceCount + Engine::maxVoiceCount - 1) / Engine::maxVoiceCount;
+      std::vector<std::unique_ptr<Engine>> engines;
+      for (size_t index = 0; index < engineCount; ++index) {
+        engines.push_back(makeEngine(context, voiceCount / engineCount, interpolator));
+        if (!engines.back()) return;
+      }
+
+      Busses busses;
+      size_t activeVoices = 0;
+      auto seconds = measure(context.options,
+                             [&](size_t) {
+        activeVoices = 0;
+        for (auto& engine : engines) {
+          allSoundOff(*engine);
+          fillVoices(*engine, engine->voiceCount());
+          activeVoices += engine->activeVoiceCount();
+        }
+      },
+                             [&](size_t) {
+        for (size_t frame = 0; frame < framesPerIteration; frame += framesPerBlock) {
+          busses.clear();
+          for (auto& engine : engines) engine->renderInto(busses.mixer(), framesPerBlock);
+        }
+        sink = busses.last();
+      });
+      context.report.add({"engine.render", {{"voices", std::to_string(voiceCount)},
+        {"interpolator", interpolatorName(interpolator)}, {"engines", std::to_string(engineCount)}},
+        framesPerIteration, seconds, {{"activeVoices", double(activeVoices)}}});
+    }
+  }
+}
+
+namespace {
+
+#if SF2_ACCELERATE == 1
+
+/// @returns kernels that call the Accelerate routines picked by `Accelerated`, so that vDSP is measured too.
+Portable::Kernels<Float> acceleratedKernels() noexcept
+{
+  using A = Accelerated<Float>;
+  return {
+    [](const int16_t* a, long as, Float* d, long ds, unsigned long n) noexcept { A::conversionProc(a, as, d, ds, n); },
+    [](const int16_t* a, long as, const Float* s, Float* d, long ds, unsigned long n) noexcept {
+      A::conversionScaleProc(a, as, s, d, ds, n); },
+    [](const Float* a, long as, const Float* s, Float* d, long ds, unsigned long n) noexcept {
+      A::scaleProc(a, as, s, d, ds, n); },
+    [](const Float* a, long as, Float* r, unsigned long n) noexcept { A::magnitudeProc(a, as, r, n); },
+    [](const Float* a, long as, const Float* b, long bs, Float* d, long ds, unsigned long n) noexcept {
+      A::addProc(a, as, b, bs, d, ds, n); },
+    [](const Float* a, long as, const Float* s, const Float* b, long bs, Float* d, long ds, unsigned long n) noexcept {
+      A::scaleAddProc(a, as, s, b, bs, d, ds, n); },
+    [](const Float* a, long as, float* d, long ds, unsigned long n) noexcept { A::narrowProc(a, as, d, ds, n); }
+  };
+}
+
+#endif
+
+} // end namespace
+
+void
+SF2::Benchmarks::runVectorSuite(Context& context)
+{
+  // Work on render-sized blocks over a buffer that fits in L2, repeated to get times well above the clock resolution.
+  constexpr size_t bufferSize = 16 * framesPerBlock;
+  constexpr size_t passes = 64;
+  constexpr size_t itemsPerIteration = passes * bufferSize;
+
+  std::vector<int16_t> raw(bufferSize);
+  std::vector<Float> first(bufferSize), second(bufferSize), destination(bufferSize);
+  std::vector<float> narrowed(bufferSize);
+  for (size_t index = 0; index < bufferSize; ++index) {
+    raw[index] = int16_t((index * 7'919) % 65'536 - 32'768);
+    first[index] = Float(raw[index]) / 32'768_F;
+    second[index] = first[(index * 31) % bufferSize];
+  }
+
+  std::vector<std::pair<std::string, Portable::Kernels<Float>>> variants;
+  for (auto instructionSet : {Portable::InstructionSet::scalar, Portable::InstructionSet::sse2,
+    Portable::InstructionSet::avx2, Portable::InstructionSet::neon}) {
+    if (auto kernels = Portable::kernels<Float>(instructionSet)) variants.emplace_back(Portable::name(instructionSet),
+                                                                                       *kernels);
+  }
+#if SF2_ACCELERATE == 1
+  variants.emplace_back("accelerate", acceleratedKernels());
+#endif
+
+  const Float gain = 0.5_F;
+  using Kernel = std::function<void(const Portable::Kernels<Float>&, size_t)>;
+  const std::vector<std::pair<std::string, Kernel>> kernels{
+    {"vector.convertScale", [&](const auto& kernels, size_t offset) {
+      kernels.convertScale(raw.data() + offset, 1, &gain, destination.data() + offset, 1, framesPerBlock); }},
+    {"vector.magnitude", [&](const auto& kernels, size_t offset) {
+      Float peak; kernels.magnitude(first.data() + offset, 1, &peak, framesPerBlock); sink = peak; }},
+    {"vector.scale", [&](const auto& kernels, size_t offset) {
+      kernels.scale(first.data() + offset, 1, &gain, destination.data() + offset, 1, framesPerBlock); }},
+    {"vector.add", [&](const auto& kernels, size_t offset) {
+      kernels.add(first.data() + offset, 1, second.data() + offset, 1, destination.data() + offset, 1,
+                  framesPerBlock); }},
+    {"vector.scaleAdd", [&](const auto& kernels, size_t offset) {
+      kernels.scaleAdd(first.data() + offset, 1, &gain, second.data() + offset, 1, destination.data() + offset, 1,
+                       framesPerBlock); }},
+    {"vector.narrow", [&](const auto& kernels, size_t offset) {
+      kernels.narrow(first.data() + offset, 1, narrowed.data() + offset, 1, framesPerBlock); }}
+  };
+
+  for (const auto& [name, kernel] : kernels) {
+    if (!context.enabled(name)) continue;
+    double scalarMedian = 0.0;
+    for (const auto& [variant, implementation] : variants) {
+      auto seconds = measure(context.options, [&](size_t) {
+        for (size_t pass = 0; pass < passes; ++pass) {
+          for (size_t offset = 0; offset < bufferSize; offset += framesPerBlock) kernel(implementation, offset);
+        }
+        sink = destination[bufferSize - 1];
+      });
+
+      // The scalar kernels are always first, so every variant reports its speedup over them.
+      auto median = Statistics::from(seconds).median;
+      if (scalarMedian == 0.0) scalarMedian = median;
+      context.report.add({name, {{"kernels", variant}}, itemsPerIteration, seconds,
+        {{"speedup", median > 0.0 ? scalarMedian / median : 0.0}}});
+    }
+  }
+}
@@ -0,0 +1,37 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace SF2::Benchmarks {
+
+/**
+ Writer of SF2 files with a chosen number of presets, zones, and samples. The files are valid but musically useless:
+ every preset uses its own instrument, whose zones split the keyboard evenly and play looped sine waves. They let the
+ loading and rendering benchmarks run against files that are much larger than the ones kept with the tests.
+ */
+struct SyntheticFont {
+  /// Number of presets (and instruments) in the file
+  size_t presetCount;
+  /// Number of zones in each instrument
+  size_t zonesPerInstrument;
+  /// Number of samples in the file
+  size_t sampleCount;
+  /// Number of frames in each sample
+  size_t sampleFrames;
+
+  /// @returns the number of bytes of sample data in the file
+  size_t sampleDataSize() const noexcept;
+
+  /**
+   Write the SF2 file.
+
+   @param path the location of the file to write
+   @returns true if successful
+   */
+  bool write(const std::string& path) const;
+};
+
+} // end namespace SF2::Benchmarks
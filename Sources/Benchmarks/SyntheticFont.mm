@@ -0,0 +1,199 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <numbers>
+#include <vector>
+
+#include "SF2Lib/Entity/Generator/Index.hpp"
+#include "SF2Lib/Entity/SampleHeader.hpp"
+
+#include "SyntheticFont.hpp"
+
+using namespace SF2::Benchmarks;
+using Index = SF2::Entity::Generator::Index;
+
+namespace {
+
+/// Number of zero frames that the SF2 spec requires after each sample
+constexpr size_t sampleGuardFrames = 46;
+
+/// Number of frames in one cycle of the sine wave, which is 441 Hz at 44.1 kHz (close enough to A4)
+constexpr size_t cycleFrames = 100;
+
+/// Little-endian byte buffer for building chunks.
+struct Bytes : std::vector<char> {
+  void u8(uint8_t value) { push_back(char(value)); }
+  void u16(uint16_t value) { u8(uint8_t(value)); u8(uint8_t(value >> 8)); }
+  void u32(uint32_t value) { u16(uint16_t(value)); u16(uint16_t(value >> 16)); }
+  void tag(const char* value) { insert(end(), value, value + 4); }
+
+  void name(const std::string& value) {
+    char buffer[20] = {};
+    std::strncpy(buffer, value.c_str(), sizeof(buffer) - 1);
+    insert(end(), buffer, buffer + sizeof(buffer));
+  }
+
+  void chunk(const char* tagName, const Bytes& content) {
+    tag(tagName);
+    u32(uint32_t(content.size()));
+    insert(end(), content.begin(), content.end());
+    if (content.size() & 1) u8(0);
+  }
+
+  void list(const char* kind, const Bytes& content) {
+    tag("LIST");
+    u32(uint32_t(content.size() + 4));
+    tag(kind);
+    insert(end(), content.begin(), content.end());
+  }
+
+  void generator(Index index, uint16_t amount) {
+    u16(uint16_t(SF2::valueOf(index)));
+    u16(amount);
+  }
+
+  void modulatorTerminal() { insert(end(), 10, char(0)); }
+};
+
+} // end namespace
+
+size_t
+SyntheticFont::sampleDataSize() const noexcept
+{
+  return sampleCount * (sampleFrames + sampleGuardFrames) * sizeof(int16_t);
+}
+
+bool
+SyntheticFont::write(const std::string& path) const
+{
+  if (presetCount == 0 || zonesPerInstrument == 0 || zonesPerInstrument > 128 || sampleCount == 0 ||
+      sampleFrames < cycleFrames) return false;
+
+  Bytes info;
+  {
+    Bytes version;
+    version.u16(2);
+    version.u16(1);
+    info.chunk("ifil", version);
+    Bytes engine;
+    engine.insert(engine.end(), "EMU8000", "EMU8000" + 8);
+    info.chunk("isng", engine);
+    Bytes name;
+    auto title = "Synthetic " + std::to_string(presetCount) + "x" + std::to_string(zonesPerInstrument);
+    name.insert(name.end(), title.c_str(), title.c_str() + title.size() + 1);
+    info.chunk("INAM", name);
+  }
+
+  Bytes phdr, pbag, pmod, pgen, inst, ibag, imod, igen, shdr;
+  for (size_t preset = 0; preset < presetCount; ++preset) {
+    phdr.name("Preset " + std::to_string(preset));
+    phdr.u16(uint16_t(preset % 128));
+    phdr.u16(uint16_t(preset / 128));
+    phdr.u16(uint16_t(preset));
+    phdr.u32(0);
+    phdr.u32(0);
+    phdr.u32(0);
+    pbag.u16(uint16_t(pgen.size() / 4));
+    pbag.u16(0);
+    pgen.generator(Index::instrument, uint16_t(preset));
+
+    inst.name("Instrument " + std::to_string(preset));
+    inst.u16(uint16_t(ibag.size() / 4));
+    for (size_t zone = 0; zone < zonesPerInstrument; ++zone) {
+      auto low = zone * 128 / zonesPerInstrument;
+      auto high = (zone + 1) * 128 / zonesPerInstrument - 1;
+      ibag.u16(uint16_t(igen.size() / 4));
+      ibag.u16(0);
+      igen.generator(Index::keyRange, uint16_t(low | (high << 8)));
+      igen.generator(Index::sampleModes, 1);
+      igen.generator(Index::sampleID, uint16_t((preset * zonesPerInstrument + zone) % sampleCount));
+    }
+  }
+
+  // Terminal records
+  phdr.name("EOP");
+  phdr.u16(0);
+  phdr.u16(0);
+  phdr.u16(uint16_t(pbag.size() / 4));
+  phdr.u32(0);
+  phdr.u32(0);
+  phdr.u32(0);
+  pbag.u16(uint16_t(pgen.size() / 4));
+  pbag.u16(0);
+  pmod.modulatorTerminal();
+  pgen.u32(0);
+  inst.name("EOI");
+  inst.u16(uint16_t(ibag.size() / 4));
+  ibag.u16(uint16_t(igen.size() / 4));
+  ibag.u16(0);
+  imod.modulatorTerminal();
+  igen.u32(0);
+
+  auto loopFrames = sampleFrames / cycleFrames * cycleFrames;
+  for (size_t sample = 0; sample < sampleCount; ++sample) {
+    auto start = uint32_t(sample * (sampleFrames + sampleGuardFrames));
+    shdr.name("Sample " + std::to_string(sample));
+    shdr.u32(start);
+    shdr.u32(uint32_t(start + sampleFrames));
+    shdr.u32(start);
+    shdr.u32(uint32_t(start + loopFrames));
+    shdr.u32(44'100);
+    shdr.u8(69);
+    shdr.u8(0);
+    shdr.u16(0);
+    shdr.u16(SF2::valueOf(SF2::Entity::SampleHeader::Type::monoSample));
+  }
+  shdr.name("EOS");
+  shdr.insert(shdr.end(), 26, char(0));
+
+  Bytes pdta;
+  pdta.chunk("phdr", phdr);
+  pdta.chunk("pbag", pbag);
+  pdta.chunk("pmod", pmod);
+  pdta.chunk("pgen", pgen);
+  pdta.chunk("inst", inst);
+  pdta.chunk("ibag", ibag);
+  pdta.chunk("imod", imod);
+  pdta.chunk("igen", igen);
+  pdta.chunk("shdr", shdr);
+
+  // The sample data is large, so it is written directly to the file instead of being assembled in memory.
+  Bytes head;
+  head.list("INFO", info);
+  auto sampleBytes = sampleDataSize();
+  Bytes sdtaHead;
+  sdtaHead.tag("LIST");
+  sdtaHead.u32(uint32_t(sampleBytes + 12));
+  sdtaHead.tag("sdta");
+  sdtaHead.tag("smpl");
+  sdtaHead.u32(uint32_t(sampleBytes));
+  Bytes tail;
+  tail.list("pdta", pdta);
+
+  Bytes riff;
+  riff.tag("RIFF");
+  riff.u32(uint32_t(4 + head.size() + sdtaHead.size() + sampleBytes + tail.size()));
+  riff.tag("sfbk");
+
+  std::ofstream os(path, std::ios::binary | std::ios::trunc);
+  if (!os) return false;
+  os.write(riff.data(), std::streamsize(riff.size()));
+  os.write(head.data(), std::streamsize(head.size()));
+  os.write(sdtaHead.data(), std::streamsize(sdtaHead.size()));
+
+  Bytes frames;
+  for (size_t frame = 0; frame < sampleFrames; ++frame) {
+    auto phase = 2.0 * std::numbers::pi * double(frame % cycleFrames) / double(cycleFrames);
+    frames.u16(uint16_t(int16_t(std::lround(std::sin(phase) * 16'000.0))));
+  }
+  frames.insert(frames.end(), sampleGuardFrames * sizeof(int16_t), char(0));
+  for (size_t sample = 0; sample < sampleCount; ++sample) {
+    os.write(frames.data(), std::streamsize(frames.size()));
+  }
+
+  os.write(tail.data(), std::streamsize(tail.size()));
+  return bool(os);
+}
@@ -0,0 +1,101 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "SF2Lib/Accelerated.hpp"
+#include "SF2Lib/Types.hpp"
+
+#include "Harness.hpp"
+#include "Suites.hpp"
+
+using namespace SF2::Benchmarks;
+
+namespace {
+
+void
+usage(const char* program)
+{
+  std::fprintf(stderr,
+               "usage: %s [options]\n"
+               "  --iterations N   number of timed iterations per benchmark (default 20)\n"
+               "  --warmups N      number of untimed iterations per benchmark (default 2)\n"
+               "  --filter TEXT    only run benchmarks whose name contains TEXT\n"
+               "  --resources DIR  directory holding FreeFont.sf2, ZZZ1.sf2, and ZZZ2.sf2\n"
+               "  --scratch DIR    directory for the synthetic SF2 files (default /tmp)\n"
+               "  --output PATH    write the JSON report to PATH instead of stdout\n",
+               program);
+}
+
+bool
+parse(int argc, const char* argv[], Options& options)
+{
+  for (int index = 1; index < argc; ++index) {
+    std::string flag{argv[index]};
+    if (flag == "--help" || flag == "-h" || index + 1 == argc) return false;
+    std::string value{argv[++index]};
+    if (flag == "--iterations") options.iterations = std::strtoul(value.c_str(), nullptr, 10);
+    else if (flag == "--warmups") options.warmups = std::strtoul(value.c_str(), nullptr, 10);
+    else if (flag == "--filter") options.filter = value;
+    else if (flag == "--resources") options.resources = value;
+    else if (flag == "--scratch") options.scratch = value;
+    else if (flag == "--output") options.output = value;
+    else return false;
+  }
+  return options.iterations > 0;
+}
+
+} // end namespace
+
+/**
+ Run the SF2Lib benchmarks and write the results as JSON. Only plain memory is used for audio buffers, so nothing here
+ depends on XCTest or AVFoundation.
+ */
+int
+main(int argc, const char* argv[])
+{
+  Options options;
+  if (!parse(argc, argv, options)) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  // The library logs to stdout while loading files. Send that to stderr so that stdout only holds the report.
+  auto stdoutBuffer = std::cout.rdbuf(std::cerr.rdbuf());
+
+  Report report{{
+    {"precision", std::is_same_v<SF2::Float, float> ? "float" : "double"},
+    {"lowPassFilter", ENABLE_LOWPASS_FILTER == 1 ? "enabled" : "disabled"},
+    {"voiceProfiling", SF2_VOICE_PROFILING == 1 ? "enabled" : "disabled"},
+    {"vectorKernels", SF2_ACCELERATE == 1 ? "accelerate" : SF2::Portable::name(SF2::Portable::bestInstructionSet())},
+    {"compiler", __VERSION__}
+  }};
+  Context context{options, report};
+
+  runLoadSuite(context);
+  runNoteOnSuite(context);
+  runVoiceSuite(context);
+  runModulationSuite(context);
+  runControllerSuite(context);
+  runEngineSuite(context);
+  runVectorSuite(context);
+
+  if (options.output.empty()) {
+    std::ostream os{stdoutBuffer};
+    report.write(os);
+  } else {
+    std::ofstream os{options.output};
+    report.write(os);
+    if (!os) {
+      std::fprintf(stderr, "failed to write %s\n", options.output.c_str());
+      return 1;
+    }
+  }
+
+  std::cout.rdbuf(stdoutBuffer);
+  return 0;
+}
@@ -32,6 +32,15 @@ SF2Engine::processAndRender(const AudioTimeStamp *timestamp, UInt32 frameCount,
   return impl_->processAndRender(timestamp, frameCount, outputBusNumber, output, realtimeEventListHead, pullInputBlock);
 }
 
+AUAudioUnitStatus
+SF2Engine::processAndRender(const AudioTimeStamp *timestamp, UInt32 frameCount, NSInteger outputBusNumber,
+                              AudioBufferList *output, const AURenderEvent *realtimeEventListHead,
+                              AURenderPullInputBlock pullInputBlock, AudioUnitRenderActionFlags *actionFlags)
+{
+  return impl_->processAndRender(timestamp, frameCount, outputBusNumber, output, realtimeEventListHead, pullInputBlock,
+                                 actionFlags);
+}
+
 std::string
 SF2Engine::activePresetName() const noexcept
 {
@@ -86,6 +95,35 @@ SF2Engine::activeVoiceCount() const noexcept
   return impl_->activeVoiceCount();
 }
 
+SF2EngineTelemetry
+SF2Engine::telemetry() const noexcept
+{
+  auto snapshot = impl_->telemetry().snapshot();
+  return SF2EngineTelemetry{
+    snapshot.blockCount,
+    snapshot.idleBlockCount,
+    snapshot.overrunCount,
+    snapshot.renderTimeP50,
+    snapshot.renderTimeP90,
+    snapshot.renderTimeP99,
+    snapshot.renderTimeMaximum,
+    snapshot.peakActiveVoiceCount,
+    snapshot.averageActiveVoiceCount,
+    snapshot.stolenVoiceCount,
+    snapshot.culledVoiceCount,
+    snapshot.droppedNoteOnCount,
+    snapshot.midiEventCount,
+    snapshot.peakMIDIEventsPerBlock,
+    snapshot.averageMIDIEventsPerBlock
+  };
+}
+
+void
+SF2Engine::resetTelemetry() noexcept
+{
+  impl_->resetTelemetry();
+}
+
 bool
 SF2Engine::monophonicModeEnabled() const noexcept
 {
@@ -115,3 +153,9 @@ SF2Engine::retriggerModeEnabled() const noexcept
 {
   return impl_->retriggerModeEnabled();
 }
+
+bool
+SF2Engine::multiTimbralModeEnabled() const noexcept
+{
+  return impl_->multiTimbralModeEnabled();
+}
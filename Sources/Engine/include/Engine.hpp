@@ -3,6 +3,7 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -21,6 +22,29 @@ namespace IO { class File; }
 namespace Render { namespace Engine { class Engine; } }
 }
 
+/**
+ Runtime statistics of the engine. See `SF2::Render::Engine::Telemetry::Snapshot` for a description of the values.
+ Render times are in seconds.
+ */
+struct SF2EngineTelemetry
+{
+  uint64_t blockCount;
+  uint64_t idleBlockCount;
+  uint64_t overrunCount;
+  double renderTimeP50;
+  double renderTimeP90;
+  double renderTimeP99;
+  double renderTimeMaximum;
+  size_t peakActiveVoiceCount;
+  double averageActiveVoiceCount;
+  uint64_t stolenVoiceCount;
+  uint64_t culledVoiceCount;
+  uint64_t droppedNoteOnCount;
+  uint64_t midiEventCount;
+  size_t peakMIDIEventsPerBlock;
+  double averageMIDIEventsPerBlock;
+};
+
 /**
  Wrapper class for the SF2::Render::Engine that exposes a minimal API for Swift/C++ bridging. This perhaps better
  belongs in its own package.
@@ -69,6 +93,23 @@ struct SF2Engine
                                      AudioBufferList* output, const AURenderEvent* realtimeEventListHead,
                                      AURenderPullInputBlock pullInputBlock);
 
+  /**
+   Request to render samples and report silence to the host. Same as above, but when the engine has nothing to play,
+   `kAudioUnitRenderAction_OutputIsSilence` is added to `actionFlags` so that the host can skip the output.
+
+   @param timestamp the point in time for the rendering to take place
+   @param frameCount the number of frames to render
+   @param outputBusNumber the bus that is being rendered to
+   @param output the audio buffer to write to. Note that this might not contain the actual samples buffers to use
+   @param realtimeEventListHead the list of events to process in order of timestamps when they should take place
+   @param pullInputBlock ignored by the SF2 engine
+   @param actionFlags the render flags from the host
+   @returns result of the call
+   */
+  AUAudioUnitStatus processAndRender(const AudioTimeStamp* timestamp, UInt32 frameCount, NSInteger outputBusNumber,
+                                     AudioBufferList* output, const AURenderEvent* realtimeEventListHead,
+                                     AURenderPullInputBlock pullInputBlock, AudioUnitRenderActionFlags* actionFlags);
+
   /**
    Obtain the name of the active preset being used by the engine. This will be an empty string ("") for the case where
    there is no active preset.
@@ -81,6 +122,12 @@ struct SF2Engine
   /// @returns current number of active voices
   size_t activeVoiceCount() const noexcept;
 
+  /// @returns the runtime statistics of the engine. Safe to call from any thread.
+  SF2EngineTelemetry telemetry() const noexcept;
+
+  /// Clear the runtime statistics of the engine.
+  void resetTelemetry() noexcept;
+
   /**
    Obtain an `NSData` instance containing a MIDI SYSEX command that can be sent to load an SF2 file and use a given
    preset. This should be sent to the engine via a MIDI control connection; this method only creates the bytes to send.
@@ -145,6 +192,8 @@ struct SF2Engine
   bool oneVoicePerKeyModeEnabled() const noexcept;
   /// @returns true if `retrigger` mode is enabled.
   bool retriggerModeEnabled() const noexcept;
+  /// @returns true if multi-timbral mode is enabled.
+  bool multiTimbralModeEnabled() const noexcept;
 
 private:
   std::shared_ptr<SF2::Render::Engine::Engine> impl_;
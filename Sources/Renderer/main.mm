@@ -0,0 +1,140 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "SF2Lib/Render/Engine/OfflineRenderer.hpp"
+
+using namespace SF2;
+using OfflineRenderer = SF2::Render::Engine::OfflineRenderer;
+using Format = SF2::IO::AudioFileWriter::Format;
+using Interpolator = SF2::Render::Voice::Sample::Interpolator;
+
+namespace {
+
+void
+usage(const char* program)
+{
+  std::fprintf(stderr,
+               "usage: %s --soundfont PATH [options] MIDI...\n"
+               "  --soundfont PATH    the SF2 file to render with\n"
+               "  --output DIR        directory for the audio files (default .)\n"
+               "  --format FORMAT     wav16, wav32, raw16, or raw32 (default wav16)\n"
+               "  --sample-rate N     sample rate of the audio (default 44100)\n"
+               "  --voices N          maximum number of voices per file (default 128)\n"
+               "  --interpolator I    linear or cubic (default cubic)\n"
+               "  --block N           frames rendered per pass (default 4096)\n"
+               "  --tail SECONDS      longest time to render after the last event (default 5)\n"
+               "  --preset N          index of the preset to start all channels with (default 0)\n"
+               "  --jobs N            number of files to render at the same time (default: one per CPU)\n",
+               program);
+}
+
+struct Arguments {
+  std::string soundFont{};
+  std::string output{"."};
+  size_t jobs{0};
+  OfflineRenderer::Options options{};
+  std::vector<std::string> midiPaths{};
+};
+
+bool
+parse(int argc, const char* argv[], Arguments& arguments)
+{
+  for (int index = 1; index < argc; ++index) {
+    std::string flag{argv[index]};
+    if (flag.rfind("--", 0) != 0) {
+      arguments.midiPaths.push_back(flag);
+      continue;
+    }
+    if (flag == "--help" || index + 1 == argc) return false;
+    std::string value{argv[++index]};
+    auto& options{arguments.options};
+    if (flag == "--soundfont") arguments.soundFont = value;
+    else if (flag == "--output") arguments.output = value;
+    else if (flag == "--jobs") arguments.jobs = std::strtoul(value.c_str(), nullptr, 10);
+    else if (flag == "--sample-rate") options.sampleRate = Float(std::strtod(value.c_str(), nullptr));
+    else if (flag == "--voices") options.voiceCount = std::strtoul(value.c_str(), nullptr, 10);
+    else if (flag == "--block") options.blockSize = AUAudioFrameCount(std::strtoul(value.c_str(), nullptr, 10));
+    else if (flag == "--tail") options.tailSeconds = std::strtod(value.c_str(), nullptr);
+    else if (flag == "--preset") options.presetIndex = std::strtoul(value.c_str(), nullptr, 10);
+    else if (flag == "--interpolator" && value == "linear") options.interpolator = Interpolator::linear;
+    else if (flag == "--interpolator" && value == "cubic") options.interpolator = Interpolator::cubic4thOrder;
+    else if (flag == "--format" && value == "wav16") options.format = Format::wav16;
+    else if (flag == "--format" && value == "wav32") options.format = Format::wavFloat;
+    else if (flag == "--format" && value == "raw16") options.format = Format::raw16;
+    else if (flag == "--format" && value == "raw32") options.format = Format::rawFloat;
+    else return false;
+  }
+  const auto& options{arguments.options};
+  return !arguments.soundFont.empty() && !arguments.midiPaths.empty() && options.sampleRate > 0_F &&
+  options.voiceCount > 0 && options.voiceCount <= Render::Engine::Synthesizer::maxVoiceCount && options.blockSize > 0;
+}
+
+/// @returns the path of the audio file for a MIDI file: its name with a new extension in the output directory
+std::string
+outputPath(const Arguments& arguments, const std::string& midiPath)
+{
+  auto slash = midiPath.find_last_of('/');
+  auto name = slash == std::string::npos ? midiPath : midiPath.substr(slash + 1);
+  auto dot = name.find_last_of('.');
+  if (dot != std::string::npos && dot > 0) name.resize(dot);
+  return arguments.output + "/" + name + "." + IO::AudioFileWriter::extension(arguments.options.format);
+}
+
+} // end namespace
+
+/**
+ Render Standard MIDI Files to audio files as fast as possible. All files share one loaded SoundFont and are rendered
+ in parallel, each by its own engine.
+ */
+int
+main(int argc, const char* argv[])
+{
+  Arguments arguments;
+  if (!parse(argc, argv, arguments)) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  // The library logs to stdout while loading files, so keep stdout for the summary by sending that to stderr.
+  auto stdoutBuffer = std::cout.rdbuf(std::cerr.rdbuf());
+
+  IO::File::LoadResponse response;
+  auto soundFont = Render::SoundFont::load(arguments.soundFont, response);
+  if (!soundFont) {
+    std::fprintf(stderr, "failed to load %s\n", arguments.soundFont.c_str());
+    return 1;
+  }
+
+  std::vector<OfflineRenderer::Job> jobs;
+  for (const auto& midiPath : arguments.midiPaths) jobs.push_back({midiPath, outputPath(arguments, midiPath)});
+
+  auto start = std::chrono::steady_clock::now();
+  auto results = OfflineRenderer::renderFiles(soundFont, arguments.options, jobs, arguments.jobs);
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  std::cout.rdbuf(stdoutBuffer);
+
+  int failures = 0;
+  double audioSeconds = 0.0;
+  for (size_t index = 0; index < jobs.size(); ++index) {
+    const auto& result{results[index]};
+    if (!result.ok) {
+      ++failures;
+      std::fprintf(stderr, "%s: %s\n", jobs[index].midiPath.c_str(), result.error.c_str());
+      continue;
+    }
+    auto seconds = double(result.frameCount) / double(arguments.options.sampleRate);
+    audioSeconds += seconds;
+    std::printf("%s: %.2fs of audio in %.3fs (%.1fx real-time)\n", jobs[index].outputPath.c_str(), seconds,
+                result.renderSeconds, result.renderSeconds > 0.0 ? seconds / result.renderSeconds : 0.0);
+  }
+  std::printf("%zu files, %.2fs of audio in %.3fs (%.1fx real-time)\n", jobs.size() - size_t(failures), audioSeconds,
+              elapsed.count(), elapsed.count() > 0.0 ? audioSeconds / elapsed.count() : 0.0);
+  return failures == 0 ? 0 : 1;
+}
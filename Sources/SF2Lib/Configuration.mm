@@ -1,5 +1,7 @@
 // Copyright © 2022 Brad Howes. All rights reserved.
 
+#if defined(__APPLE__)
+
 #include "SF2Lib/Configuration.hpp"
 
 @implementation Configuration
@@ -99,3 +101,5 @@ static dispatch_once_t onceToken;
 }
 
 @end
+
+#endif
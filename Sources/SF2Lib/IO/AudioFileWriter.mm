@@ -0,0 +1,108 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "SF2Lib/IO/AudioFileWriter.hpp"
+
+using namespace SF2::IO;
+
+namespace {
+
+constexpr uint16_t channelCount = 2;
+
+/// Append a value in little-endian order, which is the byte order of all RIFF values.
+template <typename T>
+void append(std::vector<char>& buffer, T value) {
+  for (size_t index = 0; index < sizeof(T); ++index) buffer.push_back(char((uint64_t(value) >> (8 * index)) & 0xFF));
+}
+
+} // end namespace
+
+bool
+AudioFileWriter::open() noexcept
+{
+  os_.open(path_, std::ios::binary | std::ios::trunc);
+  if (!os_) return false;
+  frameCount_ = 0;
+  if (isWAV()) writeHeader(0);
+  return bool(os_);
+}
+
+void
+AudioFileWriter::writeHeader(uint64_t frameCount)
+{
+  uint16_t bytesPerSample = isFloat() ? 4 : 2;
+  // Sizes are 32-bit values, so a file that is too large has a header that claims the maximum size.
+  auto dataSize = uint32_t(std::min<uint64_t>(frameCount * channelCount * bytesPerSample, 0xFFFF'FFFFu - 36));
+  std::vector<char> header;
+  header.insert(header.end(), {'R', 'I', 'F', 'F'});
+  append(header, uint32_t(36 + dataSize));
+  header.insert(header.end(), {'W', 'A', 'V', 'E', 'f', 'm', 't', ' '});
+  append(header, uint32_t(16));
+  append(header, uint16_t(isFloat() ? 3 : 1)); // WAVE_FORMAT_IEEE_FLOAT or WAVE_FORMAT_PCM
+  append(header, channelCount);
+  append(header, sampleRate_);
+  append(header, uint32_t(sampleRate_ * channelCount * bytesPerSample));
+  append(header, uint16_t(channelCount * bytesPerSample));
+  append(header, uint16_t(8 * bytesPerSample));
+  header.insert(header.end(), {'d', 'a', 't', 'a'});
+  append(header, dataSize);
+  os_.write(header.data(), std::streamsize(header.size()));
+}
+
+bool
+AudioFileWriter::write(const AUValue* left, const AUValue* right, size_t frameCount) noexcept
+{
+  if (!os_.is_open()) return false;
+  buffer_.clear();
+  if (isFloat()) {
+    buffer_.resize(frameCount * channelCount * sizeof(float));
+    auto ptr = buffer_.data();
+    for (size_t frame = 0; frame < frameCount; ++frame) {
+      float pair[channelCount] = {float(left[frame]), float(right[frame])};
+      std::memcpy(ptr, pair, sizeof(pair));
+      ptr += sizeof(pair);
+    }
+  } else {
+    buffer_.resize(frameCount * channelCount * sizeof(int16_t));
+    auto ptr = buffer_.data();
+    auto quantize = [](AUValue value) {
+      return int16_t(std::lrint(std::clamp(double(value), -1.0, 1.0) * 32'767.0));
+    };
+    for (size_t frame = 0; frame < frameCount; ++frame) {
+      int16_t pair[channelCount] = {quantize(left[frame]), quantize(right[frame])};
+      std::memcpy(ptr, pair, sizeof(pair));
+      ptr += sizeof(pair);
+    }
+  }
+  os_.write(buffer_.data(), std::streamsize(buffer_.size()));
+  frameCount_ += frameCount;
+  return bool(os_);
+}
+
+bool
+AudioFileWriter::close() noexcept
+{
+  if (!os_.is_open()) return true;
+  if (isWAV()) {
+    os_.seekp(0);
+    writeHeader(frameCount_);
+  }
+  bool ok = bool(os_);
+  os_.close();
+  return ok && !os_.fail();
+}
+
+const char*
+AudioFileWriter::extension(Format format) noexcept
+{
+  switch (format) {
+    case Format::wav16:
+    case Format::wavFloat: return "wav";
+    case Format::raw16:
+    case Format::rawFloat: return "raw";
+  }
+  return "raw";
+}
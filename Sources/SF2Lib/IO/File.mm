@@ -1,5 +1,8 @@
 // Copyright © 2022 Brad Howes. All rights reserved.
 
+#include <cassert>
+#include <fcntl.h>
+#include <unistd.h>
 #include <fstream>
 #include <iostream>
 #include <map>
@@ -124,8 +127,7 @@ File::extractNormalizedSamples() {
     auto sampleCount = std::min(remainingSamples, batchSampleCount);
     remainingSamples -= sampleCount;
     pos = pos.readInto(rawSamples.data(), sampleCount * sizeof(int16_t));
-    Accelerated<Float>::conversionProc(rawSamples.data(), 1, ptr, 1, sampleCount);
-    Accelerated<Float>::scaleProc(ptr, 1, &normalizationScale, ptr, 1, sampleCount);
+    Accelerated<Float>::conversionScaleProc(rawSamples.data(), 1, &normalizationScale, ptr, 1, sampleCount);
     ptr += sampleCount;
   }
 }
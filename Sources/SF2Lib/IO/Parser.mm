@@ -1,5 +1,7 @@
 // Copyright © 2022 Brad Howes. All rights reserved.
 
+#include <fcntl.h>
+#include <unistd.h>
 #include <string>
 
 #include "SF2Lib/Entity/Preset.hpp"
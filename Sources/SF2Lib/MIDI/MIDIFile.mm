@@ -0,0 +1,200 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+#include "SF2Lib/MIDI/MIDIFile.hpp"
+
+using namespace SF2::MIDI;
+
+namespace {
+
+/// Bounds-checked reader of big-endian SMF data. Running off the end throws `LoadResponse::invalidFormat`.
+class Reader {
+public:
+  explicit Reader(std::span<const uint8_t> data) noexcept : data_{data} {}
+
+  bool atEnd() const noexcept { return pos_ >= data_.size(); }
+
+  uint8_t u8() {
+    if (atEnd()) throw MIDIFile::LoadResponse::invalidFormat;
+    return data_[pos_++];
+  }
+
+  uint8_t peek() const {
+    if (atEnd()) throw MIDIFile::LoadResponse::invalidFormat;
+    return data_[pos_];
+  }
+
+  uint16_t u16() { auto high = u8(); return uint16_t((high << 8) | u8()); }
+  uint32_t u32() { auto high = u16(); return (uint32_t(high) << 16) | u16(); }
+
+  /// @returns a variable-length quantity of at most four bytes
+  uint32_t vlq() {
+    uint32_t value = 0;
+    for (int count = 0; count < 4; ++count) {
+      auto byte = u8();
+      value = (value << 7) | (byte & 0x7F);
+      if (!(byte & 0x80)) return value;
+    }
+    throw MIDIFile::LoadResponse::invalidFormat;
+  }
+
+  std::span<const uint8_t> take(size_t count) {
+    if (count > data_.size() - pos_) throw MIDIFile::LoadResponse::invalidFormat;
+    auto span = data_.subspan(pos_, count);
+    pos_ += count;
+    return span;
+  }
+
+private:
+  std::span<const uint8_t> data_;
+  size_t pos_{0};
+};
+
+/// An event as found in a track, timed in ticks.
+struct TickEvent {
+  uint64_t tick;
+  uint32_t offset;
+  uint32_t size;
+};
+
+/// A change in the number of microseconds per quarter note.
+struct TempoChange {
+  uint64_t tick;
+  uint32_t microsecondsPerQuarter;
+};
+
+/// @returns the number of data bytes that follow a channel message status byte
+size_t dataByteCount(uint8_t status) noexcept {
+  auto kind = status & 0xF0;
+  return (kind == 0xC0 || kind == 0xD0) ? 1 : 2;
+}
+
+} // end namespace
+
+MIDIFile::LoadResponse
+MIDIFile::load() noexcept
+{
+  std::ifstream is(path_, std::ios::binary);
+  if (!is) return LoadResponse::notFound;
+  std::vector<uint8_t> data{std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>()};
+  return parse(data);
+}
+
+MIDIFile::LoadResponse
+MIDIFile::parse(std::span<const uint8_t> data) noexcept
+{
+  events_.clear();
+  messages_.clear();
+  duration_ = 0.0;
+
+  std::vector<TickEvent> tickEvents;
+  std::vector<TempoChange> tempoChanges;
+  uint64_t lastTick = 0;
+  uint16_t division = 0;
+
+  try {
+    Reader file{data};
+    if (file.u32() != 0x4D546864 /* MThd */) throw LoadResponse::invalidFormat;
+    auto headerSize = file.u32();
+    if (headerSize < 6) throw LoadResponse::invalidFormat;
+    auto body = Reader{file.take(headerSize)};
+    format_ = body.u16();
+    trackCount_ = body.u16();
+    division = body.u16();
+    // Format 2 tracks are independent sequences, not parts to play together. SMPTE timing needs ticks per frame.
+    if (format_ > 1 || division == 0) throw LoadResponse::invalidFormat;
+    if ((division & 0x8000) && (division & 0xFF) == 0) throw LoadResponse::invalidFormat;
+
+    for (size_t track = 0; track < trackCount_; ) {
+      auto tag = file.u32();
+      auto chunk = Reader{file.take(file.u32())};
+      // Unknown chunks are skipped and do not count as tracks.
+      if (tag != 0x4D54726B /* MTrk */) continue;
+      ++track;
+
+      uint64_t tick = 0;
+      uint8_t runningStatus = 0;
+      while (!chunk.atEnd()) {
+        tick += chunk.vlq();
+        auto status = chunk.peek();
+        if (status & 0x80) {
+          chunk.u8();
+        } else if (runningStatus != 0) {
+          status = runningStatus;
+        } else {
+          throw LoadResponse::invalidFormat;
+        }
+
+        if (status == 0xFF) {
+          runningStatus = 0;
+          auto type = chunk.u8();
+          auto payload = chunk.take(chunk.vlq());
+          if (type == 0x51 && payload.size() == 3) {
+            tempoChanges.push_back({tick, (uint32_t(payload[0]) << 16) | (uint32_t(payload[1]) << 8) | payload[2]});
+          } else if (type == 0x2F) {
+            break;
+          }
+        } else if (status == 0xF0) {
+          runningStatus = 0;
+          auto payload = chunk.take(chunk.vlq());
+          tickEvents.push_back({tick, uint32_t(messages_.size()), uint32_t(payload.size() + 1)});
+          messages_.push_back(status);
+          messages_.insert(messages_.end(), payload.begin(), payload.end());
+          if (payload.empty() || payload.back() != 0xF7) {
+            messages_.push_back(0xF7);
+            ++tickEvents.back().size;
+          }
+        } else if (status == 0xF7) {
+          runningStatus = 0;
+          chunk.take(chunk.vlq());
+        } else if (status >= 0xF0) {
+          // System common and real-time messages have no place in a file.
+          throw LoadResponse::invalidFormat;
+        } else {
+          runningStatus = status;
+          auto count = dataByteCount(status);
+          tickEvents.push_back({tick, uint32_t(messages_.size()), uint32_t(count + 1)});
+          messages_.push_back(status);
+          for (size_t index = 0; index < count; ++index) messages_.push_back(chunk.u8() & 0x7F);
+        }
+      }
+      lastTick = std::max(lastTick, tick);
+    }
+  } catch (LoadResponse) {
+    events_.clear();
+    messages_.clear();
+    return LoadResponse::invalidFormat;
+  }
+
+  // Tracks were read one after the other, so a stable sort puts events of the same tick in track order.
+  auto byTick = [](auto& lhs, auto& rhs) { return lhs.tick < rhs.tick; };
+  std::stable_sort(tickEvents.begin(), tickEvents.end(), byTick);
+  std::stable_sort(tempoChanges.begin(), tempoChanges.end(), byTick);
+
+  // Walk the tempo map alongside the events. The default tempo is 120 BPM.
+  auto secondsAt = [&, tempoIndex = size_t(0), baseTick = uint64_t(0), baseSeconds = 0.0,
+                    microseconds = uint32_t(500'000)](uint64_t tick) mutable {
+    if (division & 0x8000) {
+      // SMPTE timing: the upper byte is the negative frame rate (-29 means 29.97) and the lower the ticks per frame.
+      auto framesPerSecond = -int8_t(division >> 8);
+      auto rate = framesPerSecond == 29 ? 29.97 : double(framesPerSecond);
+      return double(tick) / (rate * double(division & 0xFF));
+    }
+    auto secondsPerTick = [&] { return microseconds / 1.0e6 / double(division); };
+    while (tempoIndex < tempoChanges.size() && tempoChanges[tempoIndex].tick <= tick) {
+      baseSeconds += double(tempoChanges[tempoIndex].tick - baseTick) * secondsPerTick();
+      baseTick = tempoChanges[tempoIndex].tick;
+      microseconds = tempoChanges[tempoIndex].microsecondsPerQuarter;
+      ++tempoIndex;
+    }
+    return baseSeconds + double(tick - baseTick) * secondsPerTick();
+  };
+
+  events_.reserve(tickEvents.size());
+  for (const auto& event : tickEvents) events_.push_back({secondsAt(event.tick), event.offset, event.size});
+  duration_ = secondsAt(std::max(lastTick, tickEvents.empty() ? 0 : tickEvents.back().tick));
+  return LoadResponse::ok;
+}
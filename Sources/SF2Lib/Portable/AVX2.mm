@@ -0,0 +1,94 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+#include <immintrin.h>
+
+#include "SF2Lib/Portable/Scalar.hpp"
+#include "SF2Lib/Portable/SIMD.hpp"
+
+// Everything that follows is compiled for AVX2, including the loops in Kernels.hpp. The library itself is not, so
+// these kernels are only used after `bestInstructionSet` has found AVX2 support in the CPU.
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+#include "Kernels.hpp"
+
+using namespace SF2::Portable;
+
+namespace {
+
+/// AVX2 operations on eight floats.
+struct FloatOps {
+  using Value = float;
+  using Vector = __m256;
+  static constexpr unsigned long width = 8;
+
+  static Vector load(const float* source) noexcept { return _mm256_loadu_ps(source); }
+  static void store(float* destination, Vector value) noexcept { _mm256_storeu_ps(destination, value); }
+  static Vector splat(float value) noexcept { return _mm256_set1_ps(value); }
+  static Vector add(Vector lhs, Vector rhs) noexcept { return _mm256_add_ps(lhs, rhs); }
+  static Vector mul(Vector lhs, Vector rhs) noexcept { return _mm256_mul_ps(lhs, rhs); }
+  static Vector abs(Vector value) noexcept { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), value); }
+  static Vector max(Vector lhs, Vector rhs) noexcept { return _mm256_max_ps(lhs, rhs); }
+
+  static float reduceMax(Vector value) noexcept {
+    auto half = _mm_max_ps(_mm256_castps256_ps128(value), _mm256_extractf128_ps(value, 1));
+    half = _mm_max_ps(half, _mm_movehl_ps(half, half));
+    half = _mm_max_ss(half, _mm_shuffle_ps(half, half, 1));
+    return _mm_cvtss_f32(half);
+  }
+
+  static Vector convert(const int16_t* source) noexcept {
+    auto words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+    return _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(words));
+  }
+
+  static void storeNarrow(float* destination, Vector value) noexcept { store(destination, value); }
+};
+
+/// AVX2 operations on four doubles.
+struct DoubleOps {
+  using Value = double;
+  using Vector = __m256d;
+  static constexpr unsigned long width = 4;
+
+  static Vector load(const double* source) noexcept { return _mm256_loadu_pd(source); }
+  static void store(double* destination, Vector value) noexcept { _mm256_storeu_pd(destination, value); }
+  static Vector splat(double value) noexcept { return _mm256_set1_pd(value); }
+  static Vector add(Vector lhs, Vector rhs) noexcept { return _mm256_add_pd(lhs, rhs); }
+  static Vector mul(Vector lhs, Vector rhs) noexcept { return _mm256_mul_pd(lhs, rhs); }
+  static Vector abs(Vector value) noexcept { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), value); }
+  static Vector max(Vector lhs, Vector rhs) noexcept { return _mm256_max_pd(lhs, rhs); }
+
+  static double reduceMax(Vector value) noexcept {
+    auto half = _mm_max_pd(_mm256_castpd256_pd128(value), _mm256_extractf128_pd(value, 1));
+    return _mm_cvtsd_f64(_mm_max_sd(half, _mm_unpackhi_pd(half, half)));
+  }
+
+  static Vector convert(const int16_t* source) noexcept {
+    auto words = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(source));
+    return _mm256_cvtepi32_pd(_mm_cvtepi16_epi32(words));
+  }
+
+  static void storeNarrow(float* destination, Vector value) noexcept {
+    _mm_storeu_ps(destination, _mm256_cvtpd_ps(value));
+  }
+};
+
+} // end namespace
+
+const Kernels<float> SF2::Portable::avx2FloatKernels = Loops::make<FloatOps>();
+const Kernels<double> SF2::Portable::avx2DoubleKernels = Loops::make<DoubleOps>();
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif
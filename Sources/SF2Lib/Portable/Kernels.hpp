@@ -0,0 +1,150 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#pragma once
+
+#include <cstring>
+
+#include "SF2Lib/Portable/Scalar.hpp"
+#include "SF2Lib/Portable/SIMD.hpp"
+
+/**
+ Vector loops shared by the instruction sets. Each loop is written in terms of an `Ops` type that wraps the intrinsics
+ of one instruction set for one floating-point type:
+
+ - `Value` -- the floating-point type
+ - `Vector` -- the SIMD register type
+ - `width` -- the number of values in a `Vector`
+ - `load`, `store`, `splat`, `add`, `mul`, `abs`, `max` -- the usual vector operations
+ - `reduceMax` -- the largest value held in a `Vector`
+ - `convert` -- load `width` 16-bit integers and convert them into a `Vector`
+ - `storeNarrow` -- store a `Vector` as `width` 32-bit floats
+
+ The loops are templates so that each instruction set file instantiates them with its own target options in effect.
+ Values left over after the last full vector are handled by the scalar code.
+ */
+namespace SF2::Portable::Loops {
+
+template <typename Ops>
+void convert(const int16_t* source, long sourceStride, typename Ops::Value* destination, long destinationStride,
+             unsigned long count) noexcept
+{
+  if (sourceStride != 1 || destinationStride != 1) {
+    return Scalar::convert(source, sourceStride, destination, destinationStride, count);
+  }
+  unsigned long index = 0;
+  for (; index + Ops::width <= count; index += Ops::width) {
+    Ops::store(destination + index, Ops::convert(source + index));
+  }
+  Scalar::convert(source + index, 1, destination + index, 1, count - index);
+}
+
+template <typename Ops>
+void convertScale(const int16_t* source, long sourceStride, const typename Ops::Value* scalar,
+                  typename Ops::Value* destination, long destinationStride, unsigned long count) noexcept
+{
+  if (sourceStride != 1 || destinationStride != 1) {
+    return Scalar::convertScale(source, sourceStride, scalar, destination, destinationStride, count);
+  }
+  auto factor = Ops::splat(*scalar);
+  unsigned long index = 0;
+  for (; index + Ops::width <= count; index += Ops::width) {
+    Ops::store(destination + index, Ops::mul(Ops::convert(source + index), factor));
+  }
+  Scalar::convertScale(source + index, 1, scalar, destination + index, 1, count - index);
+}
+
+template <typename Ops>
+void scale(const typename Ops::Value* source, long sourceStride, const typename Ops::Value* scalar,
+           typename Ops::Value* destination, long destinationStride, unsigned long count) noexcept
+{
+  if (sourceStride != 1 || destinationStride != 1) {
+    return Scalar::scale(source, sourceStride, scalar, destination, destinationStride, count);
+  }
+  auto factor = Ops::splat(*scalar);
+  unsigned long index = 0;
+  for (; index + Ops::width <= count; index += Ops::width) {
+    Ops::store(destination + index, Ops::mul(Ops::load(source + index), factor));
+  }
+  Scalar::scale(source + index, 1, scalar, destination + index, 1, count - index);
+}
+
+template <typename Ops>
+void magnitude(const typename Ops::Value* source, long sourceStride, typename Ops::Value* result,
+               unsigned long count) noexcept
+{
+  if (sourceStride != 1 || count < Ops::width) return Scalar::magnitude(source, sourceStride, result, count);
+  auto peak = Ops::splat(0);
+  unsigned long index = 0;
+  for (; index + Ops::width <= count; index += Ops::width) {
+    peak = Ops::max(peak, Ops::abs(Ops::load(source + index)));
+  }
+  Scalar::magnitude(source + index, 1, result, count - index);
+  *result = std::max(*result, Ops::reduceMax(peak));
+}
+
+template <typename Ops>
+void add(const typename Ops::Value* first, long firstStride, const typename Ops::Value* second, long secondStride,
+         typename Ops::Value* destination, long destinationStride, unsigned long count) noexcept
+{
+  if (firstStride != 1 || secondStride != 1 || destinationStride != 1) {
+    return Scalar::add(first, firstStride, second, secondStride, destination, destinationStride, count);
+  }
+  unsigned long index = 0;
+  for (; index + Ops::width <= count; index += Ops::width) {
+    Ops::store(destination + index, Ops::add(Ops::load(first + index), Ops::load(second + index)));
+  }
+  Scalar::add(first + index, 1, second + index, 1, destination + index, 1, count - index);
+}
+
+template <typename Ops>
+void scaleAdd(const typename Ops::Value* first, long firstStride, const typename Ops::Value* scalar,
+              const typename Ops::Value* second, long secondStride, typename Ops::Value* destination,
+              long destinationStride, unsigned long count) noexcept
+{
+  if (firstStride != 1 || secondStride != 1 || destinationStride != 1) {
+    return Scalar::scaleAdd(first, firstStride, scalar, second, secondStride, destination, destinationStride, count);
+  }
+  auto factor = Ops::splat(*scalar);
+  unsigned long index = 0;
+  for (; index + Ops::width <= count; index += Ops::width) {
+    Ops::store(destination + index, Ops::add(Ops::mul(Ops::load(first + index), factor),
+                                             Ops::load(second + index)));
+  }
+  Scalar::scaleAdd(first + index, 1, scalar, second + index, 1, destination + index, 1, count - index);
+}
+
+template <typename Ops>
+void narrow(const typename Ops::Value* source, long sourceStride, float* destination, long destinationStride,
+            unsigned long count) noexcept
+{
+  if (sourceStride != 1 || destinationStride != 1) {
+    return Scalar::narrow(source, sourceStride, destination, destinationStride, count);
+  }
+  unsigned long index = 0;
+  for (; index + Ops::width <= count; index += Ops::width) {
+    Ops::storeNarrow(destination + index, Ops::load(source + index));
+  }
+  Scalar::narrow(source + index, 1, destination + index, 1, count - index);
+}
+
+/// @returns the kernels that use the loops above with the given operations
+template <typename Ops>
+constexpr Kernels<typename Ops::Value> make() noexcept
+{
+  return {convert<Ops>, convertScale<Ops>, scale<Ops>, magnitude<Ops>, add<Ops>, scaleAdd<Ops>, narrow<Ops>};
+}
+
+} // end namespace SF2::Portable::Loops
+
+namespace SF2::Portable {
+
+// The kernels of each instruction set, defined in the file of the same name when the architecture supports it.
+
+extern const Kernels<float> sse2FloatKernels;
+extern const Kernels<double> sse2DoubleKernels;
+extern const Kernels<float> avx2FloatKernels;
+extern const Kernels<double> avx2DoubleKernels;
+extern const Kernels<float> neonFloatKernels;
+extern const Kernels<double> neonDoubleKernels;
+
+} // end namespace SF2::Portable
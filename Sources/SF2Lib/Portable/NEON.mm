@@ -0,0 +1,60 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+
+#include <arm_neon.h>
+
+#include "Kernels.hpp"
+
+using namespace SF2::Portable;
+
+namespace {
+
+/// NEON operations on four floats. NEON is part of every ARM64 CPU so no runtime check is needed.
+struct FloatOps {
+  using Value = float;
+  using Vector = float32x4_t;
+  static constexpr unsigned long width = 4;
+
+  static Vector load(const float* source) noexcept { return vld1q_f32(source); }
+  static void store(float* destination, Vector value) noexcept { vst1q_f32(destination, value); }
+  static Vector splat(float value) noexcept { return vdupq_n_f32(value); }
+  static Vector add(Vector lhs, Vector rhs) noexcept { return vaddq_f32(lhs, rhs); }
+  static Vector mul(Vector lhs, Vector rhs) noexcept { return vmulq_f32(lhs, rhs); }
+  static Vector abs(Vector value) noexcept { return vabsq_f32(value); }
+  static Vector max(Vector lhs, Vector rhs) noexcept { return vmaxq_f32(lhs, rhs); }
+  static float reduceMax(Vector value) noexcept { return vmaxvq_f32(value); }
+  static Vector convert(const int16_t* source) noexcept { return vcvtq_f32_s32(vmovl_s16(vld1_s16(source))); }
+  static void storeNarrow(float* destination, Vector value) noexcept { store(destination, value); }
+};
+
+/// NEON operations on two doubles.
+struct DoubleOps {
+  using Value = double;
+  using Vector = float64x2_t;
+  static constexpr unsigned long width = 2;
+
+  static Vector load(const double* source) noexcept { return vld1q_f64(source); }
+  static void store(double* destination, Vector value) noexcept { vst1q_f64(destination, value); }
+  static Vector splat(double value) noexcept { return vdupq_n_f64(value); }
+  static Vector add(Vector lhs, Vector rhs) noexcept { return vaddq_f64(lhs, rhs); }
+  static Vector mul(Vector lhs, Vector rhs) noexcept { return vmulq_f64(lhs, rhs); }
+  static Vector abs(Vector value) noexcept { return vabsq_f64(value); }
+  static Vector max(Vector lhs, Vector rhs) noexcept { return vmaxq_f64(lhs, rhs); }
+  static double reduceMax(Vector value) noexcept { return vmaxvq_f64(value); }
+
+  static Vector convert(const int16_t* source) noexcept {
+    // Only two values may be read, so build the 32-bit lanes directly instead of loading four 16-bit values.
+    const int32_t pair[2] = {source[0], source[1]};
+    return vcvtq_f64_s64(vmovl_s32(vld1_s32(pair)));
+  }
+
+  static void storeNarrow(float* destination, Vector value) noexcept { vst1_f32(destination, vcvt_f32_f64(value)); }
+};
+
+} // end namespace
+
+const Kernels<float> SF2::Portable::neonFloatKernels = Loops::make<FloatOps>();
+const Kernels<double> SF2::Portable::neonDoubleKernels = Loops::make<DoubleOps>();
+
+#endif
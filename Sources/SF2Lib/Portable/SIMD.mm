@@ -0,0 +1,77 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#include "Kernels.hpp"
+
+using namespace SF2::Portable;
+
+namespace {
+
+template <std::floating_point T>
+constexpr Kernels<T> scalarKernels{Scalar::convert<T>, Scalar::convertScale<T>, Scalar::scale<T>,
+  Scalar::magnitude<T>, Scalar::add<T>, Scalar::scaleAdd<T>, Scalar::narrow<T>};
+
+bool
+cpuHasAVX2() noexcept
+{
+#if (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(__clang__))
+  // This may run during static initialization, before the compiler runtime has looked at the CPU.
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+#else
+  return false;
+#endif
+}
+
+template <std::floating_point T>
+const Kernels<T>*
+select(const Kernels<float>& floatKernels, const Kernels<double>& doubleKernels) noexcept
+{
+  if constexpr (std::is_same_v<T, float>) return &floatKernels;
+  else return &doubleKernels;
+}
+
+} // end namespace
+
+template <std::floating_point T>
+const Kernels<T>*
+SF2::Portable::kernels(InstructionSet instructionSet) noexcept
+{
+  switch (instructionSet) {
+    case InstructionSet::scalar: return &scalarKernels<T>;
+#if defined(__x86_64__) || defined(_M_X64)
+    case InstructionSet::sse2: return select<T>(sse2FloatKernels, sse2DoubleKernels);
+    case InstructionSet::avx2: return cpuHasAVX2() ? select<T>(avx2FloatKernels, avx2DoubleKernels) : nullptr;
+#endif
+#if defined(__aarch64__) || defined(_M_ARM64)
+    case InstructionSet::neon: return select<T>(neonFloatKernels, neonDoubleKernels);
+#endif
+    default: return nullptr;
+  }
+}
+
+template const Kernels<float>* SF2::Portable::kernels<float>(InstructionSet) noexcept;
+template const Kernels<double>* SF2::Portable::kernels<double>(InstructionSet) noexcept;
+
+InstructionSet
+SF2::Portable::bestInstructionSet() noexcept
+{
+  static const InstructionSet best = []() noexcept {
+    for (auto instructionSet : {InstructionSet::avx2, InstructionSet::sse2, InstructionSet::neon}) {
+      if (available(instructionSet)) return instructionSet;
+    }
+    return InstructionSet::scalar;
+  }();
+  return best;
+}
+
+const char*
+SF2::Portable::name(InstructionSet instructionSet) noexcept
+{
+  switch (instructionSet) {
+    case InstructionSet::scalar: return "scalar";
+    case InstructionSet::sse2: return "sse2";
+    case InstructionSet::avx2: return "avx2";
+    case InstructionSet::neon: return "neon";
+  }
+  return "unknown";
+}
@@ -0,0 +1,76 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+#include <emmintrin.h>
+
+#include "Kernels.hpp"
+
+using namespace SF2::Portable;
+
+namespace {
+
+/// SSE2 operations on four floats. SSE2 is part of every x86-64 CPU so no runtime check is needed.
+struct FloatOps {
+  using Value = float;
+  using Vector = __m128;
+  static constexpr unsigned long width = 4;
+
+  static Vector load(const float* source) noexcept { return _mm_loadu_ps(source); }
+  static void store(float* destination, Vector value) noexcept { _mm_storeu_ps(destination, value); }
+  static Vector splat(float value) noexcept { return _mm_set1_ps(value); }
+  static Vector add(Vector lhs, Vector rhs) noexcept { return _mm_add_ps(lhs, rhs); }
+  static Vector mul(Vector lhs, Vector rhs) noexcept { return _mm_mul_ps(lhs, rhs); }
+  static Vector abs(Vector value) noexcept { return _mm_andnot_ps(_mm_set1_ps(-0.0f), value); }
+  static Vector max(Vector lhs, Vector rhs) noexcept { return _mm_max_ps(lhs, rhs); }
+
+  static float reduceMax(Vector value) noexcept {
+    value = _mm_max_ps(value, _mm_movehl_ps(value, value));
+    value = _mm_max_ss(value, _mm_shuffle_ps(value, value, 1));
+    return _mm_cvtss_f32(value);
+  }
+
+  static Vector convert(const int16_t* source) noexcept {
+    auto words = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(source));
+    // Place each 16-bit value in the upper half of a 32-bit lane and shift it down to sign-extend it.
+    return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(words, words), 16));
+  }
+
+  static void storeNarrow(float* destination, Vector value) noexcept { store(destination, value); }
+};
+
+/// SSE2 operations on two doubles.
+struct DoubleOps {
+  using Value = double;
+  using Vector = __m128d;
+  static constexpr unsigned long width = 2;
+
+  static Vector load(const double* source) noexcept { return _mm_loadu_pd(source); }
+  static void store(double* destination, Vector value) noexcept { _mm_storeu_pd(destination, value); }
+  static Vector splat(double value) noexcept { return _mm_set1_pd(value); }
+  static Vector add(Vector lhs, Vector rhs) noexcept { return _mm_add_pd(lhs, rhs); }
+  static Vector mul(Vector lhs, Vector rhs) noexcept { return _mm_mul_pd(lhs, rhs); }
+  static Vector abs(Vector value) noexcept { return _mm_andnot_pd(_mm_set1_pd(-0.0), value); }
+  static Vector max(Vector lhs, Vector rhs) noexcept { return _mm_max_pd(lhs, rhs); }
+  static double reduceMax(Vector value) noexcept {
+    return _mm_cvtsd_f64(_mm_max_sd(value, _mm_unpackhi_pd(value, value)));
+  }
+
+  static Vector convert(const int16_t* source) noexcept {
+    int32_t pair;
+    std::memcpy(&pair, source, sizeof(pair));
+    auto words = _mm_cvtsi32_si128(pair);
+    return _mm_cvtepi32_pd(_mm_srai_epi32(_mm_unpacklo_epi16(words, words), 16));
+  }
+
+  static void storeNarrow(float* destination, Vector value) noexcept {
+    _mm_storel_pi(reinterpret_cast<__m64*>(destination), _mm_cvtpd_ps(value));
+  }
+};
+
+} // end namespace
+
+const Kernels<float> SF2::Portable::sse2FloatKernels = Loops::make<FloatOps>();
+const Kernels<double> SF2::Portable::sse2DoubleKernels = Loops::make<DoubleOps>();
+
+#endif
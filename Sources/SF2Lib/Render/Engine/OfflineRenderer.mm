@@ -0,0 +1,118 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include "SF2Lib/Render/Engine/OfflineRenderer.hpp"
+
+using namespace SF2::Render::Engine;
+
+OfflineRenderer::OfflineRenderer(std::shared_ptr<const SoundFont> soundFont, Options options) :
+soundFont_{std::move(soundFont)},
+options_{options},
+synthesizer_{std::make_unique<Synthesizer>(options.sampleRate, options.voiceCount, options.interpolator)},
+left_(options.blockSize),
+right_(options.blockSize),
+dry_{left_.data(), right_.data()}
+{
+  synthesizer_->setParameter(valueOf(Parameters::EngineParameterAddress::multiTimbralModeEnabled), 1);
+}
+
+void
+OfflineRenderer::prepare()
+{
+  // Start each file from the same state, whatever the previous one left behind.
+  synthesizer_->processMIDIEvent(Synthesizer::createResetCommand());
+  synthesizer_->useSoundFont(soundFont_, options_.presetIndex);
+  synthesizer_->resetTelemetry();
+}
+
+uint64_t
+OfflineRenderer::render(const MIDI::MIDIFile& midiFile, const Sink& sink)
+{
+  prepare();
+
+  const auto sampleRate = double(options_.sampleRate);
+  const auto& events{midiFile.events()};
+  auto frameOf = [sampleRate](double seconds) { return uint64_t(std::llround(seconds * sampleRate)); };
+  const auto endFrame = frameOf(midiFile.duration());
+  const auto tailFrame = endFrame + frameOf(options_.tailSeconds);
+  const auto blockSize = options_.blockSize;
+
+  size_t next = 0;
+  uint64_t frame = 0;
+  while (next < events.size() || frame < endFrame ||
+         (synthesizer_->activeVoiceCount() > 0 && frame < tailFrame)) {
+    std::fill(left_.begin(), left_.end(), 0.0f);
+    std::fill(right_.begin(), right_.end(), 0.0f);
+
+    // Gather the events that fall in this block and let the synthesizer split the render at their frames.
+    blockEvents_.clear();
+    for (; next < events.size() && frameOf(events[next].seconds) < frame + blockSize; ++next) {
+      auto offset = AUAudioFrameCount(frameOf(events[next].seconds) - frame);
+      blockEvents_.push_back(RenderEvent::midi(offset, midiFile.message(events[next])));
+    }
+    synthesizer_->render(blockEvents_, Mixer(DSPHeaders::BusBuffers(dry_), DSPHeaders::BusBuffers(none_),
+                                             DSPHeaders::BusBuffers(none_)), blockSize);
+
+    frame += blockSize;
+    if (!sink(left_.data(), right_.data(), blockSize)) break;
+  }
+
+  return frame;
+}
+
+OfflineRenderer::Result
+OfflineRenderer::renderFile(const std::string& midiPath, const std::string& outputPath)
+{
+  Result result;
+  MIDI::MIDIFile midiFile{midiPath};
+  switch (midiFile.load()) {
+    case MIDI::MIDIFile::LoadResponse::ok: break;
+    case MIDI::MIDIFile::LoadResponse::notFound: result.error = "MIDI file not found: " + midiPath; return result;
+    case MIDI::MIDIFile::LoadResponse::invalidFormat: result.error = "invalid MIDI file: " + midiPath; return result;
+  }
+
+  IO::AudioFileWriter writer{outputPath, options_.format, uint32_t(std::lround(options_.sampleRate))};
+  if (!writer.open()) {
+    result.error = "unable to create " + outputPath;
+    return result;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  result.frameCount = render(midiFile, [&writer](const AUValue* left, const AUValue* right, AUAudioFrameCount count) {
+    return writer.write(left, right, count);
+  });
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  result.renderSeconds = elapsed.count();
+
+  result.ok = writer.close() && writer.frameCount() == result.frameCount;
+  if (!result.ok) result.error = "failed to write " + outputPath;
+  return result;
+}
+
+std::vector<OfflineRenderer::Result>
+OfflineRenderer::renderFiles(std::shared_ptr<const SoundFont> soundFont, const Options& options,
+                             const std::vector<Job>& jobs, size_t threadCount)
+{
+  std::vector<Result> results(jobs.size());
+  if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+  threadCount = std::min(threadCount, jobs.size());
+
+  std::atomic<size_t> nextJob{0};
+  auto worker = [&]() {
+    OfflineRenderer renderer{soundFont, options};
+    for (auto index = nextJob++; index < jobs.size(); index = nextJob++) {
+      results[index] = renderer.renderFile(jobs[index].midiPath, jobs[index].outputPath);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t index = 1; index < threadCount; ++index) threads.emplace_back(worker);
+  if (threadCount > 0) worker();
+  for (auto& thread : threads) thread.join();
+  return results;
+}
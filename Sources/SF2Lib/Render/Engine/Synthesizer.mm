@@ -0,0 +1,874 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#include "SF2Lib/Utils/Base64.hpp"
+#include "SF2Lib/Entity/Generator/Index.hpp"
+#include "SF2Lib/Render/Engine/Synthesizer.hpp"
+#include "SF2Lib/IO/File.hpp"
+
+using namespace SF2::Render::Engine;
+
+Synthesizer::Synthesizer(Float sampleRate, size_t voiceCount, Interpolator interpolator,
+                         size_t minimumNoteDurationMilliseconds) noexcept :
+sampleRate_{sampleRate},
+minimumNoteDurationMilliseconds_{minimumNoteDurationMilliseconds},
+interpolator_{interpolator},
+oldestVoiceIndices_{voiceCount},
+linkState_{sampleRate, channelStates_[0]}
+{
+  assert(voiceCount <= maxVoiceCount);
+  Trace::prepare();
+
+  voices_.reserve(voiceCount);
+  for (size_t voiceIndex = 0; voiceIndex < voiceCount; ++voiceIndex) {
+    voices_.emplace_back(sampleRate, channelStates_[0], voiceIndex, interpolator);
+  }
+  voiceLimit_ = voiceCount;
+}
+
+bool
+Synthesizer::hasActivePreset(size_t channel) const noexcept
+{
+  return activePresets_[channel] < presets_->size();
+}
+
+std::string
+Synthesizer::activePresetName(size_t channel) const noexcept
+{
+  return hasActivePreset(channel) ? (*presets_)[activePresets_[channel]].configuration().name() : "";
+}
+
+#if SF2_VOICE_PROFILING == 1
+RenderProfile<Synthesizer::maxVoiceCount>::Snapshot
+Synthesizer::renderProfile() const noexcept
+{
+  auto snapshot = renderProfile_.snapshot();
+  for (auto costs : {&snapshot.presets, &snapshot.zones}) {
+    for (auto& cost : *costs) {
+      if (cost.presetIndex < presets_->size()) cost.presetName = (*presets_)[cost.presetIndex].configuration().name();
+    }
+  }
+  return snapshot;
+}
+#endif
+
+SF2::IO::File::LoadResponse
+Synthesizer::load(const std::string& path, size_t index) noexcept
+{
+  allOff();
+  IO::File::LoadResponse response;
+  auto soundFont = SoundFont::load(path, response);
+  if (soundFont) useSoundFont(std::move(soundFont), index);
+  return response;
+}
+
+void
+Synthesizer::useSoundFont(std::shared_ptr<const SoundFont> soundFont, size_t index) noexcept
+{
+  allOff();
+  soundFont_ = std::move(soundFont);
+  presets_ = soundFont_ ? &soundFont_->presets() : &SoundFont::noPresets();
+#if SF2_VOICE_PROFILING == 1
+  renderProfile_.reset();
+#endif
+  usePresetWithIndex(index);
+}
+
+void
+Synthesizer::usePresetWithIndex(size_t index)
+{
+  allOff();
+  if (index >= presets_->size()) {
+    // Special case to flag no preset being used.
+    index = presets_->size();
+  }
+  activePresets_.fill(index);
+  usePercussionPreset();
+  parameters_.reset();
+}
+
+void
+Synthesizer::usePercussionPreset() noexcept
+{
+  if (!multiTimbralModeEnabled_ || !hasActivePreset(percussionChannel)) return;
+  auto percussion = presets_->locatePresetIndex(percussionBank, 0);
+  if (percussion < presets_->size()) {
+    activePresets_[percussionChannel] = percussion;
+  }
+}
+
+void
+Synthesizer::usePresetWithBankProgram(size_t channel, uint16_t bank, uint16_t program)
+{
+  if (!multiTimbralModeEnabled_) {
+    allOff();
+  }
+
+  auto index = presets_->locatePresetIndex(bank, program);
+  if (index >= presets_->size()) {
+    index = presets_->size();
+  }
+  activePresets_[channel] = index;
+
+  if (!multiTimbralModeEnabled_) {
+    parameters_.reset();
+  }
+}
+
+void
+Synthesizer::allOff() noexcept
+{
+  for (auto pos = oldestVoiceIndices_.begin(); pos != oldestVoiceIndices_.end(); ) {
+    pos = stopVoice(*pos);
+  }
+}
+
+void
+Synthesizer::allOff(size_t channel) noexcept
+{
+  for (auto pos = oldestVoiceIndices_.begin(); pos != oldestVoiceIndices_.end(); ) {
+    auto voiceIndex = *pos;
+    if (voices_[voiceIndex].channel() == channel) {
+      pos = stopVoice(voiceIndex);
+    } else {
+      ++pos;
+    }
+  }
+}
+
+void
+Synthesizer::setMultiTimbralModeEnabled(bool value) noexcept
+{
+  if (value == multiTimbralModeEnabled_) return;
+  allOff();
+  multiTimbralModeEnabled_ = value;
+  for (auto& channelState : channelStates_) {
+    channelState.reset();
+  }
+
+  // Start all channels with the same preset as the first one, except for percussion in multi-timbral mode.
+  auto index = activePresets_[0];
+  activePresets_.fill(index);
+  usePercussionPreset();
+}
+
+void
+Synthesizer::noteOn(size_t channel, int key, int velocity) noexcept
+{
+  Trace::Interval interval{Trace::Id::noteOn, key, velocity};
+  if (! hasActivePreset(channel)) {
+    telemetry_.noteOnDropped();
+    return;
+  }
+
+  if (channelStates_[channel].pedalState().softPedalActive) {
+    velocity /= 2;
+  }
+
+  auto configs = (*presets_)[activePresets_[channel]].find(key, velocity);
+
+  // Stop any existing voice with the same exclusiveClass value.
+  for (const Config& config : configs) {
+    auto exclusiveClass{config.exclusiveClass()};
+    if (exclusiveClass > 0) {
+      stopAllExclusiveVoices(channel, exclusiveClass);
+    }
+    if (oneVoicePerKeyModeEnabled_) {
+      stopSameKeyVoices(channel, config.eventKey());
+    }
+  }
+
+  for (size_t index = 0; index < configs.size(); ++index) {
+    if (linkedStereoModeEnabled_) {
+      // Per SF2 7.10 the pitch of a stereo pair is controlled by the generators of the right sample, so its voice
+      // renders both halves. The left sample is skipped if it is rendered that way.
+      auto partner = stereoPartner(configs, index);
+      if (partner != configs.size()) {
+        if (configs[index].sampleSource().header().isRight()) {
+          startVoice(channel, configs[index], &configs[partner]);
+        }
+        continue;
+      }
+    }
+    startVoice(channel, configs[index]);
+  }
+}
+
+void
+Synthesizer::noteOff(size_t channel, int key) noexcept
+{
+  Trace::Interval interval{Trace::Id::noteOff, key};
+  if (key < 0 || size_t(key) >= keySlotCount) return;
+  auto releaseKeyState = Voice::ReleaseKeyState{minimumNoteDurationSamples(), channelStates_[channel].pedalState()};
+  keyVoices_.visit(keySlot(channel, key), [&](size_t voiceIndex) {
+    auto& voice{voices_[voiceIndex]};
+    voice.releaseKey(releaseKeyState);
+    if (!voice.isKeyDown()) heldVoices_.remove(voiceIndex);
+  });
+}
+
+void
+Synthesizer::applySostenutoPedal(size_t channel) noexcept
+{
+  heldVoices_.visit(channel, [this](size_t voiceIndex) {
+    auto& voice{voices_[voiceIndex]};
+    if (voice.isKeyDown()) voice.useSostenuto();
+  });
+}
+
+void
+Synthesizer::releaseKeys(size_t channel) noexcept
+{
+  // Voices that were already released need nothing more, so only the held ones are visited.
+  auto releaseKeyState = Voice::ReleaseKeyState{0u, MIDI::ChannelState::PedalState()};
+  heldVoices_.visit(channel, [&](size_t voiceIndex) {
+    voices_[voiceIndex].releaseKey(releaseKeyState);
+    heldVoices_.remove(voiceIndex);
+  });
+}
+
+void
+Synthesizer::applyPedals(size_t channel) noexcept
+{
+  // Only voices whose key went up while a pedal held them are affected. Keys that are still down keep sounding.
+  auto releaseKeyState = Voice::ReleaseKeyState{minimumNoteDurationSamples(), channelStates_[channel].pedalState()};
+  heldVoices_.visit(channel, [&](size_t voiceIndex) {
+    auto& voice{voices_[voiceIndex]};
+    if (voice.isReleasePostponed()) voice.releaseKey(releaseKeyState);
+    if (!voice.isKeyDown()) heldVoices_.remove(voiceIndex);
+  });
+}
+
+void
+Synthesizer::setParameter(AUParameterAddress rawIndex, AUValue value, AUAudioFrameCount rampDuration) noexcept {
+  // NOTE: this is running in the real-time render thread.
+  if (rawIndex < valueOf(Entity::Generator::Index::numValues)) {
+    auto index = Entity::Generator::Index(rawIndex);
+    const auto& def = Entity::Generator::Definition::definition(index);
+    // Voices see the change at the start of the next render slice, or as the ramp advances in `renderInto`.
+    parameters_.startRamp(index, def.clamp(int(std::round(value))), rampDuration);
+  } else if (rawIndex >= valueOf(Parameters::EngineParameterAddress::portamentoModeEnabled) &&
+             rawIndex < valueOf(Parameters::EngineParameterAddress::firstUnusedAddress)) {
+    auto address = Parameters::EngineParameterAddress(rawIndex);
+    switch (address) {
+      case Parameters::EngineParameterAddress::portamentoModeEnabled:
+        setPortamentoModeEnabled(SF2::toBool(value));
+        break;
+      case Parameters::EngineParameterAddress::portamentoRate:
+        setPortamentoRate(size_t(value));
+        break;
+      case Parameters::EngineParameterAddress::oneVoicePerKeyModeEnabled:
+        setOneVoicePerKeyModeEnabled(SF2::toBool(value));
+        break;
+      case Parameters::EngineParameterAddress::polyphonicModeEnabled:
+        setPhonicMode(SF2::toBool(value) ? PhonicMode::poly : PhonicMode::mono);
+        break;
+      case Parameters::EngineParameterAddress::activeVoiceCount:
+        break;
+      case Parameters::EngineParameterAddress::retriggerModeEnabled:
+        setRetriggerModeEnabled(SF2::toBool(value));
+        break;
+      case Parameters::EngineParameterAddress::multiTimbralModeEnabled:
+        setMultiTimbralModeEnabled(SF2::toBool(value));
+        break;
+      case Parameters::EngineParameterAddress::stealingPolicy:
+        setStealingPolicy(value >= 0.5 ? StealingPolicy::audibility : StealingPolicy::oldest);
+        break;
+      case Parameters::EngineParameterAddress::voiceCullThreshold:
+        setVoiceCullThreshold(value);
+        break;
+      case Parameters::EngineParameterAddress::governorEnabled:
+        setGovernorEnabled(SF2::toBool(value));
+        break;
+      case Parameters::EngineParameterAddress::governorLoadLimit:
+        setGovernorLoadLimit(value / 100_F);
+        break;
+      case Parameters::EngineParameterAddress::linkedStereoModeEnabled:
+        setLinkedStereoModeEnabled(SF2::toBool(value));
+        break;
+      case Parameters::EngineParameterAddress::firstUnusedAddress:
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+void
+Synthesizer::applyCommands() noexcept
+{
+  // NOTE: this is running in the real-time render thread.
+  commands_.drain([this](const Command& command) { applyCommand(command); }, maxCommandsPerRender);
+}
+
+void
+Synthesizer::applyCommand(const Command& command) noexcept
+{
+  switch (command.type) {
+    case Command::Type::usePreset: usePresetWithIndex(command.index); break;
+    case Command::Type::useBankProgram:
+      if (command.index < channelCount) usePresetWithBankProgram(command.index, command.bank, command.program);
+      break;
+    case Command::Type::useSoundFont: useSoundFont(*command.soundFont, command.index); break;
+    case Command::Type::setParameter: setParameter(command.address, command.value); break;
+    case Command::Type::setVoiceLimit: setVoiceLimit(command.index); break;
+    case Command::Type::allOff: allOff(); break;
+    case Command::Type::reset: reset(); break;
+  }
+}
+
+bool
+Synthesizer::render(std::span<const RenderEvent> events, Mixer mixer, AUAudioFrameCount frameCount) noexcept
+{
+  // NOTE: this is running in the real-time render thread.
+  auto apply = [this](const RenderEvent& event) {
+    switch (event.type()) {
+      case RenderEvent::Type::midi: processMIDIEvent(event.midiBytes()); break;
+      case RenderEvent::Type::parameter: setParameter(event.address(), event.value()); break;
+      case RenderEvent::Type::parameterRamp: setParameter(event.address(), event.value(), event.rampDuration()); break;
+    }
+  };
+
+  auto event = events.begin();
+  AUAudioFrameCount now = 0;
+  auto silent = true;
+  while (now < frameCount) {
+    for (; event != events.end() && event->frame() <= now; ++event) apply(*event);
+    auto until = (event != events.end()) ? std::min(event->frame(), frameCount) : frameCount;
+    silent = renderInto(mixer, until - now) && silent;
+    mixer.shiftOver(until - now);
+    now = until;
+  }
+
+  for (; event != events.end(); ++event) apply(*event);
+  mixer.shiftBack(frameCount);
+  return silent;
+}
+
+void
+Synthesizer::processMIDIEvent(std::span<const uint8_t> bytes) noexcept
+{
+  if (bytes.empty()) return;
+  if (bytes[0] < 0x80) return;
+  ++midiEventCount_;
+
+  auto event = MIDI::CoreEvent(bytes[0] < 0xF0 ? (bytes[0] & 0xF0) : bytes[0]);
+  auto channel = channelFor(bytes[0]);
+  switch (event) {
+    case MIDI::CoreEvent::noteOff:
+      if (bytes.size() > 1) {
+        noteOff(channel, bytes[1]);
+      }
+      break;
+
+    case MIDI::CoreEvent::noteOn:
+      if (bytes.size() == 3) {
+        noteOn(channel, bytes[1], bytes[2]);
+      }
+      break;
+
+    case MIDI::CoreEvent::keyPressure:
+      if (bytes.size() == 3) {
+        channelStates_[channel].setNotePressure(bytes[1], bytes[2]);
+        notifyActiveVoicesChannelStateChanged(channel, Render::Voice::State::SourceId::keyPressure);
+      }
+      break;
+
+    case MIDI::CoreEvent::controlChange:
+      if (bytes.size() == 3) {
+        auto what = MIDI::ControlChange(bytes[1]);
+        auto data = bytes[2];
+        if (bytes[1] < 120) {
+          processControlChange(channel, what, data);
+        } else {
+          processChannelMessage(channel, what, data);
+        }
+      }
+      break;
+
+    case MIDI::CoreEvent::programChange:
+      if (bytes.size() >= 2) {
+        changeProgram(channel, bytes[1]);
+      }
+      break;
+
+    case MIDI::CoreEvent::channelPressure:
+      if (bytes.size() >= 2) {
+        channelStates_[channel].setChannelPressure(bytes[1]);
+        notifyActiveVoicesChannelStateChanged(channel, Render::Voice::State::SourceId::channelPressure);
+      }
+      break;
+
+    case MIDI::CoreEvent::pitchBend:
+      if (bytes.size() == 3) {
+        int bend = (bytes[2] << 7) | bytes[1];
+        channelStates_[channel].setPitchWheelValue(bend);
+        notifyActiveVoicesChannelStateChanged(channel, Render::Voice::State::SourceId::pitchWheel);
+      }
+      break;
+
+    case MIDI::CoreEvent::systemExclusive:
+      if (bytes.size() > 2 && bytes[1] == 0x7e && bytes.back() == 0xF7) {
+        switch (bytes[2]) {
+          case 0x00:
+            if (bytes.size() >= 6) {
+              loadFromMIDI(bytes);
+            } else {
+              Trace::instant(Trace::Id::sysExIgnored, int32_t(bytes.size()));
+            }
+            break;
+
+          default:
+            Trace::instant(Trace::Id::sysExIgnored, int32_t(bytes.size()), bytes[2]);
+            break;
+        }
+      }
+      break;
+
+    case MIDI::CoreEvent::reset:
+      reset();
+      break;
+
+    default:
+      Trace::instant(Trace::Id::midiIgnored, bytes[0]);
+      break;
+  }
+}
+
+void
+Synthesizer::processChannelMessage(size_t channel, MIDI::ControlChange channelMessage, uint8_t value) noexcept
+{
+  switch (channelMessage) {
+    case MIDI::ControlChange::allSoundOff:
+      if (multiTimbralModeEnabled_) {
+        allOff(channel);
+      } else {
+        allOff();
+      }
+      break;
+
+    case MIDI::ControlChange::resetAllControllers:
+      if (multiTimbralModeEnabled_) {
+        allOff(channel);
+        channelStates_[channel].reset();
+      } else {
+        reset();
+      }
+      break;
+
+//    case MIDI::ControlChange::localControl:
+//      break;
+
+    case MIDI::ControlChange::allNotesOff:
+      releaseKeys(channel);
+      break;
+
+    case MIDI::ControlChange::omniOff:
+      allOff();
+      break;
+
+    case MIDI::ControlChange::omniOn:
+      allOff();
+      break;
+
+    case MIDI::ControlChange::monoOn:
+      allOff();
+      setPhonicMode(PhonicMode::mono);
+      break;
+
+    case MIDI::ControlChange::polyOn:
+      allOff();
+      setPhonicMode(PhonicMode::poly);
+      break;
+
+    default: break;
+  }
+}
+
+void
+Synthesizer::processControlChange(size_t channel, MIDI::ControlChange cc, uint8_t value) noexcept
+{
+  auto& channelState{channelStates_[channel]};
+  auto previousPedalState = channelState.pedalState();
+
+  // Delegate the processing of the CC values. If a value was actually changed, then notify the active voices so that
+  // they can update their generators that rely on CC values. A data entry value may have changed an NRPN value which
+  // can affect any generator, so that requires a full update. Otherwise, only voices with a modulator that uses the
+  // CC need to do any work.
+  if (channelState.setContinuousControllerValue(cc, value)) {
+    if (cc == MIDI::ControlChange::dataEntryMSB) {
+      notifyActiveVoicesChannelStateChanged(channel);
+    } else {
+      notifyActiveVoicesChannelStateChanged(channel, Render::Voice::State::sourceIdFor(cc));
+    }
+  }
+
+  // Now check if there is a pedal change that can affect note off responses in a voice.
+  auto currentPedalState = channelState.pedalState();
+  auto doRelease = false;
+
+  if (!previousPedalState.sostenutoPedalActive) {
+    if (currentPedalState.sostenutoPedalActive) {
+      applySostenutoPedal(channel);
+    }
+  } else {
+    doRelease = !currentPedalState.sostenutoPedalActive;
+  }
+
+  if (previousPedalState.sustainPedalActive && !currentPedalState.sustainPedalActive) {
+    doRelease = true;
+  }
+
+  if (doRelease) {
+    applyPedals(channel);
+  }
+}
+
+void
+Synthesizer::applyPendingParameters() noexcept
+{
+  for (auto pos = oldestVoiceIndices_.begin(); pos != oldestVoiceIndices_.end(); ++pos) {
+    auto& voice{voices_[*pos]};
+    if (voice.isActive()) {
+      parameters_.applyPending(voice.state());
+    }
+  }
+  parameters_.clearPending();
+}
+
+void
+Synthesizer::notifyActiveVoicesChannelStateChanged(size_t channel) noexcept
+{
+  visitActiveVoice(channel, [](Voice& voice, const Voice::ReleaseKeyState&) { voice.channelStateChanged(); });
+}
+
+void
+Synthesizer::notifyActiveVoicesChannelStateChanged(size_t channel, Render::Voice::State::SourceId source) noexcept
+{
+  visitActiveVoice(channel, [source](Voice& voice, const Voice::ReleaseKeyState&) {
+    if (voice.state().dependsOn(source)) voice.channelStateChanged(source);
+  });
+}
+
+void
+Synthesizer::loadFromMIDI(std::span<const uint8_t> bytes) noexcept {
+  size_t index = bytes[3] * 128u + bytes[4];
+  if (bytes.size() > 6) {
+    size_t count = bytes.size() - 6;
+    auto path = Utils::Base64::decode(bytes.data() + 5, count);
+    load(path, index);
+  } else {
+    usePresetWithIndex(index);
+  }
+}
+
+std::vector<uint8_t>
+Synthesizer::createLoadFileUsePreset(const std::string& path, size_t preset) noexcept
+{
+  auto encoded = path.empty() ? "" : SF2::Utils::Base64::encode(path);
+  auto nameOffset = 5;
+  auto size = encoded.size() + size_t(nameOffset + 1);
+  auto data = std::vector<uint8_t>(size, uint8_t(0));
+  data[0] = SF2::valueOf(MIDI::CoreEvent::systemExclusive);
+  data[1] = 0x7E; // Custom command for SF2Lib
+  data[2] = 0x00; // unused subtype
+  data[3] = static_cast<uint8_t>(preset / 128); // MSB of preset value
+  data[4] = static_cast<uint8_t>(preset - data[3] * 128); // LSB of preset value
+  std::copy_n(encoded.begin(), encoded.size(), data.begin() + nameOffset);
+  data[size - 1] = 0xF7;
+  return data;
+}
+
+std::vector<uint8_t>
+Synthesizer::createUsePreset(size_t preset) noexcept
+{
+  return createLoadFileUsePreset("", preset);
+}
+
+std::array<uint8_t, 1>
+Synthesizer::createResetCommand() noexcept
+{
+  return std::array<uint8_t, 1>{
+    SF2::valueOf(MIDI::CoreEvent::reset)
+  };
+}
+
+std::array<uint8_t, 3>
+Synthesizer::createChannelMessage(MIDI::ControlChange channelMessage, uint8_t value) noexcept
+{
+  return std::array<uint8_t, 3>{
+    SF2::valueOf(MIDI::CoreEvent::controlChange),
+    SF2::valueOf(channelMessage),
+    value
+  };
+}
+
+std::array<uint8_t, 9>
+Synthesizer::createUseBankProgram(uint16_t bank, uint8_t program) noexcept
+{
+  assert(bank < 128 * 128 && program < 128);
+  auto bankMSB = uint8_t(bank / 128u);
+  auto bankLSB = uint8_t(bank - bankMSB * 128u);
+  return std::array<uint8_t, 9>{
+    SF2::valueOf(MIDI::CoreEvent::controlChange),
+    SF2::valueOf(MIDI::ControlChange::bankSelectMSB),
+    bankMSB,
+    SF2::valueOf(MIDI::CoreEvent::controlChange),
+    SF2::valueOf(MIDI::ControlChange::bankSelectLSB),
+    bankLSB,
+    SF2::valueOf(MIDI::CoreEvent::programChange),
+    program,
+    0
+  };
+}
+
+void
+Synthesizer::changeProgram(size_t channel, uint8_t program) noexcept
+{
+  const auto& channelState{channelStates_[channel]};
+  uint16_t msbBank = channelState.continuousControllerValue(MIDI::ControlChange::bankSelectMSB);
+  uint16_t lsbBank = channelState.continuousControllerValue(MIDI::ControlChange::bankSelectLSB);
+  uint16_t bank = msbBank * 128u + lsbBank;
+
+  // General MIDI reserves one channel for percussion, which lives in its own bank.
+  if (multiTimbralModeEnabled_ && channel == percussionChannel && bank == 0) {
+    bank = percussionBank;
+  }
+
+  usePresetWithBankProgram(channel, bank, program);
+}
+
+void
+Synthesizer::setSampleRate(Float sampleRate) noexcept
+{
+  sampleRate_ = sampleRate;
+  linkState_.setSampleRate(sampleRate);
+  allOff();
+  governor_.reset();
+  applyCullThreshold();
+  for (auto& voice : voices_) {
+    voice.setSampleRate(sampleRate);
+  }
+  parameters_.reset();
+}
+
+void
+Synthesizer::stopAllExclusiveVoices(size_t channel, int exclusiveClass) noexcept
+{
+  if (size_t(exclusiveClass) >= keySlotCount) return;
+  exclusiveClassVoices_.visit(keySlot(channel, exclusiveClass), [this](size_t voiceIndex) { stopVoice(voiceIndex); });
+}
+
+void
+Synthesizer::stopSameKeyVoices(size_t channel, int eventKey) noexcept
+{
+  if (eventKey < 0 || size_t(eventKey) >= keySlotCount) return;
+  keyVoices_.visit(keySlot(channel, eventKey), [this](size_t voiceIndex) { stopVoice(voiceIndex); });
+}
+
+size_t
+Synthesizer::stereoPartner(const std::vector<Config>& configs, size_t index) noexcept
+{
+  const auto& source{configs[index].sampleSource()};
+  const auto& header{source.header()};
+  if (!header.isLeft() && !header.isRight()) return configs.size();
+
+  const auto& sources{soundFont_->sampleSources()};
+  if (header.sampleLinkIndex() >= sources.size()) return configs.size();
+  const auto* linked{&sources[header.sampleLinkIndex()]};
+  for (size_t partner = 0; partner < configs.size(); ++partner) {
+    if (&configs[partner].sampleSource() != linked) continue;
+    const auto& other{linked->header()};
+    if (other.isLeft() == header.isLeft() || other.isRight() == header.isRight()) continue;
+    if (other.sampleLinkIndex() >= sources.size() || &sources[other.sampleLinkIndex()] != &source) continue;
+
+    // Both halves are read at the same sample position, so their layouts must match.
+    if (other.sampleSize() == header.sampleSize() &&
+        other.startLoopIndex() - other.startIndex() == header.startLoopIndex() - header.startIndex() &&
+        other.endLoopIndex() - other.startIndex() == header.endLoopIndex() - header.startIndex()) {
+      return partner;
+    }
+  }
+  return configs.size();
+}
+
+void
+Synthesizer::startVoice(size_t channel, const Config& config, const Config* partner) noexcept
+{
+  Trace::Interval interval{Trace::Id::startVoice, int32_t(channel), config.eventKey()};
+  stealVoiceIfNecessary(channel, config.exclusiveClass());
+  auto voiceIndex = oldestVoiceIndices_.voiceOn();
+  // When every voice is playing and none could be stopped, the oldest one is reused as is.
+  unlinkVoice(voiceIndex);
+  voices_[voiceIndex].assignChannel(channel, channelStates_[channel]);
+  voices_[voiceIndex].setInterpolator(governor_.interpolator(interpolator_));
+  voices_[voiceIndex].configure(config);
+#if SF2_VOICE_PROFILING == 1
+  renderProfile_.assign(voiceIndex, activePresets_[channel], &config.instrument(), config.instrument().keyRange().low(),
+                        config.instrument().keyRange().high(), config.sampleSource().header().sampleName());
+#endif
+  parameters_.applyChanged(voices_[voiceIndex].state());
+  if (partner != nullptr) {
+    linkState_.setChannelState(channelStates_[channel]);
+    linkState_.prepareForVoice(*partner);
+    parameters_.applyChanged(linkState_);
+    voices_[voiceIndex].link(partner->sampleSource(), linkState_);
+  }
+  voices_[voiceIndex].start();
+  linkVoice(voiceIndex);
+}
+
+void
+Synthesizer::setVoiceCullThreshold(Float decibels) noexcept
+{
+  voiceCullThresholdDecibels_ = std::max(decibels, minimumVoiceCullThreshold);
+  applyCullThreshold();
+}
+
+void
+Synthesizer::setGovernorEnabled(bool value) noexcept
+{
+  governor_.setEnabled(value);
+  applyCullThreshold();
+}
+
+void
+Synthesizer::applyCullThreshold() noexcept
+{
+  // The governor shortens release tails by raising the threshold used to stop releasing voices.
+  auto decibels = voiceCullThresholdDecibels_;
+  if (governor_.shortenReleases()) decibels = std::max(decibels, Governor::releaseCullThresholdDecibels);
+  auto threshold = decibels <= minimumVoiceCullThreshold ? 0_F : std::pow(10_F, decibels / 20_F);
+  for (auto& voice : voices_) {
+    voice.setCullThreshold(threshold);
+  }
+}
+
+void
+Synthesizer::stealVoiceIfNecessary(size_t channel, int exclusiveClass) noexcept
+{
+  // The host and the governor may limit the number of voices that can play at the same time. The limit may have just
+  // dropped below the number of active voices, so keep stealing until the new note fits.
+  auto limit = governor_.voiceLimit(voiceLimit_);
+
+  // With the `oldest` policy, stop the oldest active voices -- the ones that `voiceOn` would otherwise reuse.
+  if (stealingPolicy_ == StealingPolicy::oldest) {
+    while (oldestVoiceIndices_.active() >= limit) {
+      telemetry_.voiceStolen();
+      stopVoice(oldestVoiceIndices_.oldest());
+    }
+    return;
+  }
+
+  // Hold back some voices (always at least one) so that stolen voices can fade out while the new note starts.
+  auto reserve = std::max<size_t>(1, limit / 8);
+  auto budget = limit - reserve;
+  if (oldestVoiceIndices_.active() < budget) return;
+
+  for (auto playing = playingVoiceCount(); playing >= budget; --playing) {
+    // Let the victim fade out while the new note uses one of the reserved voices.
+    auto victim = stealCandidate(channel, exclusiveClass);
+    if (victim == voices_.size()) break;
+    telemetry_.voiceStolen();
+    voices_[victim].fadeOut(size_t(stolenVoiceFadeOutMilliseconds / 1000_F * sampleRate_));
+  }
+
+  while (oldestVoiceIndices_.active() >= limit) {
+    // There are no free voices so something must stop now. Only cut short a voice that is already fading out, the
+    // quietest one, so that no voice stops abruptly at full level.
+    auto fading = quietestFadingVoice();
+    if (fading == voices_.size()) break;
+    stopVoice(fading);
+  }
+}
+
+void
+Synthesizer::shedExcessVoices(size_t limit) noexcept
+{
+  // Fade out enough voices to get back under a limit that dropped below the number of playing voices. The `oldest`
+  // policy gives up the oldest voices, the `audibility` policy the ones that are releasing or quietest.
+  auto fadeOutSamples = size_t(stolenVoiceFadeOutMilliseconds / 1000_F * sampleRate_);
+  auto pos = oldestVoiceIndices_.end();
+  for (auto playing = playingVoiceCount(); playing > limit; --playing) {
+    auto victim = voices_.size();
+    if (stealingPolicy_ == StealingPolicy::oldest) {
+      while (pos != oldestVoiceIndices_.begin() && victim == voices_.size()) {
+        --pos;
+        if (voices_[*pos].isActive() && !voices_[*pos].isFadingOut()) victim = *pos;
+      }
+    } else {
+      victim = stealCandidate(voices_.size(), 0);
+    }
+    if (victim == voices_.size()) break;
+    voices_[victim].fadeOut(fadeOutSamples);
+  }
+}
+
+size_t
+Synthesizer::playingVoiceCount() const noexcept
+{
+  size_t playing = 0;
+  for (auto voiceIndex : oldestVoiceIndices_) {
+    const auto& voice{voices_[voiceIndex]};
+    if (voice.isActive() && !voice.isFadingOut()) ++playing;
+  }
+  return playing;
+}
+
+size_t
+Synthesizer::stealCandidate(size_t channel, int exclusiveClass) const noexcept
+{
+  // Rank the playing voices -- lower is a better candidate to steal. Exclusive classes only apply within a channel.
+  auto rank = [channel, exclusiveClass](const Voice& voice) {
+    if (voice.isReleasing()) return 0;
+    if (exclusiveClass > 0 && voice.exclusiveClass() == exclusiveClass && voice.channel() == channel) return 1;
+    return 2;
+  };
+
+  size_t victim = voices_.size();
+  auto victimRank = 3;
+  auto victimLevel = 0_F;
+  for (auto voiceIndex : oldestVoiceIndices_) {
+    const auto& voice{voices_[voiceIndex]};
+    if (!voice.isActive() || voice.isFadingOut()) continue;
+    auto voiceRank = rank(voice);
+    if (voiceRank < victimRank || (voiceRank == victimRank && voice.level() < victimLevel)) {
+      victim = voiceIndex;
+      victimRank = voiceRank;
+      victimLevel = voice.level();
+    }
+  }
+  return victim;
+}
+
+size_t
+Synthesizer::quietestFadingVoice() const noexcept
+{
+  size_t fading = voices_.size();
+  auto fadingLevel = 0_F;
+  for (auto voiceIndex : oldestVoiceIndices_) {
+    const auto& voice{voices_[voiceIndex]};
+    if (!voice.isActive() || !voice.isFadingOut()) continue;
+    if (fading == voices_.size() || voice.level() < fadingLevel) {
+      fading = voiceIndex;
+      fadingLevel = voice.level();
+    }
+  }
+  return fading;
+}
+
+OldestVoiceCollection<Synthesizer::maxVoiceCount>::iterator
+Synthesizer::stopVoice(size_t voiceIndex) noexcept
+{
+  Trace::Interval interval{Trace::Id::stopVoice, int32_t(voiceIndex)};
+  voices_[voiceIndex].stop();
+  return retireVoice(voiceIndex);
+}
+
+void
+Synthesizer::reset() noexcept
+{
+  allOff();
+  for (auto& channelState : channelStates_) {
+    channelState.reset();
+  }
+}
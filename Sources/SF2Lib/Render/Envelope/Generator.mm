@@ -24,52 +24,51 @@ const Generator::StateNameArray Generator::stageNames_ = {
  @param gen the generator holding the timecents/semitone scaling factor
  @returns result of generator value x (60 - key)
  */
-constexpr Float midiKeyEnvelopeScaling(const Generator::State& state, Generator::Index gen) noexcept {
+inline Float midiKeyEnvelopeScaling(const Generator::State& state, Generator::Index gen) noexcept {
   auto value = state.modulated(gen);
   auto scaling = 60 - state.key();
   return value * scaling;
 }
 
-constexpr Float delayTimecentsToSeconds(Float value) noexcept {
+inline Float delayTimecentsToSeconds(Float value) noexcept {
   return (value <= -32'768.0) ? 0.0 : DSP::centsToSeconds(DSP::clamp(value, lowerBoundTimecents, 5'000.0));
 }
 
-constexpr Float attackTimecentsToSeconds(Float value) noexcept {
+inline Float attackTimecentsToSeconds(Float value) noexcept {
   return (value <= -32'768.0) ? 0.0 : DSP::centsToSeconds(DSP::clamp(value, lowerBoundTimecents, 8'000.0));
 }
 
-constexpr Float holdTimecentsToSeconds(Float value) noexcept {
+inline Float holdTimecentsToSeconds(Float value) noexcept {
   return DSP::centsToSeconds(DSP::clamp(value, lowerBoundTimecents, 5'000.0));
 }
 
-constexpr Float decayTimecentsToSeconds(Float value) noexcept {
+inline Float decayTimecentsToSeconds(Float value) noexcept {
   return DSP::centsToSeconds(DSP::clamp(value, lowerBoundTimecents, 8'000.0));
 }
 
-constexpr Float releaseTimecentsToSeconds(Float value) noexcept {
+inline Float releaseTimecentsToSeconds(Float value) noexcept {
   return DSP::centsToSeconds(DSP::clamp(value, lowerBoundTimecents, 5'000.0));
 }
 
-constexpr Float midiKeyVolumeEnvelopeHoldAdjustment(const Generator::State& state) noexcept {
+inline Float midiKeyVolumeEnvelopeHoldAdjustment(const Generator::State& state) noexcept {
   return midiKeyEnvelopeScaling(state, Generator::Index::midiKeyToVolumeEnvelopeHold);
 }
 
-constexpr Float midiKeyVolumeEnvelopeDecayAdjustment(const Generator::State& state) noexcept {
+inline Float midiKeyVolumeEnvelopeDecayAdjustment(const Generator::State& state) noexcept {
   return midiKeyEnvelopeScaling(state, Generator::Index::midiKeyToVolumeEnvelopeDecay);
 }
 
-constexpr Float midiKeyModulatorEnvelopeHoldAdjustment(const Generator::State& state) noexcept {
+inline Float midiKeyModulatorEnvelopeHoldAdjustment(const Generator::State& state) noexcept {
   return midiKeyEnvelopeScaling(state, Generator::Index::midiKeyToModulatorEnvelopeHold);
 }
 
-constexpr Float midiKeyModulatorEnvelopeDecayAdjustment(const Generator::State& state) noexcept {
+inline Float midiKeyModulatorEnvelopeDecayAdjustment(const Generator::State& state) noexcept {
   return midiKeyEnvelopeScaling(state, Generator::Index::midiKeyToModulatorEnvelopeDecay);
 }
 
 Generator::Generator(size_t voiceIndex, const char* logTag) noexcept :
 logTag_{logTag},
-voiceIndex_{voiceIndex},
-log_{os_log_create("SF2Lib", logTag)}
+voiceIndex_{voiceIndex}
 {
   ;
 }
@@ -77,8 +76,7 @@ log_{os_log_create("SF2Lib", logTag)}
 Generator::Generator(Float sampleRate, const char* logTag, size_t voiceIndex, Float delay, Float attack, Float hold,
                      Float decay, int sustain, Float release) noexcept :
 logTag_{logTag},
-voiceIndex_{voiceIndex},
-log_{os_log_create("SF2Lib", logTag)}
+voiceIndex_{voiceIndex}
 {
   sustainLevel_ = 1_F - sustain / 1'000_F;
   stages_[StageIndex::delay].setDelay(int(round(sampleRate * delay)));
@@ -6,13 +6,13 @@
 using namespace SF2::Render;
 
 LFO::LFO(Float sampleRate, const char* logTag) noexcept :
-log_{os_log_create("SF2Lib", logTag)}
+logTag_{logTag}
 {
   configure(sampleRate, 0_F, -12'000_F);
 }
 
 LFO::LFO(Float sampleRate, const char* logTag, Float frequency, Float delay) :
-log_{os_log_create("SF2Lib", logTag)}
+logTag_{logTag}
 {
   configure(sampleRate, frequency, delay);
 }
@@ -1,35 +1,149 @@
 // Copyright © 2022 Brad Howes. All rights reserved.
 
+#include <array>
+#include <cmath>
+#include <mutex>
+#include <vector>
+
 #include "SF2Lib/DSP.hpp"
 #include "SF2Lib/Render/LowPassFilter.hpp"
 
+using namespace SF2;
 using namespace SF2::Render;
 
+/**
+ Sine and cosine of the filter angle for every whole cent of cutoff frequency at a given sample rate. Voices all run at
+ the same sample rate, so they share the same table.
+ */
+struct LowPassFilter::CutoffTable
+{
+  CutoffTable(Float sampleRate) noexcept : sampleRate_{sampleRate}
+  {
+    for (int cents = 0; cents <= maximumCutoff; ++cents) {
+      // Bounds taken from FluidSynth, where the upper bound serves as an anti-aliasing filter, just below the
+      // Nyquist frequency.
+      auto frequency = DSP::clamp(DSP::centsToFrequency(cents), 5_F, 0.45_F * sampleRate);
+      auto theta = 2_F * Float(M_PI) * frequency / sampleRate;
+      sinTheta_[size_t(cents)] = std::sin(theta);
+      cosTheta_[size_t(cents)] = std::cos(theta);
+    }
+  }
+
+  static std::shared_ptr<const CutoffTable> make(Float sampleRate) noexcept
+  {
+    static std::mutex mutex;
+    static std::shared_ptr<const CutoffTable> last;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!last || last->sampleRate_ != sampleRate) last = std::make_shared<const CutoffTable>(sampleRate);
+    return last;
+  }
+
+  Float sampleRate_;
+  std::array<Float, maximumCutoff + 1> sinTheta_;
+  std::array<Float, maximumCutoff + 1> cosTheta_;
+};
+
+namespace {
+
+/// Obtain the `1 / (2 Q)` damping factors for every whole centiBel of resonance.
+const std::array<Float, LowPassFilter::maximumResonance + 1>& dampingTable() noexcept
+{
+  static const auto table = []() {
+    std::array<Float, LowPassFilter::maximumResonance + 1> values;
+    for (size_t index = 0; index < values.size(); ++index) {
+      values[index] = 1_F / DSP::centibelsToResonance(Float(index)) / 2_F;
+    }
+    return values;
+  }();
+  return table;
+}
+
+int quantize(Float value, int upperBound) noexcept {
+  return value <= 0_F ? 0 : std::min(int(value + 0.5_F), upperBound);
+}
+
+}
+
 LowPassFilter::LowPassFilter(Float sampleRate) noexcept :
-filter_{Coefficients()},
+cutoffTable_{CutoffTable::make(sampleRate)},
 sampleRate_{sampleRate},
-lastFrequency_{defaultFrequency},
-lastResonance_{defaultResonance}
+lastFrequency_{maximumCutoff},
+lastResonance_{0}
 {
-  updateSettings(defaultFrequency, defaultResonance);
+  setCoefficients(coefficients(defaultFrequency, defaultResonance), 0);
 }
 
 void
-LowPassFilter::updateSettings(Float frequency, Float resonance) noexcept
+LowPassFilter::setCoefficients(const Coefficients& goal, size_t rampDuration) noexcept
+{
+  lane_.goal = goal;
+  if (rampDuration) {
+    lane_.rampRemaining = rampDuration;
+    lane_.change = lane_.coefficients.rampFactor(goal, rampDuration);
+  } else {
+    lane_.rampRemaining = 0;
+    lane_.coefficients = goal;
+  }
+}
+
+LowPassFilter::Coefficients
+LowPassFilter::coefficients(Float frequency, Float resonance) const noexcept
 {
-  lastFrequency_ = frequency;
-  lastResonance_ = resonance;
+  // Same calculations as `Coefficients::LPF2` but with the trigonometric and power functions taken from tables.
+  auto cents = size_t(quantize(frequency, maximumCutoff));
+  auto damping = dampingTable()[size_t(quantize(resonance, maximumResonance))];
+  auto sinTheta = damping * cutoffTable_->sinTheta_[cents];
+  auto beta = 0.5_F * (1_F - sinTheta) / (1_F + sinTheta);
+  auto gamma = (0.5_F + beta) * cutoffTable_->cosTheta_[cents];
+  auto alpha = (0.5_F + beta - gamma) / 2_F;
+  return Coefficients(alpha, 2_F * alpha, alpha, -2_F * gamma, 2_F * beta);
+}
+
+void
+LowPassFilter::update(Float frequency, Float resonance) noexcept
+{
+  auto cents = quantize(frequency, maximumCutoff);
+  auto centibels = quantize(resonance, maximumResonance);
+  if (primed_ && cents == lastFrequency_ && centibels == lastResonance_) return;
+
+  lastFrequency_ = cents;
+  lastResonance_ = centibels;
+
+#if ENABLE_LOWPASS_FILTER_BYPASS == 1
+  // A fully-open filter with no resonance does very little, so skip it altogether.
+  if (cents == maximumCutoff && centibels == 0) {
+    if (!bypassed_) lane_.state = State();
+    bypassed_ = true;
+    primed_ = true;
+    return;
+  }
+
+  if (bypassed_) {
+    bypassed_ = false;
+    if (primed_) {
+      // Leaving bypass in the middle of a note. Start from coefficients that pass samples through unchanged, with a
+      // state that holds the latest samples as both input and output, and ramp to the new coefficients over the next
+      // interval. Otherwise the output would jump.
+      lane_.state.y_z1 = lane_.state.x_z1;
+      lane_.state.y_z2 = lane_.state.x_z2;
+      lane_.coefficients = Coefficients(1_F, 0_F, 0_F, 0_F, 0_F);
+    } else {
+      lane_.state = State();
+    }
+  }
+#endif
 
-  // Bounds taken from FluidSynth, where the upper bound serves as an anti-aliasing filter, just below the
-  // Nyquist frequency.
-  frequency = DSP::clamp(DSP::centsToFrequency(frequency), 5_F, 0.45_F * sampleRate_);
-  resonance = DSP::centibelsToResonance(resonance);
-  filter_.setCoefficients(Coefficients::LPF2(sampleRate_, frequency, resonance));
+  auto goal = coefficients(Float(cents), Float(centibels));
+  setCoefficients(goal, primed_ ? controlInterval : 0);
+  primed_ = true;
 }
 
 void
 LowPassFilter::setSampleRate(Float sampleRate) noexcept
 {
   sampleRate_ = sampleRate;
-  updateSettings(lastFrequency_, lastResonance_);
+  cutoffTable_ = CutoffTable::make(sampleRate);
+  primed_ = false;
+  countdown_ = 0;
+  update(Float(lastFrequency_), Float(lastResonance_));
 }
@@ -0,0 +1,29 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#include "SF2Lib/Render/SoundFont.hpp"
+
+using namespace SF2::Render;
+
+SoundFont::SoundFont(std::unique_ptr<IO::File> file) :
+file_{std::move(file)}
+{
+  // Building the presets also converts all of the samples, so nothing is left to be done lazily while rendering.
+  presets_.build(*file_);
+  sampleSources_ = &file_->sampleSourceCollection();
+}
+
+std::shared_ptr<const SoundFont>
+SoundFont::load(const std::string& path, IO::File::LoadResponse& response) noexcept
+{
+  auto file = std::make_unique<IO::File>(path);
+  response = file->load();
+  if (response != IO::File::LoadResponse::ok) return nullptr;
+  return std::shared_ptr<const SoundFont>(new SoundFont(std::move(file)));
+}
+
+const PresetCollection&
+SoundFont::noPresets() noexcept
+{
+  static const PresetCollection empty{};
+  return empty;
+}
@@ -8,6 +8,13 @@ void
 Generator::configure(const NormalizedSampleSource& sampleSource, const State& state) noexcept
 {
   bounds_ = Bounds::make(sampleSource.header(), state);
+
+  // Only use the loop peak of the sample source if the loop was not changed by generators.
+  const auto& header{sampleSource.header()};
+  headerLoop_ = (header.startLoopIndex() >= header.startIndex() &&
+                 bounds_.startLoopPos() == header.startLoopIndex() - header.startIndex() &&
+                 bounds_.endLoopPos() == header.endLoopIndex() - header.startIndex());
   index_.configure(bounds_);
   sampleSource_ = &sampleSource;
+  linkedSource_ = nullptr;
 }
@@ -12,72 +12,47 @@ using namespace SF2::Render::Voice::State;
 
 namespace EntityMod = Entity::Modulator;
 
-int Modulator::ValueProvider::ccValue(const State& state) const noexcept {
-  auto value = state.channelState().continuousControllerValue(cc_);
-  // std::cout << "ValueProvider CC " << valueOf(cc_) << " value: " << value << "\n";
-  return value;
-}
-
-int Modulator::ValueProvider::noteOnKey(const State& state) const noexcept {
-  auto value = state.key();
-  // std::cout << "ValueProvider key " << value << "\n";
-  return value;
-}
-
-int Modulator::ValueProvider::noteOnVelocity(const State& state) const noexcept {
-  auto value = state.velocity();
-  // std::cout << "ValueProvider vel " << value << "\n";
-  return value;
-}
-
-int Modulator::ValueProvider::keyPressure(const State& state) const noexcept {
-  auto value = state.channelState().notePressure(state.key());
-  // std::cout << "ValueProvider keyPressure " << state.key() << " " << value << "\n";
-  return value;
-}
-
-int Modulator::ValueProvider::channelPressure(const State& state) const noexcept {
-  auto value = state.channelState().channelPressure();
-  // std::cout << "ValueProvider channelPressure " << value << "\n";
-  return value;
-}
-
-int Modulator::ValueProvider::pitchWheelValue(const State& state) const noexcept {
-  auto value = state.channelState().pitchWheelValue();
-  // std::cout << "ValueProvider pitchWheelValue " << value << "\n";
-  return value;
-}
-
-int Modulator::ValueProvider::pitchWheelSensitivity(const State& state) const noexcept {
-  auto value = state.channelState().pitchWheelSensitivity();
-  // std::cout << "ValueProvider pitchWheelSensitivity " << value << "\n";
-  return value;
-}
-
 Modulator::Modulator(const EntityMod::Modulator& configuration) noexcept :
 configuration_{configuration},
 amount_{configuration.amount()},
-primaryValue_{makeValueProvider(configuration.source())},
+destination_{configuration.generatorDestination()},
+primarySource_{makeSourceId(configuration.source())},
+secondarySource_{makeSourceId(configuration.amountSource())},
 primaryTransform_{configuration.source()},
-secondaryValue_{makeValueProvider(configuration.amountSource())},
 secondaryTransform_{configuration.amountSource()}
 {}
 
-Modulator::ValueProvider
-Modulator::makeValueProvider(const EntityMod::Source& source) noexcept
+SourceId
+Modulator::makeSourceId(const EntityMod::Source& source) noexcept
 {
   using GI = EntityMod::Source::GeneralIndex;
   if (source.isContinuousController()) {
-    return ValueProvider{&ValueProvider::ccValue, MIDI::ControlChange(source.ccIndex().value)};
+    return sourceIdFor(MIDI::ControlChange(source.ccIndex().value));
   }
   switch (source.generalIndex()) {
-    case GI::none: return ValueProvider{};
-    case GI::noteOnKey: return ValueProvider{&ValueProvider::noteOnKey};
-    case GI::noteOnVelocity: return ValueProvider{&ValueProvider::noteOnVelocity};
-    case GI::keyPressure: return ValueProvider{&ValueProvider::keyPressure};
-    case GI::channelPressure: return ValueProvider{&ValueProvider::channelPressure};
-    case GI::pitchWheel: return ValueProvider{&ValueProvider::pitchWheelValue};
-    case GI::pitchWheelSensitivity: return ValueProvider{&ValueProvider::pitchWheelSensitivity};
+    case GI::none: return SourceId::none;
+    case GI::noteOnKey: return SourceId::noteOnKey;
+    case GI::noteOnVelocity: return SourceId::noteOnVelocity;
+    case GI::keyPressure: return SourceId::keyPressure;
+    case GI::channelPressure: return SourceId::channelPressure;
+    case GI::pitchWheel: return SourceId::pitchWheel;
+    case GI::pitchWheelSensitivity: return SourceId::pitchWheelSensitivity;
+  }
+  return SourceId::none;
+}
+
+int
+Modulator::fetch(SourceId source, const State& state) noexcept
+{
+  switch (source) {
+    case SourceId::none: return 0;
+    case SourceId::noteOnKey: return state.key();
+    case SourceId::noteOnVelocity: return state.velocity();
+    case SourceId::keyPressure: return state.channelState().notePressure(state.key());
+    case SourceId::channelPressure: return state.channelState().channelPressure();
+    case SourceId::pitchWheel: return state.channelState().pitchWheelValue();
+    case SourceId::pitchWheelSensitivity: return state.channelState().pitchWheelSensitivity();
+    default: return state.channelState().continuousControllerValue(MIDI::ControlChange(SF2::valueOf(source)));
   }
 }
 
@@ -93,15 +68,16 @@ Float
 Modulator::value(const State& state) const noexcept
 {
   // If there is no source for the modulator, it always returns 0.0 (no modulation).
-  if (!primaryValue_.isActive()) return 0_F;
+  if (primarySource_ == SourceId::none) return 0_F;
 
   // Obtain transformed primary value.
-  auto primary{primaryValue_(state)};
+  auto primary{fetch(primarySource_, state)};
   Float transformedPrimary{primaryTransform_(primary)};
   if (transformedPrimary == 0_F) return 0_F;
 
   // Obtain transformed secondary value.
-  Float transformedSecondary{secondaryValue_.isActive() ? secondaryTransform_(secondaryValue_(state)) : 1_F};
+  Float transformedSecondary{secondarySource_ != SourceId::none ? secondaryTransform_(fetch(secondarySource_, state))
+    : 1_F};
   Float result{transformedPrimary * transformedSecondary * amount_};
   // std::cout << "P: " << primary << " tP: " << transformedPrimary << " tS: " << transformedSecondary
   // << " amount: " << amount_ << " result: " << result << "\n";
@@ -34,6 +34,7 @@ State::clear() noexcept
 
   // Reinstall default modulators just in case a prior instrument config installed something
   modulators_.clear();
+  sources_.reset();
   for (const auto& modulator : Entity::Modulator::Modulator::defaults) {
     addModulator(modulator);
   }
@@ -88,6 +89,7 @@ State::addModulator(const Entity::Modulator::Modulator& modulator) noexcept {
     }
   }
   modulators_.emplace_back(modulator);
+  sources_ |= modulators_.back().sources();
 }
 
 void
@@ -95,7 +97,7 @@ State::updateStateMods() noexcept
 {
   // Overwrite a generator's mods value with the NRPN value configured for it
   std::for_each(Entity::Generator::IndexIterator::begin(), Entity::Generator::IndexIterator::end(), [&](auto index) {
-    auto value{channelState_.nrpnValue(index)};
+    auto value{channelState_->nrpnValue(index)};
     if (value != 0 || value != gens_[index].mods()) {
       // std::cout << "setMod " << Definition::definition(index).name() << " = " << value << '\n';
       gens_[index].setMods(value);
@@ -114,6 +116,36 @@ State::updateStateMods() noexcept
   // dump();
 }
 
+void
+State::updateStateMods(SourceId source) noexcept
+{
+  if (!dependsOn(source)) return;
+
+  // Locate the generators that will be affected by the change.
+  std::bitset<static_cast<size_t>(Index::numValues)> affected;
+  for (const auto& mod : modulators_) {
+    if (mod.dependsOn(source)) affected[static_cast<size_t>(mod.destination())] = true;
+  }
+
+  // Rebuild the mods value of the affected generators -- NRPN value followed by all modulators that target it. This
+  // produces the same values as a full update but without touching unaffected generators and modulators.
+  for (size_t raw = 0; raw < affected.size(); ++raw) {
+    if (affected[raw]) {
+      auto index{Index(raw)};
+      gens_[index].setMods(channelState_->nrpnValue(index));
+    }
+  }
+
+  for (auto& mod : modulators_) {
+    if (affected[static_cast<size_t>(mod.destination())]) {
+      auto value{mod.value(*this)};
+      if (value != 0) {
+        gens_[mod.destination()].addMod(value);
+      }
+    }
+  }
+}
+
 void
 State::dump() noexcept
 {
@@ -125,5 +157,5 @@ State::dump() noexcept
   for (auto& mod : modulators_) {
     std::cout << mod.description() << '\n';
   }
-  channelState_.dump();
+  channelState_->dump();
 }
@@ -8,6 +8,7 @@
 #include "SF2Lib/Render/Voice/Sample/Bounds.hpp"
 #include "SF2Lib/Render/Voice/State/Config.hpp"
 #include "SF2Lib/Render/Voice/Voice.hpp"
+#include "SF2Lib/Trace/Trace.hpp"
 
 using namespace SF2::MIDI;
 using namespace SF2::Render::Voice;
@@ -24,6 +25,7 @@ modulatorEnvelope_{voiceIndex},
 modulatorLFO_{sampleRate},
 vibratoLFO_{sampleRate},
 filter_{sampleRate},
+linkedFilter_{sampleRate},
 active_{false},
 keyDown_{false},
 voiceIndex_{voiceIndex}
@@ -32,13 +34,21 @@ voiceIndex_{voiceIndex}
 void
 Voice::configure(const State::Config& config) noexcept
 {
-  os_signpost_interval_begin(log_, configSignpost_, "start");
+  Trace::Interval interval{Trace::Id::voiceConfigure, int32_t(voiceIndex_)};
 
   state_.prepareForVoice(config);
   sampleGenerator_.configure(config.sampleSource(), state_);
   pitch_.configure(config.sampleSource().header());
+  linked_ = false;
+}
 
-  os_signpost_interval_end(log_, configSignpost_, "end");
+void
+Voice::link(const Sample::NormalizedSampleSource& sampleSource, const State::State& partnerState) noexcept
+{
+  sampleGenerator_.link(sampleSource);
+  linkedAttenuation_ = DSP::centibelsToAttenuation(partnerState.modulated(Index::initialAttenuation));
+  linkedPanOffset_ = partnerState.modulated(Index::pan) - state_.modulated(Index::pan);
+  linked_ = true;
 }
 
 Voice::LoopingMode
@@ -54,14 +64,24 @@ Voice::loopingMode() const noexcept
 void
 Voice::start() noexcept
 {
-  os_signpost_interval_begin(log_, startSignpost_, "start");
+  Trace::Interval interval{Trace::Id::voiceStart, int32_t(voiceIndex_)};
 
   active_ = true;
+  culled_ = false;
   keyDown_ = true;
+  postponedRelease_ = false;
+  sostenutoActive_ = false;
   filter_.reset();
+  linkedFilter_.reset();
 
   loopingMode_ = loopingMode();
   initialAttenuation_ = DSP::centibelsToAttenuation(state_.modulated(Index::initialAttenuation));
+  level_ = initialAttenuation_;
+  panPeak_ = 1_F;
+  pan_.valid = false;
+  linkedPan_.valid = false;
+  linkedGainRatio_ = (linked_ && initialAttenuation_ > 0_F) ? linkedAttenuation_ / initialAttenuation_ : 0_F;
+  fadeOutRemaining_ = 0;
 
   volumeEnvelope_.configure(state_);
   modulatorEnvelope_.configure(state_);
@@ -69,8 +89,6 @@ Voice::start() noexcept
   vibratoLFO_.configure(state_);
 
   sampleGenerator_.start();
-
-  os_signpost_interval_end(log_, startSignpost_, "start");
 }
 
 void
@@ -81,6 +99,7 @@ Voice::releaseKey(const ReleaseKeyState& releaseKeyState) noexcept
     postponedRelease_ = true;
   } else {
     keyDown_ = false;
+    postponedRelease_ = false;
     volumeEnvelope_.gate(false);
     modulatorEnvelope_.gate(false);
   }
@@ -0,0 +1,185 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#include <algorithm>
+
+#include "SF2Lib/Trace/Collector.hpp"
+
+using namespace SF2::Trace;
+
+namespace {
+
+// Each collector gets a unique generation value so that a thread can tell if its cached buffer belongs to the
+// collector it is recording into, even if a new collector is created at the address of an old one.
+std::atomic<uint64_t> nextGeneration_{1};
+
+}
+
+/// The per-thread buffers of a collector and which of them are in use.
+struct Collector::Pool {
+  enum class Slot : uint8_t {
+    free,
+    recording,
+    // The thread that recorded into the buffer has exited. Free again once drained.
+    retired
+  };
+
+  /**
+   Find a buffer that is not in use and give it to the calling thread.
+
+   @returns the buffer to record into, or nullptr if all are in use
+   */
+  Buffer* claim() noexcept {
+    for (size_t index = 0; index < maxThreadCount; ++index) {
+      auto expected = Slot::free;
+      if (slots[index].compare_exchange_strong(expected, Slot::recording, std::memory_order_acquire)) {
+        auto count = used.load(std::memory_order_relaxed);
+        while (count <= index && !used.compare_exchange_weak(count, index + 1, std::memory_order_release)) {}
+        return &buffers[index];
+      }
+    }
+    return nullptr;
+  }
+
+  /**
+   Mark a buffer as no longer used by its thread.
+
+   @param buffer the buffer to give back
+   */
+  void retire(Buffer* buffer) noexcept {
+    slots[size_t(buffer - buffers.data())].store(Slot::retired, std::memory_order_release);
+  }
+
+  std::array<Buffer, maxThreadCount> buffers{};
+  std::array<std::atomic<Slot>, maxThreadCount> slots{};
+  // Number of buffers that have been used so far. Buffers at or past this index are empty.
+  std::atomic<size_t> used{0};
+};
+
+/// The buffer a thread records into. Returns the buffer when the thread exits.
+struct Collector::ThreadSlot {
+  ~ThreadSlot() noexcept { release(); }
+
+  void release() noexcept {
+    if (buffer != nullptr) pool->retire(buffer);
+    buffer = nullptr;
+    pool.reset();
+  }
+
+  uint64_t generation{0};
+  std::shared_ptr<Pool> pool{};
+  Buffer* buffer{nullptr};
+};
+
+thread_local Collector::ThreadSlot Collector::threadSlot_{};
+
+Collector&
+Collector::shared() noexcept
+{
+  static Collector collector;
+  return collector;
+}
+
+Collector::Collector() noexcept
+: pool_{std::make_shared<Pool>()},
+buffers_{pool_->buffers.data()},
+generation_{nextGeneration_.fetch_add(1, std::memory_order_relaxed)}
+{}
+
+Collector::~Collector() noexcept
+{
+  stop();
+}
+
+Collector::Buffer*
+Collector::threadBuffer() noexcept
+{
+  auto& slot = threadSlot_;
+  if (slot.generation == generation_ && slot.buffer != nullptr) return slot.buffer;
+
+  // First event from this thread, or all buffers were in use the last time. Give back any buffer held from another
+  // collector and claim an unused one here, if there is one.
+  if (slot.generation != generation_) {
+    slot.release();
+    slot.generation = generation_;
+    slot.pool = pool_;
+  }
+  slot.buffer = pool_->claim();
+  return slot.buffer;
+}
+
+size_t
+Collector::drain() noexcept
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto count = pool_->used.load(std::memory_order_acquire);
+  auto start = events_.size();
+  size_t total = 0;
+  for (size_t index = 0; index < count; ++index) {
+    // Check for a retired buffer before draining so that nothing its thread recorded is left behind when it is freed.
+    auto& slot = pool_->slots[index];
+    auto retired = slot.load(std::memory_order_acquire) == Pool::Slot::retired;
+    total += pool_->buffers[index].drain([this](const Event& event) { events_.push_back(event); });
+    if (retired) slot.store(Pool::Slot::free, std::memory_order_release);
+  }
+
+  // Events from one buffer are already in time order, so only merging between buffers is needed.
+  std::stable_sort(events_.begin() + long(start), events_.end(),
+                   [](const Event& lhs, const Event& rhs) { return lhs.timestamp < rhs.timestamp; });
+  std::inplace_merge(events_.begin(), events_.begin() + long(start), events_.end(),
+                     [](const Event& lhs, const Event& rhs) { return lhs.timestamp < rhs.timestamp; });
+  return total;
+}
+
+void
+Collector::start(std::chrono::milliseconds interval) noexcept
+{
+  if (thread_.joinable()) return;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = false;
+  }
+  thread_ = std::thread([this, interval]() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+      wakeup_.wait_for(lock, interval, [this]() { return stopping_; });
+      lock.unlock();
+      drain();
+      lock.lock();
+    }
+  });
+}
+
+void
+Collector::stop() noexcept
+{
+  if (!thread_.joinable()) return;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wakeup_.notify_all();
+  thread_.join();
+
+  // Pick up anything recorded since the last drain of the background thread.
+  drain();
+}
+
+std::vector<Event>
+Collector::take() noexcept
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<Event> events;
+  events.swap(events_);
+  return events;
+}
+
+size_t
+Collector::dropped() const noexcept
+{
+  auto count = pool_->used.load(std::memory_order_acquire);
+  auto total = unbuffered_.load(std::memory_order_relaxed);
+  for (size_t index = 0; index < count; ++index) {
+    total += pool_->buffers[index].dropped();
+  }
+  return total;
+}
@@ -0,0 +1,60 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#include <iomanip>
+#include <ostream>
+
+#include "SF2Lib/Trace/Export.hpp"
+
+using namespace SF2::Trace;
+
+namespace {
+
+const char* chromePhase(Kind kind) noexcept
+{
+  switch (kind) {
+    case Kind::begin: return "B";
+    case Kind::end: return "E";
+    case Kind::instant: return "i";
+  }
+  return "i";
+}
+
+const char* textKind(Kind kind) noexcept
+{
+  switch (kind) {
+    case Kind::begin: return "begin";
+    case Kind::end: return "end";
+    case Kind::instant: return "event";
+  }
+  return "event";
+}
+
+}
+
+void
+SF2::Trace::writeChromeTrace(std::ostream& os, const std::vector<Event>& events) noexcept
+{
+  auto origin = events.empty() ? 0 : events.front().timestamp;
+  os << "{\"traceEvents\":[";
+  for (size_t index = 0; index < events.size(); ++index) {
+    const auto& event{events[index]};
+    auto offset = event.timestamp - origin;
+    if (index > 0) os << ',';
+    os << "\n{\"name\":\"" << name(event.id) << "\",\"cat\":\"SF2Lib\",\"ph\":\"" << chromePhase(event.kind)
+       << "\",\"ts\":" << offset / 1'000 << '.' << std::setw(3) << std::setfill('0') << offset % 1'000
+       << std::setfill(' ') << ",\"pid\":1,\"tid\":" << int(event.thread);
+    if (event.kind == Kind::instant) os << ",\"s\":\"t\"";
+    os << ",\"args\":{\"arg0\":" << event.arg0 << ",\"arg1\":" << event.arg1 << "}}";
+  }
+  os << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+void
+SF2::Trace::writeTextLog(std::ostream& os, const std::vector<Event>& events) noexcept
+{
+  auto origin = events.empty() ? 0 : events.front().timestamp;
+  for (const auto& event : events) {
+    os << std::setw(12) << (event.timestamp - origin) << " [" << int(event.thread) << "] " << textKind(event.kind)
+       << ' ' << name(event.id) << ' ' << event.arg0 << ' ' << event.arg1 << '\n';
+  }
+}
@@ -3,25 +3,49 @@
 #pragma once
 
 #include <concepts>
+#include <cstdint>
+
+#include "SF2Lib/Portable/SIMD.hpp"
+
+// Apple's Accelerate framework is used unless USE_ACCELERATE is set to 0. Otherwise the SIMD kernels in
+// Portable/SIMD.hpp are used, picked at runtime for the CPU.
+#if defined(__APPLE__) && (!defined(USE_ACCELERATE) || USE_ACCELERATE == 1)
+#define SF2_ACCELERATE 1
 #include <Accelerate/Accelerate.h>
+#else
+#define SF2_ACCELERATE 0
+#endif
 
 namespace SF2 {
 
 /**
  Collection of function pointers that refer to routines found in Apple's Accelerated framework.
- These are written so that the right routine is chosen depending on the definition of `Float`.
+ These are written so that the right routine is chosen depending on the definition of `Float`. Without the framework
+ the pointers refer to the portable SIMD kernels, which have the same signatures.
  */
 template <std::floating_point T>
 struct Accelerated
 {
+#if SF2_ACCELERATE == 1
+  using Stride = vDSP_Stride;
+  using Length = vDSP_Length;
+#else
+  using Stride = long;
+  using Length = unsigned long;
+#endif
+
   /**
    Type definition for vDSP\_vflt16 / vDSP\_vflt16D routines that convert a sequence of signed 16-bit integers into
    floating-point values. NOTE that this does not do any scaling of the resulting values.
    */
-  using ConversionProc = void (*)(const int16_t*, vDSP_Stride, T*, vDSP_Stride, vDSP_Length);
+  using ConversionProc = void (*)(const int16_t*, Stride, T*, Stride, Length);
   inline static ConversionProc conversionProc = []() noexcept {
+#if SF2_ACCELERATE == 1
     if constexpr (std::is_same_v<T, float>) return vDSP_vflt16;
     if constexpr (std::is_same_v<T, double>) return vDSP_vflt16D;
+#else
+    return Portable::kernels<T>().convert;
+#endif
   }();
 
   /**
@@ -29,20 +53,86 @@ struct Accelerated
    scalar. This is used to obtain normalized values (-1.0 - +1.0) after converting from 16-bit integers to floats or
    doubles.
    */
-  using ScaleProc = void (*)(const T*, vDSP_Stride, const T*, T*, vDSP_Stride, vDSP_Length);
+  using ScaleProc = void (*)(const T*, Stride, const T*, T*, Stride, Length);
   inline static ScaleProc scaleProc = []() noexcept {
+#if SF2_ACCELERATE == 1
     if constexpr (std::is_same_v<T, float>) return vDSP_vsmul;
     if constexpr (std::is_same_v<T, double>) return vDSP_vsmulD;
+#else
+    return Portable::kernels<T>().scale;
+#endif
+  }();
+
+  /**
+   Type definition for a routine that converts a sequence of signed 16-bit integers into floating-point values and
+   scales them. The portable kernels do this in one pass; with Accelerate it is vDSP\_vflt16 followed by vDSP\_vsmul.
+   */
+  using ConversionScaleProc = void (*)(const int16_t*, Stride, const T*, T*, Stride, Length);
+  inline static ConversionScaleProc conversionScaleProc = []() noexcept -> ConversionScaleProc {
+#if SF2_ACCELERATE == 1
+    return [](const int16_t* source, Stride sourceStride, const T* scalar, T* destination, Stride destinationStride,
+              Length count) {
+      conversionProc(source, sourceStride, destination, destinationStride, count);
+      scaleProc(destination, destinationStride, scalar, destination, destinationStride, count);
+    };
+#else
+    return Portable::kernels<T>().convertScale;
+#endif
   }();
 
   /**
    Type definition for vDSP\_maxmgv / vDSP\_maxmgvD routines that calculate the max magnitude of a sequence of
    floating-point values.
    */
-  using MagnitudeProc = void (*)(const T*, vDSP_Stride, T*, vDSP_Length);
+  using MagnitudeProc = void (*)(const T*, Stride, T*, Length);
   inline static MagnitudeProc magnitudeProc = []() noexcept {
+#if SF2_ACCELERATE == 1
     if constexpr (std::is_same_v<T, float>) return vDSP_maxmgv;
     if constexpr (std::is_same_v<T, double>) return vDSP_maxmgvD;
+#else
+    return Portable::kernels<T>().magnitude;
+#endif
+  }();
+
+  /**
+   Type definition for vDSP\_vadd / vDSP\_vaddD routines that add two sequences of floating-point values together.
+   */
+  using AddProc = void (*)(const T*, Stride, const T*, Stride, T*, Stride, Length);
+  inline static AddProc addProc = []() noexcept {
+#if SF2_ACCELERATE == 1
+    if constexpr (std::is_same_v<T, float>) return vDSP_vadd;
+    if constexpr (std::is_same_v<T, double>) return vDSP_vaddD;
+#else
+    return Portable::kernels<T>().add;
+#endif
+  }();
+
+  /**
+   Type definition for vDSP\_vsma / vDSP\_vsmaD routines that multiply a sequence of floating-point values by a scalar
+   and add a second sequence to the result.
+   */
+  using ScaleAddProc = void (*)(const T*, Stride, const T*, const T*, Stride, T*, Stride, Length);
+  inline static ScaleAddProc scaleAddProc = []() noexcept {
+#if SF2_ACCELERATE == 1
+    if constexpr (std::is_same_v<T, float>) return vDSP_vsma;
+    if constexpr (std::is_same_v<T, double>) return vDSP_vsmaD;
+#else
+    return Portable::kernels<T>().scaleAdd;
+#endif
+  }();
+
+  /**
+   Type definition for the vDSP\_vdpsp routine that converts a sequence of floating-point values into 32-bit floats.
+   There is no vDSP routine for `float` values, so that case is always a plain copy.
+   */
+  using NarrowProc = void (*)(const T*, Stride, float*, Stride, Length);
+  inline static NarrowProc narrowProc = []() noexcept {
+#if SF2_ACCELERATE == 1
+    if constexpr (std::is_same_v<T, double>) return vDSP_vdpsp;
+    if constexpr (std::is_same_v<T, float>) return Portable::kernels<T>().narrow;
+#else
+    return Portable::kernels<T>().narrow;
+#endif
   }();
 };
 
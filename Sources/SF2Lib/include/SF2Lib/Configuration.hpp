@@ -2,6 +2,9 @@
 
 #pragma once
 
+// Test configuration is read from a resource bundle, which needs Foundation.
+#if defined(__APPLE__)
+
 #include <Foundation/Foundation.h>
 
 NS_ASSUME_NONNULL_BEGIN
@@ -22,3 +25,5 @@ NS_ASSUME_NONNULL_BEGIN
 @end
 
 NS_ASSUME_NONNULL_END
+
+#endif
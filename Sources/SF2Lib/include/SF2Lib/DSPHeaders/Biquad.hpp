@@ -6,7 +6,11 @@
 #include <limits>
 #include <utility>
 
+#if defined(__APPLE__)
 #include <AVFoundation/AVFoundation.h>
+#else
+#include "SF2Lib/Types.hpp"
+#endif
 
 namespace DSPHeaders::Biquad {
 
@@ -7,7 +7,11 @@
 #import <span>
 #import <vector>
 
+#if defined(__APPLE__)
 #import <AudioToolbox/AudioToolbox.h>
+#else
+#import "SF2Lib/Types.hpp"
+#endif
 
 namespace DSPHeaders {
 
@@ -117,9 +121,9 @@ public:
   AUValue*& operator[](size_t index) noexcept { return buffers_[index]; }
 
   /**
-   Adjust the buffer pointers so that they start `frames` later. Currently, this is only used in unit tests. There is
-   not a need for this type of activity in normal AUv3 sample rendering since BufferPair instances always start at the
-   right location.
+   Adjust the buffer pointers so that they start `frames` later. Currently, this is only used in unit tests and by
+   `Synthesizer::render` when it splits a render at event frames. There is not a need for this type of activity in
+   normal AUv3 sample rendering since BufferPair instances always start at the right location.
 
    @param frames the amount to shift
    */
@@ -129,6 +133,17 @@ public:
     }
   }
 
+  /**
+   Adjust the buffer pointers so that they start `frames` earlier, undoing `shiftOver`.
+
+   @param frames the amount to shift
+   */
+  void shiftBack(AUAudioFrameCount frames) noexcept {
+    for (auto& buffer : buffers_ ) {
+      buffer -= frames;
+    }
+  }
+
   /// @returns number of channel buffers
   size_t size() const noexcept { return buffers_.size(); }
 
@@ -70,6 +70,13 @@ concept HasGetPendingParameterValue = requires(T a, AUParameterAddress address)
   { a.doGetPendingParameterValue(address) } -> std::convertible_to<AUValue>;
 };
 
+/// Concept definition for a Kernel class with an optional `doOutputIsSilence` method.
+template<typename T>
+concept HasOutputIsSilence = requires(T a, NSInteger outputBusNumber)
+{
+  { a.doOutputIsSilence(outputBusNumber) } -> std::convertible_to<bool>;
+};
+
 /// Concept definition for a valid Kernel class, one that provides method definitions for the functions
 /// used by the EventProcessor template.
 template<typename T>
@@ -39,6 +39,7 @@ namespace DSPHeaders {
  - doGetPendingParameterValue [optional] -- read parameter value set outside render loop (AUParameterTree)
  - doMIDIEvent [optional] -- process MIDI v1 message
  - doRenderingStateChanged [optional] -- notification that the rendering state has changed
+ - doOutputIsSilence [optional] -- report that the last render of a bus produced only silence
  */
 template <typename KernelType>
 class EventProcessor {
@@ -153,10 +154,13 @@ public:
    @param output the buffer to hold the rendered samples
    @param realtimeEventListHead pointer to the first AURenderEvent (may be null)
    @param pullInputBlock the closure to call to obtain upstream samples
+   @param actionFlags render flags from the host (may be null). Set to `kAudioUnitRenderAction_OutputIsSilence` when
+   the kernel reports that the output holds only silence.
    */
   AUAudioUnitStatus processAndRender(const AudioTimeStamp* timestamp, UInt32 frameCount, NSInteger outputBusNumber,
                                      AudioBufferList* output, const AURenderEvent* realtimeEventListHead,
-                                     AURenderPullInputBlock pullInputBlock) noexcept {
+                                     AURenderPullInputBlock pullInputBlock,
+                                     AudioUnitRenderActionFlags* actionFlags = nullptr) noexcept {
     size_t outputBusIndex = size_t(outputBusNumber);
     assert(outputBusIndex < outputBusses_.size());
 
@@ -194,6 +198,14 @@ public:
     checkForTreeBasedParameterChanges();
     render(outputBusNumber, timestamp, frameCount, realtimeEventListHead);
 
+    if constexpr (HasOutputIsSilence<KernelType>) {
+      // The output buffer was cleared above, so it holds silence when the kernel did not render into it. The flag lets
+      // the host skip processing it.
+      if (!isBypassed() && derived_.doOutputIsSilence(outputBusNumber) && actionFlags != nullptr) {
+        *actionFlags |= kAudioUnitRenderAction_OutputIsSilence;
+      }
+    }
+
     return noErr;
   }
 
@@ -336,7 +348,11 @@ private:
   }
 
   void processEventParameterChange(const AUParameterEvent& event, AUAudioFrameCount duration) noexcept {
-    if (setImmediateParameterValue(event.parameterAddress, event.value, duration)) {
+    // A kernel that sets its own parameter values also ramps them. Only the registered parameters ramp one frame at a
+    // time during `renderFrames`.
+    if constexpr (HasSetImmediateParameterValue<KernelType>) {
+      derived_.doSetImmediateParameterValue(event.parameterAddress, event.value, duration);
+    } else if (setImmediateParameterValue(event.parameterAddress, event.value, duration)) {
       rampRemaining_ = std::max(duration, rampRemaining_);
     }
   }
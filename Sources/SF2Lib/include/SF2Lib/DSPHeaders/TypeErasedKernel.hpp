@@ -14,13 +14,13 @@ struct TypeErasedKernel
                                                            NSInteger,
                                                            AudioBufferList*,
                                                            const AURenderEvent*,
-                                                           AURenderPullInputBlock)>;
+                                                           AURenderPullInputBlock,
+                                                           AudioUnitRenderActionFlags*)>;
   TypeErasedKernel() : processAndRender{} {}
 
   TypeErasedKernel(ProcessAndRender par) : processAndRender{par} {}
 
-  std::function<AUAudioUnitStatus(const AudioTimeStamp*, UInt32, NSInteger, AudioBufferList*, const AURenderEvent*,
-                                  AURenderPullInputBlock)> processAndRender;
+  ProcessAndRender processAndRender;
 };
 
 struct RenderBlockShim
@@ -37,7 +37,7 @@ struct RenderBlockShim
                                 const AURenderEvent                *realtimeEventListHead,
                                 AURenderPullInputBlock __unsafe_unretained pullInputBlock) {
         return kernel_.processAndRender(timestamp, frameCount, outputBusNumber, outputData, realtimeEventListHead,
-                                        pullInputBlock);
+                                        pullInputBlock, actionFlags);
       };
     } else {
       return ^AUAudioUnitStatus(AudioUnitRenderActionFlags         *actionFlags,
@@ -0,0 +1,92 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "SF2Lib/Types.hpp"
+
+namespace SF2::IO {
+
+/**
+ Writes stereo audio to a file as interleaved samples. The WAV formats have a RIFF header whose sizes are filled in by
+ `close`; the raw formats hold nothing but samples. Samples are written in the byte order of the machine, which is the
+ little-endian order that WAV requires on every platform the library supports.
+ */
+class AudioFileWriter {
+public:
+
+  enum class Format {
+    /// WAV file with 16-bit integer samples
+    wav16,
+    /// WAV file with 32-bit floating-point samples
+    wavFloat,
+    /// Headerless 16-bit integer samples
+    raw16,
+    /// Headerless 32-bit floating-point samples
+    rawFloat
+  };
+
+  /**
+   Constructor. Nothing is written until `open` is called.
+
+   @param path the file to write to
+   @param format the format of the samples
+   @param sampleRate the sample rate recorded in the WAV header
+   */
+  AudioFileWriter(std::string path, Format format, uint32_t sampleRate) noexcept :
+  path_{std::move(path)}, format_{format}, sampleRate_{sampleRate} {}
+
+  /// Closes the file if `close` was not called.
+  ~AudioFileWriter() noexcept { close(); }
+
+  AudioFileWriter(const AudioFileWriter&) = delete;
+  AudioFileWriter& operator=(const AudioFileWriter&) = delete;
+
+  /**
+   Create the file and write a WAV header with empty sizes.
+
+   @returns true if successful
+   */
+  bool open() noexcept;
+
+  /**
+   Append samples to the file. Samples outside of -1.0 - +1.0 are clipped when written as 16-bit integers.
+
+   @param left the samples of the left channel
+   @param right the samples of the right channel
+   @param frameCount the number of samples in each channel
+   @returns true if successful
+   */
+  bool write(const AUValue* left, const AUValue* right, size_t frameCount) noexcept;
+
+  /**
+   Fill in the sizes of the WAV header and close the file.
+
+   @returns true if all writes were successful
+   */
+  bool close() noexcept;
+
+  /// @returns the number of frames written so far
+  uint64_t frameCount() const noexcept { return frameCount_; }
+
+  /// @returns the file extension that suits the format, without a leading period
+  static const char* extension(Format format) noexcept;
+
+private:
+  bool isWAV() const noexcept { return format_ == Format::wav16 || format_ == Format::wavFloat; }
+  bool isFloat() const noexcept { return format_ == Format::wavFloat || format_ == Format::rawFloat; }
+  void writeHeader(uint64_t frameCount);
+
+  std::string path_;
+  Format format_;
+  uint32_t sampleRate_;
+  std::ofstream os_{};
+  std::vector<char> buffer_{};
+  uint64_t frameCount_{0};
+};
+
+} // end namespace SF2::IO
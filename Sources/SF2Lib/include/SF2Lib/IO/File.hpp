@@ -162,7 +162,6 @@ private:
 
   std::vector<size_t> presetIndicesOrderedByBankProgram_{};
 
-  const os_log_t log_{os_log_create("SF2Lib", "File")};
 };
 
 } // end namespace SF2::IO
@@ -0,0 +1,96 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace SF2::MIDI {
+
+/**
+ A Standard MIDI File (SMF) reduced to the one thing a renderer needs: the MIDI messages of all tracks merged into one
+ sequence, each with the time at which it plays. Times are converted from ticks using the tempo changes found in any
+ track, or from the SMPTE frame rate when the file uses SMPTE timing. Channel messages are stored with their status
+ byte even when the file uses running status. SysEx messages are stored as complete 0xF0 ... 0xF7 messages. Meta events
+ other than tempo changes, and SysEx continuation packets (0xF7), are dropped.
+
+ Format 0 and 1 files are supported, with the tracks played at the same time. Events with the same time keep the order
+ of their tracks. Format 2 files hold independent sequences rather than parts of one, so they are rejected as
+ `invalidFormat`, as is a SMPTE time division with no ticks per frame.
+ */
+class MIDIFile {
+public:
+
+  enum class LoadResponse {
+    ok,
+    notFound,
+    invalidFormat
+  };
+
+  /// A MIDI message and the time at which it plays.
+  struct Event {
+    /// Time of the event in seconds from the start of the file
+    double seconds;
+    /// Offset of the first byte of the message in the message storage
+    uint32_t offset;
+    /// Number of bytes in the message
+    uint32_t size;
+  };
+
+  /**
+   Constructor.
+
+   @param path the file to read
+   */
+  explicit MIDIFile(std::string path) noexcept : path_{std::move(path)} {}
+
+  /**
+   Read and parse the file given in the constructor.
+
+   @returns status of the load
+   */
+  LoadResponse load() noexcept;
+
+  /**
+   Parse SMF data that is already in memory.
+
+   @param data the contents of a SMF file
+   @returns status of the parse
+   */
+  LoadResponse parse(std::span<const uint8_t> data) noexcept;
+
+  /// @returns the path given in the constructor
+  const std::string& path() const noexcept { return path_; }
+
+  /// @returns the SMF format (0 or 1)
+  int format() const noexcept { return format_; }
+
+  /// @returns the number of tracks in the file
+  size_t trackCount() const noexcept { return trackCount_; }
+
+  /// @returns the events of all tracks in the order they play
+  const std::vector<Event>& events() const noexcept { return events_; }
+
+  /**
+   @param event the event to look at
+   @returns the bytes of the MIDI message of the event
+   */
+  std::span<const uint8_t> message(const Event& event) const noexcept {
+    return {messages_.data() + event.offset, event.size};
+  }
+
+  /// @returns the time in seconds of the last end-of-track meta event, or of the last event if that is later
+  double duration() const noexcept { return duration_; }
+
+private:
+  std::string path_;
+  int format_{0};
+  size_t trackCount_{0};
+  std::vector<Event> events_{};
+  std::vector<uint8_t> messages_{};
+  double duration_{0.0};
+};
+
+} // end namespace SF2::MIDI
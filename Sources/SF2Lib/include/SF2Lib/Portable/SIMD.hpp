@@ -0,0 +1,76 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#pragma once
+
+#include <concepts>
+#include <cstdint>
+
+namespace SF2::Portable {
+
+/**
+ The instruction sets that have SIMD kernels. Which ones are usable depends on the architecture the library was built
+ for (SSE2 and AVX2 on x86-64, NEON on ARM64) and, for AVX2, on the CPU that is running it.
+ */
+enum class InstructionSet {
+  scalar,
+  sse2,
+  avx2,
+  neon
+};
+
+/**
+ Set of vector routines for one instruction set. Each routine has the same signature and behavior as the vDSP routine
+ named in its comment, so they can stand in for them in `Accelerated`. Strides other than 1 are supported, but they
+ always run the scalar code.
+ */
+template <std::floating_point T>
+struct Kernels {
+  /// Convert 16-bit integers into floating-point values (vDSP\_vflt16)
+  void (*convert)(const int16_t*, long, T*, long, unsigned long) noexcept;
+  /// Convert 16-bit integers into floating-point values and scale them in one pass
+  void (*convertScale)(const int16_t*, long, const T*, T*, long, unsigned long) noexcept;
+  /// Multiply by a scalar (vDSP\_vsmul)
+  void (*scale)(const T*, long, const T*, T*, long, unsigned long) noexcept;
+  /// Obtain the largest magnitude (vDSP\_maxmgv)
+  void (*magnitude)(const T*, long, T*, unsigned long) noexcept;
+  /// Add two sequences (vDSP\_vadd)
+  void (*add)(const T*, long, const T*, long, T*, long, unsigned long) noexcept;
+  /// Multiply by a scalar and add a second sequence (vDSP\_vsma)
+  void (*scaleAdd)(const T*, long, const T*, const T*, long, T*, long, unsigned long) noexcept;
+  /// Convert into 32-bit floats (vDSP\_vdpsp)
+  void (*narrow)(const T*, long, float*, long, unsigned long) noexcept;
+};
+
+/**
+ Obtain the kernels for an instruction set.
+
+ @param instructionSet the instruction set to use
+ @returns pointer to the kernels or nullptr if the instruction set is not available in this build or on this CPU
+ */
+template <std::floating_point T>
+const Kernels<T>* kernels(InstructionSet instructionSet) noexcept;
+
+/**
+ Obtain the fastest instruction set that is available. This is determined once from the features of the CPU.
+
+ @returns the instruction set to use
+ */
+InstructionSet bestInstructionSet() noexcept;
+
+/**
+ @param instructionSet the instruction set to check
+ @returns true if the kernels for the instruction set can be used
+ */
+inline bool available(InstructionSet instructionSet) noexcept { return kernels<float>(instructionSet) != nullptr; }
+
+/**
+ @param instructionSet the instruction set to name
+ @returns the name of the instruction set
+ */
+const char* name(InstructionSet instructionSet) noexcept;
+
+/// @returns the kernels of the fastest instruction set that is available
+template <std::floating_point T>
+const Kernels<T>& kernels() noexcept { return *kernels<T>(bestInstructionSet()); }
+
+} // end namespace SF2::Portable
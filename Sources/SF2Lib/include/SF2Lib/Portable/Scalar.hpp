@@ -0,0 +1,159 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+
+/**
+ Plain C++ versions of the vDSP routines used by `Accelerated`. They have the same signatures as the vDSP routines, and
+ they are the reference that the SIMD kernels in `Portable/SIMD.hpp` are checked and benchmarked against.
+ */
+namespace SF2::Portable::Scalar {
+
+/**
+ Convert 16-bit integers into floating-point values (vDSP\_vflt16).
+
+ @param source the values to convert
+ @param sourceStride the distance between source values
+ @param destination the location to store the converted values
+ @param destinationStride the distance between destination values
+ @param count the number of values to convert
+ */
+template <std::floating_point T>
+void convert(const int16_t* source, long sourceStride, T* destination, long destinationStride,
+             unsigned long count) noexcept
+{
+  for (unsigned long index = 0; index < count; ++index) {
+    destination[long(index) * destinationStride] = T(source[long(index) * sourceStride]);
+  }
+}
+
+/**
+ Convert 16-bit integers into floating-point values and scale them (vDSP\_vflt16 followed by vDSP\_vsmul).
+
+ @param source the values to convert
+ @param sourceStride the distance between source values
+ @param scalar the value to multiply with
+ @param destination the location to store the scaled values
+ @param destinationStride the distance between destination values
+ @param count the number of values to convert
+ */
+template <std::floating_point T>
+void convertScale(const int16_t* source, long sourceStride, const T* scalar, T* destination, long destinationStride,
+                  unsigned long count) noexcept
+{
+  auto value = *scalar;
+  for (unsigned long index = 0; index < count; ++index) {
+    destination[long(index) * destinationStride] = T(source[long(index) * sourceStride]) * value;
+  }
+}
+
+/**
+ Multiply floating-point values by a scalar (vDSP\_vsmul).
+
+ @param source the values to scale
+ @param sourceStride the distance between source values
+ @param scalar the value to multiply with
+ @param destination the location to store the scaled values
+ @param destinationStride the distance between destination values
+ @param count the number of values to scale
+ */
+template <std::floating_point T>
+void scale(const T* source, long sourceStride, const T* scalar, T* destination, long destinationStride,
+           unsigned long count) noexcept
+{
+  auto value = *scalar;
+  for (unsigned long index = 0; index < count; ++index) {
+    destination[long(index) * destinationStride] = source[long(index) * sourceStride] * value;
+  }
+}
+
+/**
+ Obtain the largest magnitude of floating-point values (vDSP\_maxmgv).
+
+ @param source the values to visit
+ @param sourceStride the distance between source values
+ @param result the location to store the largest magnitude
+ @param count the number of values to visit
+ */
+template <std::floating_point T>
+void magnitude(const T* source, long sourceStride, T* result, unsigned long count) noexcept
+{
+  T peak = 0;
+  for (unsigned long index = 0; index < count; ++index) {
+    peak = std::max(peak, std::abs(source[long(index) * sourceStride]));
+  }
+  *result = peak;
+}
+
+/**
+ Add two sequences of floating-point values (vDSP\_vadd).
+
+ @param first the first values to add
+ @param firstStride the distance between first values
+ @param second the second values to add
+ @param secondStride the distance between second values
+ @param destination the location to store the sums
+ @param destinationStride the distance between destination values
+ @param count the number of values to add
+ */
+template <std::floating_point T>
+void add(const T* first, long firstStride, const T* second, long secondStride, T* destination,
+         long destinationStride, unsigned long count) noexcept
+{
+  for (unsigned long index = 0; index < count; ++index) {
+    auto offset = long(index);
+    destination[offset * destinationStride] = first[offset * firstStride] + second[offset * secondStride];
+  }
+}
+
+/**
+ Multiply floating-point values by a scalar and add a second sequence to them (vDSP\_vsma).
+
+ @param first the values to scale
+ @param firstStride the distance between first values
+ @param scalar the value to multiply with
+ @param second the values to add
+ @param secondStride the distance between second values
+ @param destination the location to store the results
+ @param destinationStride the distance between destination values
+ @param count the number of values to process
+ */
+template <std::floating_point T>
+void scaleAdd(const T* first, long firstStride, const T* scalar, const T* second, long secondStride, T* destination,
+              long destinationStride, unsigned long count) noexcept
+{
+  auto value = *scalar;
+  for (unsigned long index = 0; index < count; ++index) {
+#if defined(__clang__)
+    // Keep the multiply and the add as two rounded operations like the SIMD kernels -- a fused multiply-add would round
+    // once and no longer match them bit for bit.
+#pragma clang fp contract(off)
+#endif
+    auto offset = long(index);
+    destination[offset * destinationStride] = first[offset * firstStride] * value + second[offset * secondStride];
+  }
+}
+
+/**
+ Convert floating-point values into 32-bit floats (vDSP\_vdpsp).
+
+ @param source the values to convert
+ @param sourceStride the distance between source values
+ @param destination the location to store the converted values
+ @param destinationStride the distance between destination values
+ @param count the number of values to convert
+ */
+template <std::floating_point T>
+void narrow(const T* source, long sourceStride, float* destination, long destinationStride,
+            unsigned long count) noexcept
+{
+  for (unsigned long index = 0; index < count; ++index) {
+    destination[long(index) * destinationStride] = float(source[long(index) * sourceStride]);
+  }
+}
+
+} // end namespace SF2::Portable::Scalar
@@ -0,0 +1,203 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <memory>
+
+#include "SF2Lib/Types.hpp"
+#include "SF2Lib/Render/Engine/Parameters.hpp"
+#include "SF2Lib/Render/SoundFont.hpp"
+#include "SF2Lib/Trace/RingBuffer.hpp"
+
+namespace SF2::Render::Engine {
+
+/**
+ A control request for the render thread. Commands are plain values so that they can be copied through a lock-free
+ queue without allocating. Use the factory functions to create them.
+ */
+struct Command {
+
+  enum class Type : uint8_t {
+    /// Use the preset at `index` on all channels
+    usePreset,
+    /// Use the preset at `bank`/`program` on `channel`
+    useBankProgram,
+    /// Use the sound font at `soundFont` and its preset at `index`
+    useSoundFont,
+    /// Change the generator or engine setting at `address` to `value`
+    setParameter,
+    /// Limit the number of voices that may play at the same time to `index`
+    setVoiceLimit,
+    /// Stop all voices
+    allOff,
+    /// Stop all voices and reset the state of all channels
+    reset
+  };
+
+  /**
+   @param index the index of the preset to use
+   @returns command that activates a preset on all channels
+   */
+  static Command usePreset(size_t index) noexcept { return {.type = Type::usePreset, .index = index}; }
+
+  /**
+   @param channel the MIDI channel to change
+   @param bank the bank of the preset to use
+   @param program the program of the preset to use
+   @returns command that activates a preset on one channel
+   */
+  static Command useBankProgram(size_t channel, uint16_t bank, uint16_t program) noexcept {
+    return {.type = Type::useBankProgram, .index = channel, .bank = bank, .program = program};
+  }
+
+  /**
+   @param address the generator index or `Parameters::EngineParameterAddress` value to change
+   @param value the new value
+   @returns command that changes a generator or engine setting
+   */
+  static Command setParameter(AUParameterAddress address, AUValue value) noexcept {
+    return {.type = Type::setParameter, .address = address, .value = value};
+  }
+
+  /**
+   @param mode the engine mode to change, such as `Parameters::EngineParameterAddress::polyphonicModeEnabled`
+   @param enabled the new state of the mode
+   @returns command that turns an engine mode on or off
+   */
+  static Command setMode(Parameters::EngineParameterAddress mode, bool enabled) noexcept {
+    return setParameter(valueOf(mode), enabled ? 1.0f : 0.0f);
+  }
+
+  /**
+   @param voiceCount the most voices that may play at the same time
+   @returns command that limits polyphony
+   */
+  static Command setVoiceLimit(size_t voiceCount) noexcept {
+    return {.type = Type::setVoiceLimit, .index = voiceCount};
+  }
+
+  /// @returns command that stops all voices
+  static Command allOff() noexcept { return {.type = Type::allOff}; }
+
+  /// @returns command that stops all voices and resets all channels
+  static Command reset() noexcept { return {.type = Type::reset}; }
+
+  Type type{Type::allOff};
+  size_t index{0};
+  uint16_t bank{0};
+  uint16_t program{0};
+  AUParameterAddress address{0};
+  AUValue value{0.0f};
+  /// Sound font held by the `CommandQueue` that posted the command
+  const std::shared_ptr<const SoundFont>* soundFont{nullptr};
+};
+
+/**
+ Single-producer, single-consumer queue of `Command` values from one control thread to the render thread. Posting
+ never blocks and never waits on the render thread. If the queue is full, the command is dropped and `post` returns
+ false. The render thread drains a bounded number of commands at the start of each block.
+
+ Sound fonts need more care since the render thread must never release the last reference to one, which would free
+ its memory while rendering. `postSoundFont` keeps a reference on the control side. It lets go of a sound font only
+ after the render thread has applied a later `useSoundFont` command, at which point the render thread no longer holds
+ a reference to the old one.
+ */
+class CommandQueue
+{
+public:
+
+  /// The maximum number of commands waiting for the render thread
+  static inline constexpr size_t capacity = 256;
+
+  CommandQueue() noexcept = default;
+
+  CommandQueue(const CommandQueue&) = delete;
+  CommandQueue& operator=(const CommandQueue&) = delete;
+
+  /**
+   Add a command to the queue. Only call from the control thread.
+
+   @param command the command to add
+   @returns true if added, false if the queue was full and the command was dropped
+   */
+  bool post(const Command& command) noexcept
+  {
+    if (!ring_.push(command)) return false;
+    ++posted_;
+    return true;
+  }
+
+  /**
+   Add a command that switches to a sound font. Only call from the control thread.
+
+   @param soundFont the sound font to use
+   @param index the index of the preset to use
+   @returns true if added, false if the queue was full and the command was dropped
+   */
+  bool postSoundFont(std::shared_ptr<const SoundFont> soundFont, size_t index)
+  {
+    releaseRetiredSoundFonts();
+    auto& retained = retained_.emplace_back(std::move(soundFont), posted_);
+    if (!post({.type = Command::Type::useSoundFont, .index = index, .soundFont = &retained.soundFont})) {
+      retained_.pop_back();
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   Apply waiting commands. Only call from the render thread.
+
+   @param proc the function to call with each command, oldest first
+   @param maxCount the most commands to apply
+   @returns the number of commands applied
+   */
+  template <typename Proc>
+  size_t drain(Proc&& proc, size_t maxCount) noexcept
+  {
+    auto count = ring_.drain(std::forward<Proc>(proc), maxCount);
+    applied_.fetch_add(count, std::memory_order_release);
+    return count;
+  }
+
+  /// @returns true if there are no commands waiting for the render thread
+  bool empty() const noexcept { return ring_.empty(); }
+
+  /// @returns the number of commands dropped because the queue was full
+  size_t dropped() const noexcept { return ring_.dropped(); }
+
+  /// @returns the number of sound fonts held by the control side
+  size_t retainedSoundFontCount() const noexcept { return retained_.size(); }
+
+private:
+
+  struct Retained {
+    Retained(std::shared_ptr<const SoundFont> value, uint64_t seq) noexcept :
+    soundFont{std::move(value)}, sequence{seq} {}
+
+    std::shared_ptr<const SoundFont> soundFont;
+    uint64_t sequence;
+  };
+
+  void releaseRetiredSoundFonts() noexcept
+  {
+    // A sound font is retired once a later one has been applied by the render thread. Only the newest applied one (and
+    // any still waiting in the queue) must be kept.
+    auto applied = applied_.load(std::memory_order_acquire);
+    while (retained_.size() > 1 && std::next(retained_.begin())->sequence < applied) {
+      retained_.pop_front();
+    }
+  }
+
+  Trace::RingBuffer<Command, capacity> ring_{};
+  uint64_t posted_{0};
+  std::atomic<uint64_t> applied_{0};
+  // A list so that the addresses held by queued commands stay valid as sound fonts come and go.
+  std::list<Retained> retained_{};
+};
+
+} // end namespace SF2::Render::Engine
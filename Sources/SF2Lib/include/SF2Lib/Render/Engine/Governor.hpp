@@ -0,0 +1,164 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+
+#include "SF2Lib/Types.hpp"
+#include "SF2Lib/Render/Voice/Sample/Generator.hpp"
+
+namespace SF2::Render::Engine {
+
+/**
+ Tracks how long it takes the engine to render a block of samples relative to the real-time duration of the block, and
+ decides how much rendering quality to give up in order to avoid audio dropouts. The degradation is done in steps or
+ levels:
+
+ - 0: full quality
+ - 1: new voices use linear interpolation
+ - 2: release tails of voices are shortened
+ - 3: polyphony is limited to 3/4 of the available voices
+ - 4: polyphony is limited to 1/2 of the available voices
+
+ Each level includes the ones below it. The level rises when the smoothed load goes above the configured load limit,
+ and it falls back one step at a time once the load has stayed below half of the limit for `restoreBlockCount` blocks.
+ */
+class Governor
+{
+public:
+  using Interpolator = Render::Voice::Sample::Interpolator;
+
+  /// The highest degradation level
+  static inline constexpr size_t maxLevel = 4;
+
+  /// Number of consecutive light-load blocks required before restoring one level of quality
+  static inline constexpr size_t restoreBlockCount = 64;
+
+  /// Number of blocks to wait after raising the level before raising it again
+  static inline constexpr size_t degradeHoldBlockCount = 4;
+
+  /// Cull threshold applied to releasing voices when release tails are shortened
+  static inline constexpr Float releaseCullThresholdDecibels = -60_F;
+
+  /// Default fraction of a block's real-time duration that rendering may consume
+  static inline constexpr Float defaultLoadLimit = 0.75_F;
+
+  /// @returns true if the governor is active
+  bool enabled() const noexcept { return enabled_; }
+
+  /**
+   Enable or disable the governor. Disabling restores full quality.
+
+   @param value true to enable
+   */
+  void setEnabled(bool value) noexcept {
+    enabled_ = value;
+    if (!value) reset();
+  }
+
+  /// @returns the fraction of a block's real-time duration that rendering may consume before degrading quality
+  Float loadLimit() const noexcept { return loadLimit_; }
+
+  /**
+   Set the fraction of a block's real-time duration that rendering may consume before degrading quality.
+
+   @param value the limit to use, clamped to [0.1, 1.0]
+   */
+  void setLoadLimit(Float value) noexcept { loadLimit_ = std::clamp(value, 0.1_F, 1_F); }
+
+  /**
+   Record the time it took to render a block.
+
+   @param elapsedSeconds the time spent rendering
+   @param deadlineSeconds the real-time duration of the block that was rendered
+   @returns true if the degradation level changed
+   */
+  bool update(double elapsedSeconds, double deadlineSeconds) noexcept {
+    if (!enabled_ || deadlineSeconds <= 0.0) return false;
+
+    auto load = Float(elapsedSeconds / deadlineSeconds);
+    if (load >= 1_F) ++overloadCount_;
+    load_ = load > load_ ? load : load_ + smoothing * (load - load_);
+
+    auto level = level_.load();
+    if (holdCounter_ > 0) --holdCounter_;
+
+    if (load_ > loadLimit_) {
+      lightBlocks_ = 0;
+      if (level < maxLevel && holdCounter_ == 0) {
+        level_ = level + 1;
+        holdCounter_ = degradeHoldBlockCount;
+        ++degradeCount_;
+        return true;
+      }
+    } else if (load_ < loadLimit_ / 2_F) {
+      if (level > 0 && ++lightBlocks_ >= restoreBlockCount) {
+        level_ = level - 1;
+        lightBlocks_ = 0;
+        return true;
+      }
+    } else {
+      lightBlocks_ = 0;
+    }
+
+    return false;
+  }
+
+  /// Return to full quality and clear the load history.
+  void reset() noexcept {
+    level_ = 0;
+    load_ = 0_F;
+    lightBlocks_ = 0;
+    holdCounter_ = 0;
+  }
+
+  /// @returns the current degradation level
+  size_t level() const noexcept { return level_; }
+
+  /// @returns the smoothed render load as a fraction of the real-time duration of a block
+  Float load() const noexcept { return load_; }
+
+  /// @returns the number of blocks that took longer to render than their real-time duration
+  size_t overloadCount() const noexcept { return overloadCount_; }
+
+  /// @returns the number of times the degradation level was raised
+  size_t degradeCount() const noexcept { return degradeCount_; }
+
+  /**
+   @param configured the interpolation given to the engine
+   @returns the interpolation to use for new voices
+   */
+  Interpolator interpolator(Interpolator configured) const noexcept {
+    return level_ >= 1 ? Interpolator::linear : configured;
+  }
+
+  /// @returns true if release tails should be shortened
+  bool shortenReleases() const noexcept { return level_ >= 2; }
+
+  /**
+   @param voiceCount the number of voices available to the engine
+   @returns the number of voices that may play at the same time
+   */
+  size_t voiceLimit(size_t voiceCount) const noexcept {
+    switch (level_.load()) {
+      case 0: case 1: case 2: return voiceCount;
+      case 3: return std::max<size_t>(1, voiceCount * 3 / 4);
+      default: return std::max<size_t>(1, voiceCount / 2);
+    }
+  }
+
+private:
+  static inline constexpr Float smoothing = 0.1_F;
+
+  std::atomic<bool> enabled_{false};
+  std::atomic<size_t> level_{0};
+  Float loadLimit_{defaultLoadLimit};
+  Float load_{0_F};
+  size_t lightBlocks_{0};
+  size_t holdCounter_{0};
+  size_t overloadCount_{0};
+  size_t degradeCount_{0};
+};
+
+} // namespace SF2::Render::Engine
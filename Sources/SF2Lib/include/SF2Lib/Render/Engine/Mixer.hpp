@@ -2,6 +2,10 @@
 
 #pragma once
 
+#include <array>
+
+#include "SF2Lib/Accelerated.hpp"
+#include "SF2Lib/Types.hpp"
 #include "SF2Lib/DSPHeaders/BusBuffers.hpp"
 
 namespace SF2::Render::Engine {
@@ -10,6 +14,9 @@ class Mixer
 {
 public:
 
+  /// Maximum number of frames that can be mixed in one call to `add`.
+  static inline constexpr AUAudioFrameCount blockSize = 64;
+
   /**
    Construct new mixer that consists of three output busses. The arguments take a value type so that they may be
    constructed at the call site or used directly from a function return. Alternative would be to define move operations
@@ -26,19 +33,52 @@ public:
   }
 
   /**
-   Add a sample to the output buffers.
+   Mix a block of mono samples from a voice into the output buffers. The samples are panned by applying separate left
+   and right gains, and then the panned samples are added to the dry bus and, scaled by their send levels, to the
+   chorus and reverb send busses. Each bus is updated in one vectorized pass.
 
-   @param frame the frame to hold the samples
-   @param left the sample for the left channel
-   @param right the sample for the right channel
+   @param frame the offset of the first frame to update
+   @param samples the mono samples to mix
+   @param frameCount the number of samples to mix (must be <= `blockSize`)
+   @param leftGain the gain to apply to the samples for the left channel
+   @param rightGain the gain to apply to the samples for the right channel
    @param chorusLevel the amount of the L+R samples to send to the chorusSend bus
    @param reverbLevel the amount of the L+R samples to send to the reverbSend bus
    */
-  void add(AUAudioFrameCount frame, AUValue left, AUValue right, AUValue chorusLevel, AUValue reverbLevel) noexcept
+  void add(AUAudioFrameCount frame, const Float* samples, AUAudioFrameCount frameCount, Float leftGain,
+           Float rightGain, AUValue chorusLevel, AUValue reverbLevel) noexcept
   {
-    dry_.addStereo(frame, left, right);
-    if (chorusSend_.isValid()) chorusSend_.addStereo(frame, left * chorusLevel, right * chorusLevel);
-    if (reverbSend_.isValid()) reverbSend_.addStereo(frame, left * reverbLevel, right * reverbLevel);
+    assert(frameCount <= blockSize);
+    if (frameCount == 0) return;
+    pan(samples, leftGain, left_.data(), frameCount);
+    pan(samples, rightGain, right_.data(), frameCount);
+    mix(frame, frameCount, chorusLevel, reverbLevel);
+  }
+
+  /**
+   Mix a block of mono samples from a voice into the output buffers while the pan gains move linearly to new values.
+   The gain applied to the first sample is the starting gain plus one step.
+
+   @param frame the offset of the first frame to update
+   @param samples the mono samples to mix
+   @param frameCount the number of samples to mix (must be <= `blockSize`)
+   @param leftGain the starting gain for the left channel
+   @param rightGain the starting gain for the right channel
+   @param leftStep the change in the left gain for each sample
+   @param rightStep the change in the right gain for each sample
+   @param chorusLevel the amount of the L+R samples to send to the chorusSend bus
+   @param reverbLevel the amount of the L+R samples to send to the reverbSend bus
+   */
+  void addRamped(AUAudioFrameCount frame, const Float* samples, AUAudioFrameCount frameCount, Float leftGain,
+                 Float rightGain, Float leftStep, Float rightStep, AUValue chorusLevel, AUValue reverbLevel) noexcept
+  {
+    assert(frameCount <= blockSize);
+    if (frameCount == 0) return;
+    for (AUAudioFrameCount index = 0; index < frameCount; ++index) {
+      left_[index] = AUValue((leftGain + leftStep * (index + 1)) * samples[index]);
+      right_[index] = AUValue((rightGain + rightStep * (index + 1)) * samples[index]);
+    }
+    mix(frame, frameCount, chorusLevel, reverbLevel);
   }
 
   /**
@@ -53,10 +93,61 @@ public:
     reverbSend_.shiftOver(frames);
   }
 
+  /**
+   Command the individual BusBuffer instances to shift back by `frames` frames, undoing `shiftOver`.
+
+   @param frames the number of frames to shift back
+   */
+  void shiftBack(AUAudioFrameCount frames) noexcept
+  {
+    dry_.shiftBack(frames);
+    chorusSend_.shiftBack(frames);
+    reverbSend_.shiftBack(frames);
+  }
+
 private:
+  using Accelerated = SF2::Accelerated<AUValue>;
+
+  void mix(AUAudioFrameCount frame, AUAudioFrameCount frameCount, AUValue chorusLevel, AUValue reverbLevel) noexcept
+  {
+    accumulate(dry_, frame, frameCount);
+    if (chorusSend_.isValid()) send(chorusSend_, frame, frameCount, chorusLevel);
+    if (reverbSend_.isValid()) send(reverbSend_, frame, frameCount, reverbLevel);
+  }
+
+  template <std::floating_point T>
+  void pan(const T* samples, T gain, AUValue* destination, AUAudioFrameCount frameCount) noexcept
+  {
+    if constexpr (std::is_same_v<T, AUValue>) {
+      Accelerated::scaleProc(samples, 1, &gain, destination, 1, frameCount);
+    } else {
+      static_assert(std::is_same_v<T, double>);
+      SF2::Accelerated<T>::scaleProc(samples, 1, &gain, work_.data(), 1, frameCount);
+      SF2::Accelerated<T>::narrowProc(work_.data(), 1, destination, 1, frameCount);
+    }
+  }
+
+  void accumulate(DSPHeaders::BusBuffers& bus, AUAudioFrameCount frame, AUAudioFrameCount frameCount) noexcept
+  {
+    assert(bus.isStereo());
+    Accelerated::addProc(bus[0] + frame, 1, left_.data(), 1, bus[0] + frame, 1, frameCount);
+    Accelerated::addProc(bus[1] + frame, 1, right_.data(), 1, bus[1] + frame, 1, frameCount);
+  }
+
+  void send(DSPHeaders::BusBuffers& bus, AUAudioFrameCount frame, AUAudioFrameCount frameCount,
+            AUValue level) noexcept
+  {
+    assert(bus.isStereo());
+    Accelerated::scaleAddProc(left_.data(), 1, &level, bus[0] + frame, 1, bus[0] + frame, 1, frameCount);
+    Accelerated::scaleAddProc(right_.data(), 1, &level, bus[1] + frame, 1, bus[1] + frame, 1, frameCount);
+  }
+
   DSPHeaders::BusBuffers dry_;
   DSPHeaders::BusBuffers chorusSend_;
   DSPHeaders::BusBuffers reverbSend_;
+  alignas(16) std::array<AUValue, blockSize> left_;
+  alignas(16) std::array<AUValue, blockSize> right_;
+  alignas(16) std::array<double, blockSize> work_;
 };
 
 } // end namespace
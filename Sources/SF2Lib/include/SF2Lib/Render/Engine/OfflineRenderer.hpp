@@ -0,0 +1,129 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "SF2Lib/IO/AudioFileWriter.hpp"
+#include "SF2Lib/MIDI/MIDIFile.hpp"
+#include "SF2Lib/Render/Engine/RenderEvent.hpp"
+#include "SF2Lib/Render/Engine/Synthesizer.hpp"
+#include "SF2Lib/Render/SoundFont.hpp"
+
+namespace SF2::Render::Engine {
+
+/**
+ Renders Standard MIDI Files to audio as fast as the CPU allows. The events of a file are applied to a `Synthesizer` at
+ the exact sample at which they play: each block of events is handed to `Synthesizer::render`, which splits the render
+ at the event frames, so the block size only sets how much audio is produced per pass. The synthesizer runs in
+ multi-timbral mode so that each MIDI channel has its own preset, and only the dry stereo bus is rendered since there
+ are no chorus or reverb effects to feed.
+
+ A renderer owns one synthesizer and may render any number of files one after the other. Use `renderFiles` to render
+ many files in parallel, each thread with its own renderer and all of them sharing one `SoundFont`.
+ */
+class OfflineRenderer
+{
+public:
+
+  /// Settings for rendering.
+  struct Options {
+    /// The sample rate of the rendered audio
+    Float sampleRate{44'100_F};
+    /// The maximum number of voices of the synthesizer
+    size_t voiceCount{Synthesizer::maxVoiceCount};
+    /// The interpolation to use when rendering samples
+    Synthesizer::Interpolator interpolator{Synthesizer::Interpolator::cubic4thOrder};
+    /// The number of frames produced by each pass
+    AUAudioFrameCount blockSize{4'096};
+    /// The longest time to keep rendering after the end of the file while voices are still sounding
+    double tailSeconds{5.0};
+    /// The preset that all channels use until a program change (and the percussion channel uses bank 128)
+    size_t presetIndex{0};
+    /// The format of the audio files written by `renderFile`
+    IO::AudioFileWriter::Format format{IO::AudioFileWriter::Format::wav16};
+  };
+
+  /// The outcome of rendering one file.
+  struct Result {
+    /// True if the file was rendered and written
+    bool ok{false};
+    /// Description of the failure when `ok` is false
+    std::string error{};
+    /// The number of frames rendered
+    uint64_t frameCount{0};
+    /// The wall-clock time spent rendering, in seconds
+    double renderSeconds{0.0};
+  };
+
+  /// One file to render by `renderFiles`.
+  struct Job {
+    /// The MIDI file to render
+    std::string midiPath;
+    /// The audio file to write
+    std::string outputPath;
+  };
+
+  /// Receives the rendered audio, one block at a time.
+  using Sink = std::function<bool(const AUValue* left, const AUValue* right, AUAudioFrameCount frameCount)>;
+
+  /**
+   Constructor.
+
+   @param soundFont the sound font to render with
+   @param options the settings to use
+   */
+  OfflineRenderer(std::shared_ptr<const SoundFont> soundFont, Options options);
+
+  /**
+   Render MIDI events. The audio ends once the last event has played and all voices have stopped, or once the tail
+   time has passed, rounded up to a whole block.
+
+   @param midiFile the events to render
+   @param sink the function to give the rendered audio to. Rendering stops if it returns false.
+   @returns the number of frames rendered
+   */
+  uint64_t render(const MIDI::MIDIFile& midiFile, const Sink& sink);
+
+  /**
+   Load a MIDI file, render it, and write the audio to a file.
+
+   @param midiPath the MIDI file to render
+   @param outputPath the audio file to write
+   @returns the outcome
+   */
+  Result renderFile(const std::string& midiPath, const std::string& outputPath);
+
+  /**
+   Render MIDI files in parallel. Each thread has its own renderer, and each renderer takes the next file to render
+   until all are done.
+
+   @param soundFont the sound font to share among the renderers
+   @param options the settings to use
+   @param jobs the files to render
+   @param threadCount the number of threads to use (0 for one per hardware thread)
+   @returns the outcome of each job, in the same order as `jobs`
+   */
+  static std::vector<Result> renderFiles(std::shared_ptr<const SoundFont> soundFont, const Options& options,
+                                         const std::vector<Job>& jobs, size_t threadCount);
+
+  /// @returns the synthesizer that does the rendering
+  const Synthesizer& synthesizer() const noexcept { return *synthesizer_; }
+
+private:
+  void prepare();
+
+  std::shared_ptr<const SoundFont> soundFont_;
+  Options options_;
+  std::unique_ptr<Synthesizer> synthesizer_;
+  std::vector<AUValue> left_;
+  std::vector<AUValue> right_;
+  std::vector<AUValue*> dry_;
+  std::vector<AUValue*> none_{};
+  std::vector<RenderEvent> blockEvents_{};
+};
+
+} // end namespace SF2::Render::Engine
@@ -1,8 +1,9 @@
 // Copyright © 2022 Brad Howes. All rights reserved.
 
 #pragma once
-#include <os/log.h>
 
+#include <cassert>
+#include <iterator>
 #include <list>
 #include <memory_resource>
 #include <vector>
@@ -31,7 +32,7 @@ public:
    @param voiceCount the number of voices to hold in the collection. Must be <= `MaxVoiceCount`.
    */
   OldestVoiceCollection(size_t voiceCount) noexcept
-  : slots_(voiceCount, leastRecentlyUsed_.end()), log_{os_log_create("SF2Lib", "OldestActiveVoiceCache")}
+  : slots_(voiceCount, leastRecentlyUsed_.end())
   {
     for (size_t voiceIndex = 0; voiceIndex < voiceCount; ++voiceIndex) {
       slots_[voiceIndex] = leastRecentlyUsed_.emplace(leastRecentlyUsed_.begin(), voiceIndex);
@@ -86,6 +87,12 @@ public:
   /// @returns the number of active voices
   size_t active() const noexcept { return active_; }
 
+  /// @returns the index of the oldest active voice. Only valid when there is an active voice.
+  size_t oldest() const noexcept {
+    assert(active_ > 0);
+    return *std::prev(end());
+  }
+
   /// @returns iterator to first active voice
   iterator begin() noexcept { return leastRecentlyUsed_.begin(); }
 
@@ -99,8 +106,9 @@ public:
   const_iterator end() const noexcept { return partition_; }
 
 private:
-  // TODO: calculate proper size -- testing found this sufficient for a MaxVoiceCount of 96.
-  static constexpr size_t BufferSize = 1024 * 4 + 168;
+  // Testing found 4264 bytes sufficient for a MaxVoiceCount of 96 with libc++, but the libstdc++ pool resource keeps
+  // more bookkeeping and needs about 23K for 128 voices. Nothing is allocated after construction, so be generous.
+  static constexpr size_t BufferSize = 4096 + MaxVoiceCount * 256;
 
   std::array<std::byte, BufferSize> buffer_;
   std::pmr::monotonic_buffer_resource mbr_{buffer_.data(), buffer_.size(), std::pmr::null_memory_resource()};
@@ -111,7 +119,6 @@ private:
   std::pmr::vector<iterator> slots_{allocator_};
   size_t active_;
   iterator partition_;
-  os_log_t log_;
 };
 
 } // end namespace SF2::Render::Engine
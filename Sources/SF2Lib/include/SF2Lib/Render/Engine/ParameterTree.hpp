@@ -0,0 +1,66 @@
+// Copyright © 2023 Brad Howes. All rights reserved.
+
+#pragma once
+
+#if defined(__APPLE__)
+
+#include <CoreAudioKit/CoreAudioKit.h>
+
+#include "SF2Lib/Render/Engine/Parameters.hpp"
+
+namespace SF2::Render::Engine {
+
+class Synthesizer;
+
+/**
+ Collection of AUParameter definitions which are used to generate an AUParameterTree for controlling SF2 generators
+ and engine settings while rendering. This is only available on Apple platforms.
+ */
+class ParameterTree
+{
+public:
+  using Index = Parameters::Index;
+  using EngineParameterAddress = Parameters::EngineParameterAddress;
+
+  /**
+   Construct new instance for the given engine
+
+   @param engine the engine to operate on
+   */
+  ParameterTree(Synthesizer& engine);
+
+  /// @returns the AUParameterTree defined for the engine
+  AUParameterTree* parameterTree() const noexcept { return parameterTree_; }
+
+private:
+
+  /**
+   Notification that the given AUParameter has a new value.
+
+   @param parameter the parameter that changed
+   @param value the new value
+   */
+  void valueChanged(AUParameter* parameter, AUValue value) noexcept;
+
+  /**
+   Obtain the current value of a generator.
+
+   @param parameter the AUParameter to query
+   @returns the current value
+   */
+  AUValue provideValue(AUParameter* parameter) noexcept;
+
+  static AUParameter* makeGeneratorParameter(Index index) noexcept;
+
+  static AUParameter* makeBooleanParameter(NSString* name, EngineParameterAddress, bool value) noexcept;
+
+  AUParameterTree* makeTree() noexcept;
+
+  Synthesizer& engine_;
+  AUParameterTree* parameterTree_{nullptr};
+  os_log_t log_;
+};
+
+} // end namespace SF2::Render::Engine
+
+#endif
@@ -2,18 +2,23 @@
 
 #pragma once
 
-#include <CoreAudioKit/CoreAudioKit.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
 
 #include "SF2Lib/Entity/Generator/Index.hpp"
 #include "SF2Lib/Render/Voice/State/State.hpp"
+#include "SF2Lib/Types.hpp"
 
 namespace SF2::Render::Engine {
 
-class Engine;
-
 /**
- Collection of AUParameter definitions which are used to generate an AUParameterTree for controlling SF2 generates
- while rendering.
+ Collection of live generator values that override those of the active preset while rendering, along with the
+ addresses of the parameters that control the engine. On Apple platforms, `ParameterTree` publishes these as an
+ AUParameterTree.
+
+ Changes gather in a pending list of generator indices until the engine applies them to the active voices, once per
+ render slice. A separate list holds every generator with a live value so that new voices only visit those.
  */
 class Parameters
 {
@@ -33,6 +38,12 @@ public:
     polyphonicModeEnabled,
     activeVoiceCount,
     retriggerModeEnabled,
+    multiTimbralModeEnabled,
+    stealingPolicy,
+    voiceCullThreshold,
+    governorEnabled,
+    governorLoadLimit,
+    linkedStereoModeEnabled,
     firstUnusedAddress,
 
     lastEngineParameterAddressPlusOne
@@ -42,21 +53,14 @@ public:
   static constexpr size_t engineParameterCount = (valueOf(EngineParameterAddress::lastEngineParameterAddressPlusOne) -
                                                   valueOf(EngineParameterAddress::firstEngineParameterAddress));
 
-  /**
-   Construct new instance for the given Engine
-
-   @param engine the Engine to operate on
-   */
-  Parameters(Engine& engine);
-
   /**
    Clear the state such that there are no differences from the active preset generators.
    */
   void reset() noexcept;
 
   /**
-   Set a parameter value due to an AUParameterTree entry change. Note that this is called from the real-time
-   render thread.
+   Set a parameter value due to a parameter change. Stops any ramp of the generator and adds it to the pending change
+   list. Note that this is called from the real-time render thread.
 
    @param index the index of the generator that is being changed
    @param value the new value for the generator
@@ -64,53 +68,123 @@ public:
   void setLiveValue(Index index, int value) noexcept;
 
   /**
-   Apply any changed values to the given voice state.
+   Move a parameter to a new value over a span of frames. The live value only changes in `advanceRamps`, which the
+   engine calls once per control block, so voices see at most one new value per block. A generator without a live
+   value has no starting point for a ramp, so it takes the new value at once. Note that this is called from the
+   real-time render thread.
 
-   @param state the state to update
+   @param index the index of the generator that is being changed
+   @param value the value for the generator at the end of the ramp
+   @param frameCount the number of frames to take to reach the value
+   @returns true if a ramp started, false if the value was set at once
    */
-  void applyChanged(State& state) noexcept;
+  bool startRamp(Index index, int value, AUAudioFrameCount frameCount) noexcept;
+
+  /// @returns true if one or more generators are ramping
+  bool isRamping() const noexcept { return rampCount_ > 0; }
 
   /**
-   Apply one changed value to the given voice state.
+   Advance all ramps by a span of frames. Generators whose live value changes join the pending change list.
+
+   @param frameCount the number of frames to advance by
+   */
+  void advanceRamps(AUAudioFrameCount frameCount) noexcept
+  {
+    for (size_t pos = 0; pos < rampCount_; ) {
+      auto index = ramping_[pos];
+      auto& ramp{ramps_[index]};
+      auto frames = std::min(frameCount, ramp.remaining);
+      ramp.remaining -= frames;
+      ramp.value += ramp.step * Float(frames);
+      auto value = ramp.remaining == 0 ? ramp.target : int(std::round(ramp.value));
+      if (value != values_[index]) {
+        values_[index] = value;
+        markPending(index);
+      }
+      if (ramp.remaining == 0) {
+        ramping_[pos] = ramping_[--rampCount_];
+      } else {
+        ++pos;
+      }
+    }
+  }
+
+  /// @returns the number of generators changed since the last `clearPending`
+  size_t pendingCount() const noexcept { return pendingCount_; }
+
+  /**
+   Apply the generators changed since the last `clearPending` to the given voice state. The engine calls this once
+   per active voice and then clears the list, so a render slice visits each voice once no matter how many changes
+   arrived in it.
 
    @param state the state to update
-   @param index the generator to update
    */
-  void applyOne(State& state, Index index) noexcept;
+  void applyPending(State& state) const noexcept
+  {
+    for (size_t pos = 0; pos < pendingCount_; ++pos) applyOne(state, pending_[pos]);
+  }
+
+  /**
+   Forget the generators changed since the last call.
+   */
+  void clearPending() noexcept
+  {
+    for (size_t pos = 0; pos < pendingCount_; ++pos) isPending_[pending_[pos]] = false;
+    pendingCount_ = 0;
+  }
 
-  /// @returns the AUParameterTree defined for the engine
-  AUParameterTree* parameterTree() const noexcept { return parameterTree_; }
+  /**
+   Apply all generators with a live value to the given voice state. Only visits the generators that have been set.
 
-private:
+   @param state the state to update
+   */
+  void applyChanged(State& state) const noexcept;
 
   /**
-   Notification that the given AUParameter has a new value.
+   Apply one changed value to the given voice state.
 
-   @param parameter the parameter that changed
-   @param value the new value
+   @param state the state to update
+   @param index the generator to update
    */
-  void valueChanged(AUParameter* parameter, AUValue value) noexcept;
+  void applyOne(State& state, Index index) const noexcept;
 
   /**
-   Obtain the current value of a generator.
+   Obtain the last value set for a generator.
 
-   @param parameter the AUParameter to query
-   @returns the current value
+   @param index the generator to query
+   @returns the live value
    */
-  AUValue provideValue(AUParameter* parameter) noexcept;
+  int liveValue(Index index) const noexcept { return values_[index]; }
 
-  static AUParameter* makeGeneratorParameter(Index index) noexcept;
+private:
+
+  /// The progress of one generator toward a new value.
+  struct Ramp {
+    Float value{0_F};
+    Float step{0_F};
+    int target{0};
+    AUAudioFrameCount remaining{0};
+  };
 
-  static AUParameter* makeBooleanParameter(NSString* name, EngineParameterAddress, bool value) noexcept;
+  void stopRamp(Index index) noexcept;
 
-  AUParameterTree* makeTree() noexcept;
+  void markPending(Index index) noexcept
+  {
+    if (isPending_[index]) return;
+    isPending_[index] = true;
+    pending_[pendingCount_++] = index;
+  }
 
-  Engine& engine_;
-  AUParameterTree* parameterTree_{nullptr};
   Entity::Generator::GeneratorValueArray<int> values_{};
   Entity::Generator::GeneratorValueArray<bool> changed_{};
-  os_log_t log_;
-  bool anyChanged_;
+  Entity::Generator::GeneratorValueArray<Ramp> ramps_{};
+  std::array<Index, size_t(Index::numValues)> changedList_{};
+  size_t changedCount_{0};
+  Entity::Generator::GeneratorValueArray<bool> isPending_{};
+  std::array<Index, size_t(Index::numValues)> pending_{};
+  size_t pendingCount_{0};
+  std::array<Index, size_t(Index::numValues)> ramping_{};
+  size_t rampCount_{0};
 };
 
 }
@@ -0,0 +1,120 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include "SF2Lib/Types.hpp"
+
+namespace SF2::Render::Engine {
+
+/**
+ A timestamped event for `Synthesizer::render`. This is the native counterpart of an `AURenderEvent`: hosts that are
+ not AUv3 hosts place their events in a contiguous, sorted array instead of building a linked list. An event is either
+ a MIDI message or a parameter change, and it holds its data by value so that walking the array never leaves it. The
+ exception is a MIDI message longer than 3 bytes (SysEx), which refers to bytes owned by the caller. They must stay
+ valid until the render call returns.
+ */
+class RenderEvent
+{
+public:
+
+  enum class Type : uint8_t {
+    midi,
+    parameter,
+    parameterRamp
+  };
+
+  /**
+   Create a MIDI event.
+
+   @param frame the offset of the event from the first frame of the render call
+   @param bytes the MIDI message. Messages of at most 3 bytes are copied, longer ones are referenced.
+   @returns new event
+   */
+  static RenderEvent midi(AUAudioFrameCount frame, std::span<const uint8_t> bytes) noexcept
+  {
+    RenderEvent event{frame, Type::midi};
+    event.size_ = uint32_t(bytes.size());
+    if (bytes.size() <= event.bytes_.size()) {
+      std::memcpy(event.bytes_.data(), bytes.data(), bytes.size());
+    } else {
+      event.external_ = bytes.data();
+    }
+    return event;
+  }
+
+  /**
+   Create an event that changes a parameter. The address is the same as that given to `Synthesizer::setParameter`.
+
+   @param frame the offset of the event from the first frame of the render call
+   @param address the parameter to change
+   @param value the new value of the parameter
+   @returns new event
+   */
+  static RenderEvent parameter(AUAudioFrameCount frame, AUParameterAddress address, AUValue value) noexcept
+  {
+    RenderEvent event{frame, Type::parameter};
+    event.address_ = address;
+    event.value_ = value;
+    return event;
+  }
+
+  /**
+   Create an event that moves a parameter to a new value over a span of frames.
+
+   @param frame the offset of the event from the first frame of the render call
+   @param address the parameter to change
+   @param value the value of the parameter at the end of the ramp
+   @param duration the number of frames to take to get to the new value
+   @returns new event
+   */
+  static RenderEvent parameterRamp(AUAudioFrameCount frame, AUParameterAddress address, AUValue value,
+                                   AUAudioFrameCount duration) noexcept
+  {
+    RenderEvent event{frame, Type::parameterRamp};
+    event.address_ = address;
+    event.value_ = value;
+    event.rampDuration_ = duration;
+    return event;
+  }
+
+  /// @returns the offset of the event from the first frame of the render call
+  AUAudioFrameCount frame() const noexcept { return frame_; }
+
+  /// @returns the kind of event
+  Type type() const noexcept { return type_; }
+
+  /// @returns the bytes of a MIDI event
+  std::span<const uint8_t> midiBytes() const noexcept {
+    assert(type_ == Type::midi);
+    return {external_ != nullptr ? external_ : bytes_.data(), size_};
+  }
+
+  /// @returns the parameter changed by a parameter event
+  AUParameterAddress address() const noexcept { return address_; }
+
+  /// @returns the new value of a parameter event
+  AUValue value() const noexcept { return value_; }
+
+  /// @returns the number of frames of a ramp event (0 for other events)
+  AUAudioFrameCount rampDuration() const noexcept { return rampDuration_; }
+
+private:
+  RenderEvent(AUAudioFrameCount frame, Type type) noexcept : frame_{frame}, type_{type} {}
+
+  AUAudioFrameCount frame_;
+  Type type_;
+  std::array<uint8_t, 3> bytes_{};
+  uint32_t size_{0};
+  AUValue value_{0.0f};
+  const uint8_t* external_{nullptr};
+  AUParameterAddress address_{0};
+  AUAudioFrameCount rampDuration_{0};
+};
+
+} // end namespace SF2::Render::Engine
@@ -0,0 +1,206 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "SF2Lib/Render/Voice/StageClock.hpp"
+
+namespace SF2::Render::Engine {
+
+/**
+ Accumulates the render cost of voices by pipeline stage, by preset, and by zone. The render thread folds the
+ measurements of each voice's `Voice::StageClock` into fixed-size tables, so recording does not allocate or lock. Any
+ thread may then take a `snapshot` of the totals.
+
+ Presets are identified by their index in the loaded file and zones by their instrument zone. Each table holds a fixed
+ number of entries. Once a table is full, the cost of new presets or zones is only counted in `overflowTicks`.
+
+ Only used when built with SF2_VOICE_PROFILING=1.
+ */
+template <size_t MaxVoiceCount>
+class RenderProfile
+{
+public:
+  /// Maximum number of presets tracked
+  static inline constexpr size_t presetCapacity = 512;
+  /// Maximum number of zones tracked
+  static inline constexpr size_t zoneCapacity = 2048;
+
+  /// Render cost of a preset or zone
+  struct Cost {
+    /// The index of the preset in the loaded file
+    size_t presetIndex;
+    /// The name of the preset (filled in by the engine)
+    std::string presetName;
+    /// The name of the sample used by the zone (empty for presets)
+    std::string sampleName;
+    /// The lowest key of the zone (0 for presets)
+    int keyLow;
+    /// The highest key of the zone (127 for presets)
+    int keyHigh;
+    /// Number of voices started
+    uint64_t voiceCount;
+    /// Number of samples rendered
+    uint64_t sampleCount;
+    /// Total render time in `Utils::cycleCount` ticks
+    uint64_t ticks;
+  };
+
+  /// Render costs at one point in time. Presets and zones are ordered from most to least expensive.
+  struct Snapshot {
+    /// Total render time of each stage
+    Voice::StageClock::Ticks stageTicks;
+    /// Total number of samples rendered
+    uint64_t sampleCount;
+    /// Render time that could not be attributed to a preset or zone because a table was full
+    uint64_t overflowTicks;
+    std::vector<Cost> presets;
+    std::vector<Cost> zones;
+  };
+
+  RenderProfile() noexcept = default;
+  RenderProfile(const RenderProfile&) = delete;
+  RenderProfile& operator=(const RenderProfile&) = delete;
+
+  /**
+   Associate a voice with the preset and zone it is about to render. Only call from the render thread.
+
+   @param voiceIndex the index of the voice
+   @param presetIndex the index of the preset in the loaded file
+   @param zone unique identifier of the zone being rendered
+   @param keyLow the lowest key of the zone
+   @param keyHigh the highest key of the zone
+   @param sampleName the name of the sample rendered by the zone
+   */
+  void assign(size_t voiceIndex, size_t presetIndex, const void* zone, int keyLow, int keyHigh,
+              const char* sampleName) noexcept {
+    auto& owner{owners_[voiceIndex]};
+    owner.preset = find(presets_, presetIndex + 1, presetIndex, 0, 127, "");
+    owner.zone = find(zones_, reinterpret_cast<uintptr_t>(zone), presetIndex, keyLow, keyHigh, sampleName);
+    if (owner.preset) owner.preset->voiceCount.fetch_add(1, std::memory_order_relaxed);
+    if (owner.zone) owner.zone->voiceCount.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /**
+   Add the measurements of a voice to the totals and clear them from the voice. Only call from the render thread.
+
+   @param voiceIndex the index of the voice
+   @param clock the measurements of the voice
+   */
+  void record(size_t voiceIndex, Voice::StageClock& clock) noexcept {
+    uint64_t total = 0;
+    for (size_t stage = 0; stage < Voice::stageCount; ++stage) {
+      auto ticks = clock.ticks()[stage];
+      stageTicks_[stage].fetch_add(ticks, std::memory_order_relaxed);
+      total += ticks;
+    }
+    sampleCount_.fetch_add(clock.samples(), std::memory_order_relaxed);
+
+    const auto& owner{owners_[voiceIndex]};
+    for (auto entry : {owner.preset, owner.zone}) {
+      if (entry) {
+        entry->ticks.fetch_add(total, std::memory_order_relaxed);
+        entry->sampleCount.fetch_add(clock.samples(), std::memory_order_relaxed);
+      }
+    }
+    if (!owner.preset || !owner.zone) overflowTicks_.fetch_add(total, std::memory_order_relaxed);
+    clock.clear();
+  }
+
+  /// Forget all measurements. Call when no voices are rendering, such as when a new file is loaded.
+  void reset() noexcept {
+    for (auto& ticks : stageTicks_) ticks.store(0, std::memory_order_relaxed);
+    sampleCount_.store(0, std::memory_order_relaxed);
+    overflowTicks_.store(0, std::memory_order_relaxed);
+    for (auto& entry : presets_) entry.key.store(0, std::memory_order_relaxed);
+    for (auto& entry : zones_) entry.key.store(0, std::memory_order_relaxed);
+    owners_.fill(Owner{});
+  }
+
+  /// @returns the current totals. Allocates memory, so do not call from the render thread.
+  Snapshot snapshot() const noexcept {
+    Snapshot snapshot{{}, sampleCount_.load(std::memory_order_relaxed), overflowTicks_.load(std::memory_order_relaxed),
+      {}, {}};
+    for (size_t stage = 0; stage < Voice::stageCount; ++stage) {
+      snapshot.stageTicks[stage] = stageTicks_[stage].load(std::memory_order_relaxed);
+    }
+    collect(presets_, snapshot.presets);
+    collect(zones_, snapshot.zones);
+    return snapshot;
+  }
+
+private:
+
+  struct Entry {
+    std::atomic<uintptr_t> key{0};
+    size_t presetIndex{0};
+    int keyLow{0};
+    int keyHigh{0};
+    std::array<char, 21> sampleName{};
+    std::atomic<uint64_t> voiceCount{0};
+    std::atomic<uint64_t> sampleCount{0};
+    std::atomic<uint64_t> ticks{0};
+  };
+
+  struct Owner {
+    Entry* preset{nullptr};
+    Entry* zone{nullptr};
+  };
+
+  /**
+   Locate the entry for a key, adding a new one if not found. Uses open addressing with linear probing.
+
+   @returns pointer to the entry or nullptr if the table is full
+   */
+  template <size_t Capacity>
+  static Entry* find(std::array<Entry, Capacity>& table, uintptr_t key, size_t presetIndex, int keyLow, int keyHigh,
+                     const char* sampleName) noexcept {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+    auto slot = (key * 0x9E3779B97F4A7C15ull) >> 32;
+    for (size_t probe = 0; probe < Capacity; ++probe) {
+      auto& entry{table[(slot + probe) & (Capacity - 1)]};
+      auto found = entry.key.load(std::memory_order_relaxed);
+      if (found == key) return &entry;
+      if (found == 0) {
+        // Fill in the entry and then publish it by setting the key.
+        entry.presetIndex = presetIndex;
+        entry.keyLow = keyLow;
+        entry.keyHigh = keyHigh;
+        std::strncpy(entry.sampleName.data(), sampleName, entry.sampleName.size() - 1);
+        entry.voiceCount.store(0, std::memory_order_relaxed);
+        entry.sampleCount.store(0, std::memory_order_relaxed);
+        entry.ticks.store(0, std::memory_order_relaxed);
+        entry.key.store(key, std::memory_order_release);
+        return &entry;
+      }
+    }
+    return nullptr;
+  }
+
+  template <size_t Capacity>
+  static void collect(const std::array<Entry, Capacity>& table, std::vector<Cost>& costs) noexcept {
+    for (const auto& entry : table) {
+      if (entry.key.load(std::memory_order_acquire) == 0) continue;
+      costs.push_back(Cost{entry.presetIndex, "", std::string(entry.sampleName.data()), entry.keyLow, entry.keyHigh,
+        entry.voiceCount.load(std::memory_order_relaxed), entry.sampleCount.load(std::memory_order_relaxed),
+        entry.ticks.load(std::memory_order_relaxed)});
+    }
+    std::sort(costs.begin(), costs.end(), [](const Cost& lhs, const Cost& rhs) { return lhs.ticks > rhs.ticks; });
+  }
+
+  std::array<std::atomic<uint64_t>, Voice::stageCount> stageTicks_{};
+  std::atomic<uint64_t> sampleCount_{0};
+  std::atomic<uint64_t> overflowTicks_{0};
+  std::array<Entry, presetCapacity> presets_{};
+  std::array<Entry, zoneCapacity> zones_{};
+  std::array<Owner, MaxVoiceCount> owners_{};
+};
+
+} // end namespace SF2::Render::Engine
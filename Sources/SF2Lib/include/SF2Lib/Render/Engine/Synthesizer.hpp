@@ -0,0 +1,974 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <queue>
+#include <set>
+#include <span>
+#include <vector>
+
+#include "SF2Lib/IO/File.hpp"
+#include "SF2Lib/MIDI/ChannelState.hpp"
+#include "SF2Lib/Render/Engine/CommandQueue.hpp"
+#include "SF2Lib/Render/Engine/Governor.hpp"
+#include "SF2Lib/Render/Engine/Mixer.hpp"
+#include "SF2Lib/Render/Engine/OldestVoiceCollection.hpp"
+#include "SF2Lib/Render/Engine/Parameters.hpp"
+#include "SF2Lib/Render/Engine/RenderEvent.hpp"
+#include "SF2Lib/Render/Engine/RenderProfile.hpp"
+#include "SF2Lib/Render/Engine/Telemetry.hpp"
+#include "SF2Lib/Render/Engine/VoiceLists.hpp"
+#include "SF2Lib/Render/FilterBank.hpp"
+#include "SF2Lib/Render/PresetCollection.hpp"
+#include "SF2Lib/Render/SoundFont.hpp"
+#include "SF2Lib/Render/Voice/Voice.hpp"
+#include "SF2Lib/Trace/Trace.hpp"
+#include "SF2Lib/Utils/DenormalGuard.hpp"
+
+struct TestEngineHarness;
+
+namespace SF2::Render::Engine {
+
+/**
+ Platform-neutral core of the engine that generates audio from SF2 files due to incoming MIDI signals. Maintains a
+ collection of voices created at construction time. A Voice generates samples based on the configuration it is given
+ from a Preset. Nothing here depends on Apple frameworks: MIDI messages arrive as raw bytes, parameter changes as
+ address/value pairs, and samples are rendered into the plain buffers of a `Mixer`. On Apple platforms, `Engine` adds
+ the AUv3 glue on top of this class.
+
+ Note that a major design goal is to keep from allocating any memory while a render thread is running and generating
+ samples. This also implies that all communications with the engine while rendering (eg MIDI events or real-time
+ parameter changes should be done with care. For the AUv3 use-case, this is handled by the `EventProcessor` base class
+ of `Engine` and the AUv3 API. MIDI events and parameter changes are scheduled using dedicated APIs and the render
+ thread sees them during a render request. Other hosts must call `processMIDIEvent` and `setParameter` from the thread
+ that calls `renderInto`, or post a `Command` from one control thread. Posted commands are applied at the start of the
+ next render, at most `maxCommandsPerRender` at a time.
+ */
+class Synthesizer {
+public:
+  /// Maximum number of voices that can be supported by the engine
+  static inline constexpr size_t maxVoiceCount = 128;
+
+  /// Number of voices whose low-pass filters are run at the same time.
+  static inline constexpr size_t filterBankLaneCount = 4;
+
+  /// Maximum number of posted commands applied at the start of a render
+  static inline constexpr size_t maxCommandsPerRender = 16;
+
+  /// Number of MIDI channels supported when in multi-timbral mode
+  static inline constexpr size_t channelCount = 16;
+
+  /// The MIDI channel used for percussion by General MIDI (channel 10 when counting from 1)
+  static inline constexpr size_t percussionChannel = 9;
+
+  /// The bank that holds percussion presets in a General MIDI sound font
+  static inline constexpr uint16_t percussionBank = 128;
+
+  using Config = Voice::State::Config;
+  using Voice = Voice::Voice;
+  using Interpolator = Render::Voice::Sample::Interpolator;
+
+  /**
+   How to pick an active voice to reuse when a new note needs a voice and the polyphony budget is exhausted.
+
+   - oldest -- immediately stop and reuse the voice that was started first
+   - audibility -- fade out the voice that is least audible: voices in release are preferred, then voices in the same
+     exclusive class as the new note, and then the voice with the lowest current envelope and attenuation level. A
+     small set of voices is held in reserve so that stolen voices can fade out without delaying the new note.
+   */
+  enum class StealingPolicy
+  {
+    oldest = 0,
+    audibility = 1
+  };
+
+  /// Duration of the fade-out applied to a voice stolen under the `audibility` policy.
+  static inline constexpr Float stolenVoiceFadeOutMilliseconds = 2_F;
+
+  /**
+   Construct new engine and its voices.
+
+   @param sampleRate the expected sample rate to use
+   @param voiceCount the maximum number of individual voices to support (must be <= maxVoiceCount)
+   @param interpolator the type of interpolation to use when rendering samples
+   @param minimumNoteDurationMilliseconds the minimum duration of a note-on/note-off sequence for a voice.
+   */
+  Synthesizer(Float sampleRate, size_t voiceCount, Interpolator interpolator,
+              size_t minimumNoteDurationMilliseconds = 10) noexcept;
+
+  size_t minimumNoteDurationSamples() const noexcept
+  {
+    return static_cast<size_t>(ceil(minimumNoteDurationMilliseconds_ / 1000_F * sampleRate_));
+  }
+
+  /// @returns maximum number of voices available for simultaneous rendering
+  size_t voiceCount() const noexcept { return voices_.size(); }
+
+  /**
+   Change the sample rate used for rendering. Stops all voices.
+
+   @param sampleRate the new sample rate to use
+   */
+  void setSampleRate(Float sampleRate) noexcept;
+
+  /// @returns the current sample rate
+  Float sampleRate() const noexcept { return sampleRate_; }
+
+  /// @returns the MIDI channel state assigned to the first MIDI channel (the only one when not multi-timbral)
+  MIDI::ChannelState& channelState() noexcept { return channelStates_[0]; }
+
+  /// @returns the MIDI channel state assigned to the first MIDI channel (the only one when not multi-timbral)
+  const MIDI::ChannelState& channelState() const noexcept { return channelStates_[0]; }
+
+  /**
+   Obtain the MIDI channel state for a given channel.
+
+   @param channel the MIDI channel to fetch (0-15)
+   @returns the MIDI channel state
+   */
+  const MIDI::ChannelState& channelState(size_t channel) const noexcept { return channelStates_[channel]; }
+
+  /// @returns true if there is an active preset for the first MIDI channel
+  bool hasActivePreset() const noexcept { return hasActivePreset(0); }
+
+  /**
+   @param channel the MIDI channel to check (0-15)
+   @returns true if there is an active preset for the given MIDI channel
+   */
+  bool hasActivePreset(size_t channel) const noexcept;
+
+  /// @returns name of the active preset of the first MIDI channel or empty string if none is active
+  std::string activePresetName() const noexcept { return activePresetName(0); }
+
+  /**
+   @param channel the MIDI channel to check (0-15)
+   @returns name of the active preset of the given MIDI channel or empty string if none is active
+   */
+  std::string activePresetName(size_t channel) const noexcept;
+
+  /// @returns the sound font in use or nullptr if none is loaded
+  const std::shared_ptr<const SoundFont>& soundFont() const noexcept { return soundFont_; }
+
+  /**
+   Use an already loaded sound font and activate one of its presets. Several engines may share the same sound font,
+   which saves loading and converting the samples for each one.
+
+   NOTE: this is not thread-safe. Call it before rendering starts or from the thread that renders. Use `postSoundFont`
+   to change the sound font from another thread while rendering.
+
+   @param soundFont the sound font to use
+   @param index the preset to make active
+   */
+  void useSoundFont(std::shared_ptr<const SoundFont> soundFont, size_t index) noexcept;
+
+  /**
+   Post a command for the render thread. Only call from one control thread. The command is applied at the start of a
+   later render.
+
+   @param command the command to post
+   @returns true if posted, false if the queue was full
+   */
+  bool post(const Command& command) noexcept { return commands_.post(command); }
+
+  /**
+   Post a command to use a sound font and one of its presets. Only call from the same control thread as `post`. The
+   control thread keeps the sound font alive until the render thread has switched to a later one, so the render thread
+   never frees one.
+
+   @param soundFont the sound font to use
+   @param index the preset to make active
+   @returns true if posted, false if the queue was full
+   */
+  bool postSoundFont(std::shared_ptr<const SoundFont> soundFont, size_t index) {
+    return commands_.postSoundFont(std::move(soundFont), index);
+  }
+
+  /// @returns the queue of posted commands
+  const CommandQueue& commands() const noexcept { return commands_; }
+
+  /// @returns the most voices that may play at the same time, before any limit set by the governor
+  size_t voiceLimit() const noexcept { return voiceLimit_; }
+
+  /**
+   Limit the number of voices that may play at the same time. Voices that are playing when the limit is lowered are not
+   stopped, but from then on a new note steals a voice instead of adding one.
+
+   @param voiceCount the limit to use, clamped to [1, voiceCount()]
+   */
+  void setVoiceLimit(size_t voiceCount) noexcept { voiceLimit_ = std::clamp<size_t>(voiceCount, 1, voices_.size()); }
+
+  /// @returns true if the engine responds to all 16 MIDI channels, each with its own state and preset.
+  bool multiTimbralModeEnabled() const noexcept { return multiTimbralModeEnabled_; }
+
+  /// @returns true if the two halves of a stereo sample pair are rendered by one voice.
+  bool linkedStereoModeEnabled() const noexcept { return linkedStereoModeEnabled_; }
+
+  /// @returns number of presets available.
+  size_t presetCount() const noexcept { return presets_->size(); }
+
+  /// @return the number of active voices
+  size_t activeVoiceCount() const noexcept { return oldestVoiceIndices_.active(); }
+
+  /// @returns the policy used to pick a voice to steal
+  StealingPolicy stealingPolicy() const noexcept { return stealingPolicy_; }
+
+  /// @returns number of voices that have been stolen to make room for new notes
+  size_t stolenVoiceCount() const noexcept { return size_t(telemetry_.stolenVoiceCount()); }
+
+  /// @returns the runtime statistics of the engine. Safe to read from any thread.
+  const Telemetry& telemetry() const noexcept { return telemetry_; }
+
+  /// Clear the runtime statistics of the engine.
+  void resetTelemetry() noexcept { telemetry_.reset(); }
+
+#if SF2_VOICE_PROFILING == 1
+  /**
+   Obtain the render cost of voices by pipeline stage, preset, and zone. Allocates memory so do not call from the render
+   thread.
+
+   @returns the render costs since the last reset or file load
+   */
+  RenderProfile<maxVoiceCount>::Snapshot renderProfile() const noexcept;
+
+  /// Clear the render costs.
+  void resetRenderProfile() noexcept { renderProfile_.reset(); }
+#endif
+
+  /// @returns the threshold in decibels below which a releasing voice is stopped
+  Float voiceCullThreshold() const noexcept { return voiceCullThresholdDecibels_; }
+
+  /**
+   Set the threshold used to stop voices that are in their release stage. A voice stops once the peak of its sample
+   multiplied by its current gain and pan falls below this level. Any value at or below `minimumVoiceCullThreshold`
+   disables the check.
+
+   @param decibels the threshold to use
+   */
+  void setVoiceCullThreshold(Float decibels) noexcept;
+
+  /// Threshold value that disables the culling of inaudible voices.
+  static inline constexpr Float minimumVoiceCullThreshold = -160_F;
+
+  /// @returns the CPU governor that trades rendering quality for render time
+  const Governor& governor() const noexcept { return governor_; }
+
+  /**
+   Enable or disable the CPU governor. When enabled, the engine measures how long each render takes and lowers the
+   rendering quality when it gets too close to the real-time deadline.
+
+   @param value true to enable
+   */
+  void setGovernorEnabled(bool value) noexcept;
+
+  /**
+   Set the fraction of the real-time duration of a render that the engine may use before the governor lowers the
+   rendering quality.
+
+   @param value the limit to use
+   */
+  void setGovernorLoadLimit(Float value) noexcept { governor_.setLoadLimit(value); }
+
+  /**
+   Set the policy to use when picking a voice to steal.
+
+   @param policy the policy to use
+   */
+  void setStealingPolicy(StealingPolicy policy) noexcept { stealingPolicy_ = policy; }
+
+  /**
+   Render samples to the given stereo output buffers. The buffers are guaranteed to be able to hold `frameCount`
+   samples.
+
+   When the engine is idle (see `isIdle`) nothing is rendered and the buffers of all busses, including the effect
+   sends, are left as they are. Since voices add to the buffers, they must be cleared beforehand, so they then hold
+   silence.
+
+   NOTE: everything from this point on should be inlined as much as possible for speed. This is executed in a real-time
+   rendering thread.
+
+   @param mixer collection of buffers to render into
+   @param frameCount number of samples to render.
+   @returns true if nothing was rendered into the buffers
+   */
+  bool renderInto(Mixer mixer, AUAudioFrameCount frameCount) noexcept
+  {
+    if (!commands_.empty()) [[unlikely]] applyCommands();
+    if (parameters_.pendingCount() > 0) [[unlikely]] applyPendingParameters();
+    if (isIdle()) return renderIdle(frameCount);
+    if (auto limit = governor_.voiceLimit(voiceLimit_); oldestVoiceIndices_.active() > limit) [[unlikely]] {
+      shedExcessVoices(limit);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto activeVoiceCount = oldestVoiceIndices_.active();
+    {
+      Utils::DenormalGuard denormalGuard;
+      Trace::Interval interval{Trace::Id::render, int32_t(frameCount), int32_t(activeVoiceCount)};
+      if (parameters_.isRamping()) [[unlikely]] {
+        renderRampingInto(mixer, frameCount);
+      } else {
+        renderVoicesInto(mixer, frameCount);
+      }
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    auto deadline = frameCount / sampleRate_;
+    telemetry_.recordBlock(elapsed.count(), deadline, activeVoiceCount, midiEventCount_);
+    midiEventCount_ = 0;
+    if (governor_.update(elapsed.count(), deadline)) applyCullThreshold();
+    return false;
+  }
+
+  /// @returns true if there is nothing to render: no voices are active and no generators are ramping
+  bool isIdle() const noexcept { return oldestVoiceIndices_.empty() && !parameters_.isRamping(); }
+
+  /**
+   Process a MIDI message. The bytes hold one complete message: a channel message, a system reset, or a SysEx message
+   that starts with 0xF0 and ends with 0xF7.
+
+   @param bytes the MIDI message to process
+   */
+  void processMIDIEvent(std::span<const uint8_t> bytes) noexcept;
+
+  /**
+   Change a generator or engine setting. Generator changes are given by the generator index, and engine settings by
+   the values of `Parameters::EngineParameterAddress`. Unknown addresses are ignored. A generator with a ramp duration
+   moves to the new value over that many frames, taking a new value at the start of each `Mixer::blockSize` block of
+   a render. Engine settings always change at once.
+
+   @param address the parameter to change
+   @param value the new value of the parameter
+   @param rampDuration the number of frames to take to reach the new value
+   */
+  void setParameter(AUParameterAddress address, AUValue value, AUAudioFrameCount rampDuration = 0) noexcept;
+
+  /**
+   Render samples while applying timestamped events. This is the entry point for hosts that are not AUv3 hosts: the
+   events are in one contiguous array, sorted by frame, and the render is split at each event frame just as
+   `EventProcessor` does for an `AURenderEvent` list. Events at or after `frameCount` are applied after the last
+   frame is rendered.
+
+   The buffer pointers of the mixer busses are the same on return as they were on entry.
+
+   @param events the events to apply, sorted by frame
+   @param mixer collection of buffers to render into
+   @param frameCount number of samples to render
+   @returns true if nothing was rendered into the buffers, so that they still hold silence if they were cleared
+   */
+  bool render(std::span<const RenderEvent> events, Mixer mixer, AUAudioFrameCount frameCount) noexcept;
+
+  /// @returns true if portamento mode is enabled
+  bool portamentoModeEnabled() const noexcept { return portamentoModeEnabled_; }
+
+  /// @returns the rate of change from one note to another expressed as milliseconds per semitone change
+  size_t portamentoRate() const noexcept { return portamentoRateMillisecondsPerSemitone_; }
+
+  /// @returns true if only one voice will play at the same time for the same MIDI key
+  bool oneVoicePerKeyModeEnabled() const noexcept { return oneVoicePerKeyModeEnabled_; }
+
+  /// @returns true if a new note ON for the same key will use a new envelopes or will simply inherit the active one.
+  bool retriggerModeEnabled() const noexcept { return retriggerModeEnabled_; }
+
+  /// @returns true if Engine is in monophonic mode
+  bool monophonicModeEnabled() const noexcept { return phonicMode_ == PhonicMode::mono; }
+
+  /// @returns true if Engine is in polyphonic mode (default)
+  bool polyphonicModeEnabled() const noexcept { return phonicMode_ == PhonicMode::poly; }
+
+  /**
+   Utility class method that creates a MIDI SysEx command to load a SF2 file at the given path and to activate
+   the preset at the given index.
+
+   @param path the location of the SF2 file to load
+   @param preset the index of the preset to activate
+   @returns array of MIDI bytes
+   */
+  static std::vector<uint8_t> createLoadFileUsePreset(const std::string& path, size_t preset) noexcept;
+
+  /**
+   Utility class method that creates a MIDI SysEx command to activate the preset at the given index in the
+   currently loaded SF2 file. This is the same as `createLoadSysExec` with a zero-length string.
+
+   @param preset the index of the preset to activate
+   @returns array of MIDI bytes
+   */
+  static std::vector<uint8_t> createUsePreset(size_t preset) noexcept;
+
+  /**
+   Utility class method that creates a MIDI channel command to reset the engine. This stops all voices and resets the
+   MIDI channel state.
+
+   @returns array of MIDI bytes
+   */
+  static std::array<uint8_t, 1> createResetCommand() noexcept;
+
+  /**
+   Utility class method that creates a collection of MIDI commands that will direct the engine to activate the preset
+   at the given bank and program values.
+
+   @param bank the bank to activate (0-16383)
+   @param program the program in the bank to activate (0-127)
+   @returns array of an array of MIDI bytes
+   */
+  static std::array<uint8_t, 9> createUseBankProgram(uint16_t bank, uint8_t program) noexcept;
+
+  /**
+   Utility class method that creates a MIDI command to send the given channel message with the given value
+
+   @param channelMessage the MIDI channel message to send
+   @param value the value to provide in the channel message
+   @returns array of MIDI bytes
+   */
+  static std::array<uint8_t, 3> createChannelMessage(MIDI::ControlChange channelMessage, uint8_t value = 0) noexcept;
+
+  static std::array<uint8_t, 3> createAllNotesOff() noexcept
+  {
+    return createChannelMessage(MIDI::ControlChange::allNotesOff);
+  }
+
+  static std::array<uint8_t, 3> createAllSoundOff() noexcept
+  {
+    return createChannelMessage(MIDI::ControlChange::allSoundOff);
+  }
+
+protected:
+
+  /**
+   Turn off all voices, making them all available for rendering.
+
+   NOTE: this is not thread-safe. When running in a render thread, it is expected that this is only executed due to
+   an incoming MIDI command.
+   */
+  void allOff() noexcept;
+
+private:
+
+  /**
+   Load the presets from an SF2 file and activate one. NOTE: this is not thread-safe. When running in a render thread,
+   one should use the special MIDI system-exclusive command to perform a load. See comment in `doMIDIEvent`.
+
+   @param path the file to load from
+   @param index the preset to make active
+   @returns true if the loading was successful
+   */
+  IO::File::LoadResponse load(const std::string& path, size_t index) noexcept;
+
+  /**
+   Activate the preset at the given index for all MIDI channels. In multi-timbral mode, the percussion channel will use
+   the first preset in the percussion bank if there is one.
+
+   NOTE: this is not thread-safe. When running in a render thread, it is expected that this is only executed due to
+   an incoming MIDI command.
+
+   @param index the preset to use
+   */
+  void usePresetWithIndex(size_t index);
+
+  /**
+   In multi-timbral mode, have the percussion channel use the first preset in the percussion bank if there is one.
+   Does nothing when the channel has no active preset.
+   */
+  void usePercussionPreset() noexcept;
+
+  /**
+   Activate the preset at the given bank/program.
+
+   NOTE: this is not thread-safe. When running in a render thread, it is expected that this is only executed due to
+   an incoming MIDI command.
+
+   @param bank the bank to use
+   @param program the program in the bank to use
+   */
+  void usePresetWithBankProgram(uint16_t bank, uint16_t program) { usePresetWithBankProgram(0, bank, program); }
+
+  /**
+   Activate the preset at the given bank/program for a MIDI channel. In multi-timbral mode, voices that are already
+   playing on the channel are left alone, just as with a General MIDI program change.
+
+   NOTE: this is not thread-safe. When running in a render thread, it is expected that this is only executed due to
+   an incoming MIDI command.
+
+   @param channel the MIDI channel to change
+   @param bank the bank to use
+   @param program the program in the bank to use
+   */
+  void usePresetWithBankProgram(size_t channel, uint16_t bank, uint16_t program);
+
+  /// Reset the engine to a known state. All keys are released, all voices are off, and the MIDI channel state is reset
+  /// to initial state.
+  void reset() noexcept;
+
+  /**
+   Turn off all voices started by the given MIDI channel.
+
+   @param channel the MIDI channel to stop
+   */
+  void allOff(size_t channel) noexcept;
+
+  /**
+   Release all keys -- all MIDI note ON events that have not seen a note OFF event. Unlike, `allOff` this does not
+   stop audio.
+
+   @param channel the MIDI channel whose keys are released
+   */
+  void releaseKeys(size_t channel) noexcept;
+
+
+  /**
+   Tell any voices playing the current MIDI key that the key has been released. The voice will continue to render until
+   it figures out that it is done.
+
+   NOTE: this is not thread-safe. When running in a render thread, it is expected that this is only executed due to
+   an incoming MIDI command.
+
+   @param channel the MIDI channel of the event
+   @param key the MIDI key that was released
+   */
+  void noteOff(size_t channel, int key) noexcept;
+
+  /**
+   Activate one or more voices to play a MIDI key with the given velocity.
+
+   NOTE: this is not thread-safe. When running in a render thread, it is expected that this is only executed due to
+   an incoming MIDI command.
+
+   @param channel the MIDI channel of the event
+   @param key the MIDI key to play
+   @param velocity the MIDI velocity to play at
+   */
+  void noteOn(size_t channel, int key, int velocity) noexcept;
+
+  /**
+   Set the portamento (glissando/glide) mode. Note that this is only applicable in monophonic mode.
+
+   NOTE: only settable via parameter change
+
+   @param value enable portamento mode if true
+   */
+  void setPortamentoModeEnabled(bool value) noexcept { portamentoModeEnabled_ = value; }
+
+  /**
+   Set the rate at which the note transitions from the old pitch to the new pitch. This is expressed as milliseconds
+   per semitone.
+
+   NOTE: only settable via parameter change
+
+   @param value the rate in milliseconds
+   */
+  void setPortamentoRate(size_t value) noexcept { portamentoRateMillisecondsPerSemitone_ = value; }
+
+  /**
+   Set the "one voice per key" mode. When enabled, playing the same MIDI note will stop any active previous note. When
+   disabled, the engine will allow multiple voices to play simultaneously for the same MIDI note.
+
+   NOTE: only settable via parameter change
+
+   @param value enable if true
+   */
+  void setOneVoicePerKeyModeEnabled(bool value) noexcept { oneVoicePerKeyModeEnabled_ = value; }
+
+  /**
+   Controls the retriggering of the volume and modulation envelopes when pressing the same key.
+
+   NOTE: only settable via parameter change
+
+   @param value enable if true
+   */
+  void setRetriggerModeEnabled(bool value) noexcept { retriggerModeEnabled_ = value; }
+
+  /**
+   Set the linked stereo mode. When enabled, a note that plays both halves of a stereo sample pair uses one voice that
+   renders the two sample streams with one set of envelopes, LFOs and sample position. When disabled, each half plays
+   in its own voice. Only affects new notes.
+
+   NOTE: only settable via parameter change
+
+   @param value enable if true
+   */
+  void setLinkedStereoModeEnabled(bool value) noexcept { linkedStereoModeEnabled_ = value; }
+
+  /**
+   Set the multi-timbral mode. When enabled, the engine honors the channel of MIDI channel messages, with each channel
+   having its own state and preset. All channels share the same voice collection. When disabled, the engine treats
+   all messages as coming from the first channel (omni mode). Changing the mode stops all voices.
+
+   NOTE: only settable via parameter change
+
+   @param value enable if true
+   */
+  void setMultiTimbralModeEnabled(bool value) noexcept;
+
+  /// The note playing mode of the engine.
+  enum class PhonicMode
+  {
+    mono = 0,
+    poly = 1
+  };
+
+  /**
+   Set the "phonic" mode of the synthesizer.
+
+   NOTE: only settable via parameter change or MIDI channel message
+
+   @param mode the mode to enter
+   */
+  void setPhonicMode(PhonicMode mode) noexcept { phonicMode_ = mode; }
+
+  /**
+   Obtain the MIDI channel to use for a MIDI channel message.
+
+   @param status the status byte of the MIDI message
+   @returns the channel index to use (always 0 when not in multi-timbral mode)
+   */
+  size_t channelFor(uint8_t status) const noexcept { return multiTimbralModeEnabled_ ? (status & 0x0F) : 0; }
+
+  /**
+   Visit each active voice of a MIDI channel with a method that accepts two parameters: a `Voice` reference and a
+   `ReleaseKeyState` reference that contains the current pedal state of the channel.
+
+   @param channel the MIDI channel whose voices are visited
+   @param visitor the method to invoke
+   */
+  template <typename Visitor>
+  void visitActiveVoice(size_t channel, Visitor visitor) noexcept
+  {
+    auto releaseKeyState = Voice::ReleaseKeyState{minimumNoteDurationSamples(), channelStates_[channel].pedalState()};
+    visitActiveVoice(channel, visitor, releaseKeyState);
+  }
+
+  /**
+   Visit each active voice of a MIDI channel with a method that accepts two parameters: a `Voice` reference and a
+   `ReleaseKeyState` reference that contains the current pedal state.
+
+   @param channel the MIDI channel whose voices are visited
+   @param visitor the method to invoke
+   @param releaseKeyState the state of the pedal controllers
+   */
+  template <typename Visitor>
+  void visitActiveVoice(size_t channel, Visitor visitor, const Voice::ReleaseKeyState releaseKeyState) noexcept
+  {
+    for (auto pos = oldestVoiceIndices_.begin(); pos != oldestVoiceIndices_.end(); ) {
+      auto voiceIndex = *pos;
+      auto& voice{voices_[voiceIndex]};
+      if (!voice.isActive()) {
+        pos = retireVoice(voiceIndex);
+      } else {
+        if (voice.channel() == channel) visitor(voice, releaseKeyState);
+        ++pos;
+      }
+    }
+  }
+
+  /**
+   Account for a block with nothing to render. This skips the voice and send bus processing as well as the timing of
+   the block, so an idle engine costs next to nothing. The telemetry counts it as an idle block, apart from the render
+   times. The governor still sees the block as one with no load so that it can restore quality.
+
+   @param frameCount number of samples in the block
+   @returns true
+   */
+  bool renderIdle(AUAudioFrameCount frameCount) noexcept
+  {
+    auto deadline = frameCount / sampleRate_;
+    telemetry_.recordIdleBlock(midiEventCount_);
+    midiEventCount_ = 0;
+    if (governor_.update(0.0, deadline)) applyCullThreshold();
+    return true;
+  }
+
+  /**
+   Render the active voices into the output busses.
+
+   @param mixer collection of buffers to render into
+   @param frameCount number of samples to render.
+   */
+  void renderVoicesInto(Mixer& mixer, AUAudioFrameCount frameCount) noexcept
+  {
+#if ENABLE_LOWPASS_FILTER == 1
+    renderFilteredInto(mixer, frameCount);
+#else
+    for (auto pos = oldestVoiceIndices_.begin(); pos != oldestVoiceIndices_.end(); ) {
+      auto voiceIndex = *pos;
+      auto& voice{voices_[voiceIndex]};
+      if (voice.isActive()) {
+        voice.renderInto(mixer, frameCount);
+        recordProfile(voiceIndex);
+      }
+      if (voice.isDone()) {
+        pos = retireVoice(voiceIndex);
+      } else {
+        ++pos;
+      }
+    }
+#endif
+  }
+
+  /**
+   Render the active voices while one or more generators are ramping. The ramps advance at the start of each
+   `Mixer::blockSize` block and the voices render whole blocks in between. Once the ramps are done, the rest of the
+   frames render in one go.
+
+   @param mixer collection of buffers to render into
+   @param frameCount number of samples to render.
+   */
+  void renderRampingInto(Mixer& mixer, AUAudioFrameCount frameCount) noexcept
+  {
+    AUAudioFrameCount done = 0;
+    while (done < frameCount && parameters_.isRamping()) {
+      auto count = std::min(frameCount - done, Mixer::blockSize);
+      parameters_.advanceRamps(count);
+      if (parameters_.pendingCount() > 0) applyPendingParameters();
+      renderVoicesInto(mixer, count);
+      mixer.shiftOver(count);
+      done += count;
+    }
+    if (done < frameCount) renderVoicesInto(mixer, frameCount - done);
+    mixer.shiftBack(done);
+  }
+
+  /**
+   Render samples with the low-pass filters of the voices applied by `filterBank_`. Rendering takes place one mixer
+   block at a time: each active voice renders a block of unfiltered samples, and once the filter bank has a full set
+   of voices, it filters all of them at once before the voices mix their samples into the output busses.
+
+   @param mixer collection of buffers to render into
+   @param frameCount number of samples to render.
+   */
+  void renderFilteredInto(Mixer& mixer, AUAudioFrameCount frameCount) noexcept
+  {
+    for (auto voiceIndex : oldestVoiceIndices_) {
+      auto& voice{voices_[voiceIndex]};
+      if (voice.isActive()) voice.prepareToRender();
+    }
+
+    for (AUAudioFrameCount frame = 0; frame < frameCount; frame += Mixer::blockSize) {
+      auto count = std::min(frameCount - frame, Mixer::blockSize);
+      for (auto voiceIndex : oldestVoiceIndices_) {
+        auto& voice{voices_[voiceIndex]};
+        if (!voice.isActive()) continue;
+        auto rendered = voice.renderUnfilteredBlock(count);
+        if (voice.filter().isBypassed()) {
+          voice.filter().bypassBlock(voice.block(), rendered);
+          if (voice.isLinked()) voice.linkedFilter().bypassBlock(voice.linkedBlock(), rendered);
+          voice.mixBlock(mixer, frame, rendered);
+          continue;
+        }
+        // A voice rendering a stereo pair needs a lane for each half.
+        auto lanes = voice.isLinked() ? 2 : 1;
+        if (filterBank_.size() + lanes > filterBankLaneCount) mixFilteredVoices(mixer, frame, count);
+        filteredVoices_[filteredVoiceCount_++] = {&voice, rendered};
+        filterBank_.assign(voice.filter().lane(), voice.block(), rendered);
+        if (voice.isLinked()) filterBank_.assign(voice.linkedFilter().lane(), voice.linkedBlock(), rendered);
+        if (filterBank_.full()) mixFilteredVoices(mixer, frame, count);
+      }
+      if (filterBank_.size() > 0) mixFilteredVoices(mixer, frame, count);
+    }
+
+    for (auto pos = oldestVoiceIndices_.begin(); pos != oldestVoiceIndices_.end(); ) {
+      auto voiceIndex = *pos;
+      recordProfile(voiceIndex);
+      if (voices_[voiceIndex].isDone()) {
+        pos = retireVoice(voiceIndex);
+      } else {
+        ++pos;
+      }
+    }
+  }
+
+  void mixFilteredVoices(Mixer& mixer, AUAudioFrameCount frame, AUAudioFrameCount frameCount) noexcept
+  {
+    if constexpr (Render::Voice::StageClock::enabled) {
+      // Share the time spent in the filter bank among the voices by the number of lanes they use.
+      auto lanes = filterBank_.size();
+      auto start = Utils::cycleCount();
+      filterBank_.process(frameCount);
+      auto share = (Utils::cycleCount() - start) / lanes;
+      for (size_t index = 0; index < filteredVoiceCount_; ++index) {
+        auto voice = filteredVoices_[index].first;
+        voice->stageClock().add(Render::Voice::Stage::filter, voice->isLinked() ? 2 * share : share);
+      }
+    } else {
+      filterBank_.process(frameCount);
+    }
+    for (size_t index = 0; index < filteredVoiceCount_; ++index) {
+      filteredVoices_[index].first->mixBlock(mixer, frame, filteredVoices_[index].second);
+    }
+    filteredVoiceCount_ = 0;
+  }
+
+  /**
+   Add the render costs of a voice to the profile. Does nothing unless built with SF2_VOICE_PROFILING=1.
+
+   @param voiceIndex the index of the voice that rendered
+   */
+  void recordProfile([[maybe_unused]] size_t voiceIndex) noexcept
+  {
+#if SF2_VOICE_PROFILING == 1
+    renderProfile_.record(voiceIndex, voices_[voiceIndex].stageClock());
+#endif
+  }
+
+  /**
+   Remove a voice that has stopped from the collection of active voices. Its filter state is cleared so that it does not
+   hold decaying values while idle.
+
+   @param voiceIndex the index of the voice to remove
+   @returns iterator to the next active voice
+   */
+  OldestVoiceCollection<maxVoiceCount>::iterator retireVoice(size_t voiceIndex) noexcept
+  {
+    if (voices_[voiceIndex].wasCulled()) telemetry_.voiceCulled();
+    voices_[voiceIndex].filter().flush();
+    unlinkVoice(voiceIndex);
+    return oldestVoiceIndices_.voiceOff(voiceIndex);
+  }
+
+  /// Number of MIDI key and exclusive class values per channel in `keyVoices_` and `exclusiveClassVoices_`
+  static inline constexpr size_t keySlotCount = 128;
+
+  /**
+   @param channel the MIDI channel of a voice
+   @param value the MIDI key or exclusive class of a voice
+   @returns index of the list in `keyVoices_` or `exclusiveClassVoices_` that holds voices with the given values
+   */
+  static size_t keySlot(size_t channel, int value) noexcept { return channel * keySlotCount + size_t(value); }
+
+  /**
+   Add a voice that just started to the lists for its key, its exclusive class, and held voices.
+
+   @param voiceIndex the index of the voice to add
+   */
+  void linkVoice(size_t voiceIndex) noexcept
+  {
+    const auto& voice{voices_[voiceIndex]};
+    auto key = voice.initiatingKey();
+    if (key >= 0 && size_t(key) < keySlotCount) keyVoices_.insert(keySlot(voice.channel(), key), voiceIndex);
+    auto exclusiveClass = voice.exclusiveClass();
+    if (exclusiveClass > 0 && size_t(exclusiveClass) < keySlotCount) {
+      exclusiveClassVoices_.insert(keySlot(voice.channel(), exclusiveClass), voiceIndex);
+    }
+    heldVoices_.insert(voice.channel(), voiceIndex);
+  }
+
+  /**
+   Remove a voice from the lists for its key, its exclusive class, and held voices.
+
+   @param voiceIndex the index of the voice to remove
+   */
+  void unlinkVoice(size_t voiceIndex) noexcept
+  {
+    keyVoices_.remove(voiceIndex);
+    exclusiveClassVoices_.remove(voiceIndex);
+    heldVoices_.remove(voiceIndex);
+  }
+
+  void applyCommands() noexcept;
+
+  /**
+   Apply the pending generator changes to all active voices in one pass and then clear them.
+   */
+  void applyPendingParameters() noexcept;
+
+  void applyCommand(const Command& command) noexcept;
+
+  void stopAllExclusiveVoices(size_t channel, int exclusiveClass) noexcept;
+
+  void stopSameKeyVoices(size_t channel, int eventKey) noexcept;
+
+  void startVoice(size_t channel, const Config& config, const Config* partner = nullptr) noexcept;
+
+  /**
+   Locate the other half of a stereo sample pair among the configurations for a note. The two halves must be of
+   opposite sides, name each other through their sample links, and have the same sample length and loop.
+
+   @param configs the configurations that matched a note
+   @param index the index of the configuration to pair
+   @returns index of the other half or `configs.size()` if there is none
+   */
+  size_t stereoPartner(const std::vector<Config>& configs, size_t index) noexcept;
+
+  void stealVoiceIfNecessary(size_t channel, int exclusiveClass) noexcept;
+
+  void shedExcessVoices(size_t limit) noexcept;
+
+  /// @returns number of active voices that are not fading out
+  size_t playingVoiceCount() const noexcept;
+
+  /// @returns index of the best playing voice to steal for a new note, or `voices_.size()` if there is none
+  size_t stealCandidate(size_t channel, int exclusiveClass) const noexcept;
+
+  /// @returns index of the quietest voice that is fading out, or `voices_.size()` if there is none
+  size_t quietestFadingVoice() const noexcept;
+
+  void applyCullThreshold() noexcept;
+
+  OldestVoiceCollection<maxVoiceCount>::iterator stopVoice(size_t voiceIndex) noexcept;
+
+  void notifyActiveVoicesChannelStateChanged(size_t channel) noexcept;
+
+  void notifyActiveVoicesChannelStateChanged(size_t channel, Render::Voice::State::SourceId source) noexcept;
+
+  void processChannelMessage(size_t channel, MIDI::ControlChange cc, uint8_t value) noexcept;
+
+  void processControlChange(size_t channel, MIDI::ControlChange cc, uint8_t value) noexcept;
+
+  void changeProgram(size_t channel, uint8_t program) noexcept;
+
+  void loadFromMIDI(std::span<const uint8_t> bytes) noexcept;
+
+  void applySostenutoPedal(size_t channel) noexcept;
+
+  void applyPedals(size_t channel) noexcept;
+
+  Float sampleRate_;
+  size_t minimumNoteDurationMilliseconds_{0};
+  Interpolator interpolator_;
+
+  std::array<MIDI::ChannelState, channelCount> channelStates_{};
+  Parameters parameters_;
+
+  std::vector<Voice> voices_{};
+  OldestVoiceCollection<maxVoiceCount> oldestVoiceIndices_;
+  // Active voices by channel and initiating key, by channel and exclusive class, and by channel while they are still
+  // held by a key or a pedal. These let MIDI events visit only the voices they affect.
+  VoiceLists<channelCount * keySlotCount, maxVoiceCount> keyVoices_{};
+  VoiceLists<channelCount * keySlotCount, maxVoiceCount> exclusiveClassVoices_{};
+  VoiceLists<channelCount, maxVoiceCount> heldVoices_{};
+  Render::Voice::State::State linkState_;
+
+  std::shared_ptr<const SoundFont> soundFont_{};
+  const PresetCollection* presets_{&SoundFont::noPresets()};
+  std::array<size_t, channelCount> activePresets_{};
+
+  size_t portamentoRateMillisecondsPerSemitone_{100};
+  std::atomic<PhonicMode> phonicMode_{PhonicMode::poly};
+
+  std::atomic<bool> oneVoicePerKeyModeEnabled_{false};
+  std::atomic<bool> portamentoModeEnabled_{false};
+  std::atomic<bool> retriggerModeEnabled_{true};
+  std::atomic<bool> multiTimbralModeEnabled_{false};
+  std::atomic<bool> linkedStereoModeEnabled_{false};
+  std::atomic<StealingPolicy> stealingPolicy_{StealingPolicy::oldest};
+  Telemetry telemetry_{};
+#if SF2_VOICE_PROFILING == 1
+  RenderProfile<maxVoiceCount> renderProfile_{};
+#endif
+  size_t midiEventCount_{0};
+  Float voiceCullThresholdDecibels_{minimumVoiceCullThreshold};
+  Governor governor_{};
+  std::atomic<size_t> voiceLimit_{maxVoiceCount};
+  CommandQueue commands_{};
+  FilterBank<filterBankLaneCount, Mixer::blockSize> filterBank_{};
+  std::array<std::pair<Voice*, AUAudioFrameCount>, filterBankLaneCount> filteredVoices_{};
+  size_t filteredVoiceCount_{0};
+
+  friend struct ::TestEngineHarness;
+  friend class ParameterTree;
+};
+
+} // end namespace SF2::Render
@@ -0,0 +1,240 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+namespace SF2::Render::Engine {
+
+/**
+ Runtime statistics for the engine. The render thread updates the values and any other thread may read them. All
+ values are held in lock-free atomics and nothing is allocated, so recording is safe in a real-time thread. Values
+ read from another thread are each up to date, but they may not all reflect the same render block.
+
+ Render times are kept in a histogram of `histogramBucketCount` buckets with `bucketsPerOctave` buckets for each
+ doubling of time, starting at `histogramMinimumSeconds`. Percentiles are therefore accurate to within one bucket,
+ which is about 19%.
+
+ Blocks skipped because the engine was idle are only counted. They are not part of the render times or the averages,
+ which would otherwise mostly describe the silence between notes.
+ */
+class Telemetry
+{
+public:
+  /// Number of buckets in the render time histogram
+  static inline constexpr size_t histogramBucketCount = 64;
+
+  /// Number of histogram buckets for each doubling of render time
+  static inline constexpr size_t bucketsPerOctave = 4;
+
+  /// The upper bound of the first histogram bucket is this value times 2^(1/bucketsPerOctave)
+  static inline constexpr double histogramMinimumSeconds = 1.0e-6;
+
+  /// Collection of the statistics at one point in time.
+  struct Snapshot {
+    /// Number of blocks rendered, not counting idle ones
+    uint64_t blockCount;
+    /// Number of blocks skipped because no voices were active
+    uint64_t idleBlockCount;
+    /// Number of blocks that took longer to render than their real-time duration
+    uint64_t overrunCount;
+    /// Median render time of a block in seconds
+    double renderTimeP50;
+    /// 90th percentile render time of a block in seconds
+    double renderTimeP90;
+    /// 99th percentile render time of a block in seconds
+    double renderTimeP99;
+    /// Longest render time of a block in seconds
+    double renderTimeMaximum;
+    /// Most voices active in a block
+    size_t peakActiveVoiceCount;
+    /// Average number of voices active in a block
+    double averageActiveVoiceCount;
+    /// Number of voices stolen to make room for new notes
+    uint64_t stolenVoiceCount;
+    /// Number of releasing voices stopped because their output fell below the noise floor or cull threshold
+    uint64_t culledVoiceCount;
+    /// Number of note ON events ignored because the channel had no active preset
+    uint64_t droppedNoteOnCount;
+    /// Number of MIDI events processed, including those for idle blocks
+    uint64_t midiEventCount;
+    /// Most MIDI events processed for one block
+    size_t peakMIDIEventsPerBlock;
+    /// Average number of MIDI events processed for a rendered block
+    double averageMIDIEventsPerBlock;
+  };
+
+  /**
+   Record the statistics for one rendered block. Only call from the render thread.
+
+   @param elapsedSeconds the time spent rendering the block
+   @param deadlineSeconds the real-time duration of the block
+   @param activeVoiceCount the number of voices active in the block
+   @param midiEventCount the number of MIDI events processed for the block
+   */
+  void recordBlock(double elapsedSeconds, double deadlineSeconds, size_t activeVoiceCount,
+                   size_t midiEventCount) noexcept {
+    histogram_[bucketIndex(elapsedSeconds)].fetch_add(1, std::memory_order_relaxed);
+    if (deadlineSeconds > 0.0 && elapsedSeconds > deadlineSeconds) overrunCount_.fetch_add(1, std::memory_order_relaxed);
+    if (elapsedSeconds > renderTimeMaximum_.load(std::memory_order_relaxed)) {
+      renderTimeMaximum_.store(elapsedSeconds, std::memory_order_relaxed);
+    }
+
+    activeVoiceSum_.fetch_add(activeVoiceCount, std::memory_order_relaxed);
+    if (activeVoiceCount > peakActiveVoiceCount_.load(std::memory_order_relaxed)) {
+      peakActiveVoiceCount_.store(activeVoiceCount, std::memory_order_relaxed);
+    }
+
+    midiEventCount_.fetch_add(midiEventCount, std::memory_order_relaxed);
+    if (midiEventCount > peakMIDIEventsPerBlock_.load(std::memory_order_relaxed)) {
+      peakMIDIEventsPerBlock_.store(midiEventCount, std::memory_order_relaxed);
+    }
+
+    // Publish the block last so that a reader that sees the new count also sees the values above.
+    blockCount_.fetch_add(1, std::memory_order_release);
+  }
+
+  /**
+   Record a block that was skipped because the engine was idle. Only call from the render thread.
+
+   @param midiEventCount the number of MIDI events processed for the block
+   */
+  void recordIdleBlock(size_t midiEventCount) noexcept {
+    idleMIDIEventCount_.fetch_add(midiEventCount, std::memory_order_relaxed);
+    if (midiEventCount > peakMIDIEventsPerBlock_.load(std::memory_order_relaxed)) {
+      peakMIDIEventsPerBlock_.store(midiEventCount, std::memory_order_relaxed);
+    }
+    idleBlockCount_.fetch_add(1, std::memory_order_release);
+  }
+
+  /// Record that a voice was stolen.
+  void voiceStolen() noexcept { stolenVoiceCount_.fetch_add(1, std::memory_order_relaxed); }
+
+  /// Record that a releasing voice was culled.
+  void voiceCulled() noexcept { culledVoiceCount_.fetch_add(1, std::memory_order_relaxed); }
+
+  /// Record that a note ON was ignored.
+  void noteOnDropped() noexcept { droppedNoteOnCount_.fetch_add(1, std::memory_order_relaxed); }
+
+  /// @returns number of blocks rendered
+  uint64_t blockCount() const noexcept { return blockCount_.load(std::memory_order_acquire); }
+
+  /// @returns number of blocks skipped because the engine was idle
+  uint64_t idleBlockCount() const noexcept { return idleBlockCount_.load(std::memory_order_acquire); }
+
+  /// @returns number of voices stolen to make room for new notes
+  uint64_t stolenVoiceCount() const noexcept { return stolenVoiceCount_.load(std::memory_order_relaxed); }
+
+  /// @returns number of releasing voices that were culled
+  uint64_t culledVoiceCount() const noexcept { return culledVoiceCount_.load(std::memory_order_relaxed); }
+
+  /// @returns number of note ON events ignored due to a missing preset
+  uint64_t droppedNoteOnCount() const noexcept { return droppedNoteOnCount_.load(std::memory_order_relaxed); }
+
+  /**
+   Obtain a render time percentile from the histogram.
+
+   @param fraction the percentile to obtain as a value between 0.0 and 1.0
+   @returns render time in seconds, or 0.0 if no blocks have been recorded
+   */
+  double renderTimePercentile(double fraction) const noexcept {
+    std::array<uint64_t, histogramBucketCount> counts;
+    uint64_t total = 0;
+    for (size_t index = 0; index < histogramBucketCount; ++index) {
+      counts[index] = histogram_[index].load(std::memory_order_relaxed);
+      total += counts[index];
+    }
+    if (total == 0) return 0.0;
+
+    auto target = std::max<uint64_t>(1, uint64_t(std::ceil(std::clamp(fraction, 0.0, 1.0) * double(total))));
+    uint64_t seen = 0;
+    size_t index = 0;
+    for (; index < histogramBucketCount - 1; ++index) {
+      seen += counts[index];
+      if (seen >= target) break;
+    }
+    return std::min(bucketUpperBound(index), renderTimeMaximum_.load(std::memory_order_relaxed));
+  }
+
+  /// @returns the current statistics
+  Snapshot snapshot() const noexcept {
+    auto blocks = blockCount();
+    auto idleBlocks = idleBlockCount();
+    auto midiEvents = midiEventCount_.load(std::memory_order_relaxed);
+    auto idleMIDIEvents = idleMIDIEventCount_.load(std::memory_order_relaxed);
+    auto divisor = blocks > 0 ? double(blocks) : 1.0;
+    return Snapshot{
+      blocks,
+      idleBlocks,
+      overrunCount_.load(std::memory_order_relaxed),
+      renderTimePercentile(0.50),
+      renderTimePercentile(0.90),
+      renderTimePercentile(0.99),
+      renderTimeMaximum_.load(std::memory_order_relaxed),
+      peakActiveVoiceCount_.load(std::memory_order_relaxed),
+      double(activeVoiceSum_.load(std::memory_order_relaxed)) / divisor,
+      stolenVoiceCount(),
+      culledVoiceCount(),
+      droppedNoteOnCount(),
+      midiEvents + idleMIDIEvents,
+      peakMIDIEventsPerBlock_.load(std::memory_order_relaxed),
+      double(midiEvents) / divisor
+    };
+  }
+
+  /// Clear all statistics. Values recorded by the render thread while this runs may be partially lost.
+  void reset() noexcept {
+    for (auto& bucket : histogram_) bucket.store(0, std::memory_order_relaxed);
+    blockCount_.store(0, std::memory_order_relaxed);
+    idleBlockCount_.store(0, std::memory_order_relaxed);
+    overrunCount_.store(0, std::memory_order_relaxed);
+    renderTimeMaximum_.store(0.0, std::memory_order_relaxed);
+    activeVoiceSum_.store(0, std::memory_order_relaxed);
+    peakActiveVoiceCount_.store(0, std::memory_order_relaxed);
+    stolenVoiceCount_.store(0, std::memory_order_relaxed);
+    culledVoiceCount_.store(0, std::memory_order_relaxed);
+    droppedNoteOnCount_.store(0, std::memory_order_relaxed);
+    midiEventCount_.store(0, std::memory_order_relaxed);
+    idleMIDIEventCount_.store(0, std::memory_order_relaxed);
+    peakMIDIEventsPerBlock_.store(0, std::memory_order_relaxed);
+  }
+
+  /**
+   @param seconds a render time
+   @returns the index of the histogram bucket that holds the given time
+   */
+  static size_t bucketIndex(double seconds) noexcept {
+    if (!(seconds > histogramMinimumSeconds)) return 0;
+    auto index = std::floor(double(bucketsPerOctave) * std::log2(seconds / histogramMinimumSeconds));
+    return size_t(std::min(index, double(histogramBucketCount - 1)));
+  }
+
+  /**
+   @param index the index of a histogram bucket
+   @returns the largest render time held by the bucket
+   */
+  static double bucketUpperBound(size_t index) noexcept {
+    return histogramMinimumSeconds * std::exp2(double(index + 1) / double(bucketsPerOctave));
+  }
+
+private:
+  std::array<std::atomic<uint64_t>, histogramBucketCount> histogram_{};
+  std::atomic<uint64_t> blockCount_{0};
+  std::atomic<uint64_t> idleBlockCount_{0};
+  std::atomic<uint64_t> overrunCount_{0};
+  std::atomic<double> renderTimeMaximum_{0.0};
+  std::atomic<uint64_t> activeVoiceSum_{0};
+  std::atomic<size_t> peakActiveVoiceCount_{0};
+  std::atomic<uint64_t> stolenVoiceCount_{0};
+  std::atomic<uint64_t> culledVoiceCount_{0};
+  std::atomic<uint64_t> droppedNoteOnCount_{0};
+  std::atomic<uint64_t> midiEventCount_{0};
+  std::atomic<uint64_t> idleMIDIEventCount_{0};
+  std::atomic<size_t> peakMIDIEventsPerBlock_{0};
+};
+
+} // end namespace SF2::Render::Engine
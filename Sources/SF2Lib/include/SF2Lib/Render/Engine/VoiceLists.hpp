@@ -0,0 +1,114 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+
+#include "SF2Lib/Types.hpp"
+
+namespace SF2::Render::Engine {
+
+/**
+ Collection of intrusive linked lists of voice indices. A voice is in at most one of the lists at a time. The links are
+ held in fixed arrays indexed by voice, so adding and removing a voice are O(1) and there is no memory allocation.
+ Visiting a list only touches the voices in it, newest first.
+
+ The engine keeps one collection for voices by MIDI channel and key, one for voices by MIDI channel and exclusive
+ class, and one for voices that are still held down by a key or a pedal.
+ */
+template <size_t ListCount, size_t MaxVoiceCount>
+class VoiceLists
+{
+public:
+  using Link = uint16_t;
+
+  /// Marker for the end of a list, or a voice that is not in any list
+  static inline constexpr Link none = std::numeric_limits<Link>::max();
+
+  static_assert(MaxVoiceCount < none, "voice indices must fit in a Link");
+  static_assert(ListCount < none, "list indices must fit in a Link");
+
+  VoiceLists() noexcept { clear(); }
+
+  /**
+   Add a voice to the front of a list. If the voice is in another list, it is removed from it first.
+
+   @param list the index of the list to add to
+   @param voiceIndex the index of the voice to add
+   */
+  void insert(size_t list, size_t voiceIndex) noexcept
+  {
+    assert(list < ListCount && voiceIndex < MaxVoiceCount);
+    remove(voiceIndex);
+    auto head = heads_[list];
+    next_[voiceIndex] = head;
+    prev_[voiceIndex] = none;
+    if (head != none) prev_[head] = Link(voiceIndex);
+    heads_[list] = Link(voiceIndex);
+    owner_[voiceIndex] = Link(list);
+  }
+
+  /**
+   Remove a voice from the list it is in. Does nothing if the voice is not in a list.
+
+   @param voiceIndex the index of the voice to remove
+   */
+  void remove(size_t voiceIndex) noexcept
+  {
+    assert(voiceIndex < MaxVoiceCount);
+    auto list = owner_[voiceIndex];
+    if (list == none) return;
+    auto prev = prev_[voiceIndex];
+    auto next = next_[voiceIndex];
+    if (prev != none) next_[prev] = next; else heads_[list] = next;
+    if (next != none) prev_[next] = prev;
+    owner_[voiceIndex] = none;
+  }
+
+  /**
+   @param voiceIndex the index of the voice to check
+   @returns true if the voice is in one of the lists
+   */
+  bool contains(size_t voiceIndex) const noexcept { return owner_[voiceIndex] != none; }
+
+  /**
+   @param list the index of the list to check
+   @returns true if the list has no voices
+   */
+  bool empty(size_t list) const noexcept { return heads_[list] == none; }
+
+  /**
+   Visit the voices in a list, newest first. The visitor may remove the voice it is given from the list, but no other.
+
+   @param list the index of the list to visit
+   @param visitor the function to call with each voice index
+   */
+  template <typename Visitor>
+  void visit(size_t list, Visitor&& visitor) noexcept
+  {
+    assert(list < ListCount);
+    for (auto voiceIndex = heads_[list]; voiceIndex != none; ) {
+      auto next = next_[voiceIndex];
+      visitor(size_t(voiceIndex));
+      voiceIndex = next;
+    }
+  }
+
+  /// Empty all of the lists.
+  void clear() noexcept
+  {
+    heads_.fill(none);
+    owner_.fill(none);
+  }
+
+private:
+  std::array<Link, ListCount> heads_;
+  std::array<Link, MaxVoiceCount> next_{};
+  std::array<Link, MaxVoiceCount> prev_{};
+  std::array<Link, MaxVoiceCount> owner_;
+};
+
+} // end namespace SF2::Render::Engine
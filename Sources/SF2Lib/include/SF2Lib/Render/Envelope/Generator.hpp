@@ -2,8 +2,6 @@
 
 #pragma once
 
-#include <os/log.h>
-
 #include <algorithm>
 #include <cmath>
 #include <limits>
@@ -204,7 +202,6 @@ private:
   Float sustainLevel_{0_F};
   const char* logTag_;
   const size_t voiceIndex_;
-  const os_log_t log_;
 
   static const StateNameArray stageNames_;
 };
@@ -0,0 +1,161 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+
+#include "SF2Lib/Types.hpp"
+#include "SF2Lib/Render/LowPassFilter.hpp"
+
+namespace SF2::Render {
+
+/**
+ Runs the low-pass filters of several voices at the same time. The coefficients, ramps and state of each filter are
+ copied into a structure-of-arrays layout where each voice occupies one lane, and the samples of the voices are
+ interleaved so that the inner loop works on all lanes of one frame at once. This lets the compiler use SIMD
+ instructions for the biquad calculations. When done, the filtered samples and the updated filter state are copied
+ back to the voices.
+
+ The calculations are the same as those of `DSPHeaders::Biquad::Transform::Direct` used by `LowPassFilter::transform`.
+
+ @param Lanes the number of filters to run at the same time
+ @param MaxFrames the maximum number of frames to filter in one call to `process`
+ */
+template <size_t Lanes, size_t MaxFrames>
+class FilterBank
+{
+public:
+  static inline constexpr size_t laneCount = Lanes;
+  static inline constexpr size_t maxFrames = MaxFrames;
+
+  /// @returns number of lanes that have been assigned a filter
+  size_t size() const noexcept { return size_; }
+
+  /// @returns true if all lanes have been assigned a filter
+  bool full() const noexcept { return size_ == Lanes; }
+
+  /**
+   Assign a filter and its samples to the next free lane.
+
+   @param filter the filter coefficients and state to use
+   @param samples the samples to filter in place
+   @param frameCount the number of samples to filter (must be <= `MaxFrames`)
+   */
+  void assign(LowPassFilter::Lane& filter, Float* samples, size_t frameCount) noexcept
+  {
+    assert(size_ < Lanes && frameCount <= MaxFrames);
+    auto lane = size_++;
+    filters_[lane] = &filter;
+    samples_[lane] = samples;
+    frameCounts_[lane] = frameCount;
+
+    a0_[lane] = filter.coefficients.a0;
+    a1_[lane] = filter.coefficients.a1;
+    a2_[lane] = filter.coefficients.a2;
+    b1_[lane] = filter.coefficients.b1;
+    b2_[lane] = filter.coefficients.b2;
+
+    da0_[lane] = filter.change.a0;
+    da1_[lane] = filter.change.a1;
+    da2_[lane] = filter.change.a2;
+    db1_[lane] = filter.change.b1;
+    db2_[lane] = filter.change.b2;
+
+    x1_[lane] = filter.state.x_z1;
+    x2_[lane] = filter.state.x_z2;
+    y1_[lane] = filter.state.y_z1;
+    y2_[lane] = filter.state.y_z2;
+
+    for (size_t frame = 0; frame < frameCount; ++frame) frames_[frame][lane] = samples[frame];
+  }
+
+  /**
+   Filter the samples of all assigned lanes, copy the results back to the voices, and free all lanes.
+
+   @param frameCount the number of frames to process. Lanes with fewer samples see zeros past their end.
+   */
+  void process(size_t frameCount) noexcept
+  {
+    assert(frameCount <= MaxFrames);
+
+    // Unused lanes and unused frames are filtered too, but with zeros so that the loops below do not need to know
+    // about them.
+    for (size_t lane = size_; lane < Lanes; ++lane) clearLane(lane);
+    std::array<Float, Lanes> steps;
+    for (size_t lane = 0; lane < Lanes; ++lane) {
+      steps[lane] = lane < size_ ? Float(std::min(filters_[lane]->rampRemaining, frameCount)) : 0_F;
+      for (size_t frame = lane < size_ ? frameCounts_[lane] : 0; frame < frameCount; ++frame) {
+        frames_[frame][lane] = 0_F;
+      }
+    }
+
+    for (size_t frame = 0; frame < frameCount; ++frame) {
+      auto& values{frames_[frame]};
+      for (size_t lane = 0; lane < Lanes; ++lane) {
+        Float ramp = Float(frame) < steps[lane] ? 1_F : 0_F;
+        a0_[lane] += ramp * da0_[lane];
+        a1_[lane] += ramp * da1_[lane];
+        a2_[lane] += ramp * da2_[lane];
+        b1_[lane] += ramp * db1_[lane];
+        b2_[lane] += ramp * db2_[lane];
+
+        Float input = values[lane];
+        Float output = a0_[lane] * input + a1_[lane] * x1_[lane] + a2_[lane] * x2_[lane] - b1_[lane] * y1_[lane] -
+        b2_[lane] * y2_[lane];
+        output = std::abs(output) <= noiseFloor ? 0_F : output;
+        x2_[lane] = x1_[lane];
+        x1_[lane] = input;
+        y2_[lane] = y1_[lane];
+        y1_[lane] = output;
+        values[lane] = output;
+      }
+    }
+
+    for (size_t lane = 0; lane < size_; ++lane) {
+      auto& filter{*filters_[lane]};
+      if (filter.rampRemaining <= frameCount) {
+        filter.rampRemaining = 0;
+        filter.coefficients = filter.goal;
+      } else {
+        filter.rampRemaining -= frameCount;
+        filter.coefficients = LowPassFilter::Coefficients(a0_[lane], a1_[lane], a2_[lane], b1_[lane], b2_[lane]);
+      }
+
+      filter.state.x_z1 = x1_[lane];
+      filter.state.x_z2 = x2_[lane];
+      filter.state.y_z1 = y1_[lane];
+      filter.state.y_z2 = y2_[lane];
+
+      auto samples = samples_[lane];
+      for (size_t frame = 0; frame < frameCounts_[lane]; ++frame) samples[frame] = frames_[frame][lane];
+    }
+
+    size_ = 0;
+  }
+
+private:
+  static inline constexpr Float noiseFloor = 2.0e-10;
+
+  void clearLane(size_t lane) noexcept
+  {
+    a0_[lane] = a1_[lane] = a2_[lane] = b1_[lane] = b2_[lane] = 0_F;
+    da0_[lane] = da1_[lane] = da2_[lane] = db1_[lane] = db2_[lane] = 0_F;
+    x1_[lane] = x2_[lane] = y1_[lane] = y2_[lane] = 0_F;
+  }
+
+  using LaneValues = std::array<Float, Lanes>;
+
+  alignas(64) std::array<LaneValues, MaxFrames> frames_;
+  alignas(64) LaneValues a0_, a1_, a2_, b1_, b2_;
+  alignas(64) LaneValues da0_, da1_, da2_, db1_, db2_;
+  alignas(64) LaneValues x1_, x2_, y1_, y2_;
+  std::array<LowPassFilter::Lane*, Lanes> filters_;
+  std::array<Float*, Lanes> samples_;
+  std::array<size_t, Lanes> frameCounts_;
+  size_t size_{0};
+};
+
+} // end namespace SF2::Render
@@ -2,7 +2,6 @@
 
 #pragma once
 
-#include <os/log.h>
 #include <cmath>
 
 #include "SF2Lib/DSP.hpp"
@@ -95,7 +94,7 @@ protected:
   Float increment_{0_F};
   size_t delaySampleCount_{0};
 
-  const os_log_t log_;
+  const char* logTag_;
 };
 
 } // namespace SF2::Render
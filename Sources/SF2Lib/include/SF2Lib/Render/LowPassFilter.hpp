@@ -2,44 +2,164 @@
 
 #pragma once
 
+#include <memory>
+
 #include "SF2Lib/Types.hpp"
 #include "SF2Lib/DSPHeaders/Biquad.hpp"
 
 namespace SF2::Render {
 
+/**
+ Two-pole low-pass filter that is applied to the samples of a voice. The filter settings are only examined at control
+ rate -- every `controlInterval` samples -- and any change in coefficients is ramped over the next interval. The
+ coefficients themselves come from precomputed tables indexed by whole cents of cutoff and whole centiBels of
+ resonance, so no trigonometric or power functions are evaluated while rendering.
+ */
 class LowPassFilter
 {
 public:
   using Coefficients = DSPHeaders::Biquad::Coefficients<Float>;
+  using State = DSPHeaders::Biquad::State<Float>;
+
+  /**
+   The filter coefficients and state of one filter. This is kept apart so that `FilterBank` can run the filters of
+   several voices at the same time.
+   */
+  struct Lane {
+    Coefficients coefficients{};
+    Coefficients change{};
+    Coefficients goal{};
+    size_t rampRemaining{0};
+    State state{};
+  };
 
   inline static Float defaultFrequency = 13500_F;
   inline static Float defaultResonance = 0_F;
 
+  /// Number of samples between updates of the filter settings.
+  static inline constexpr size_t controlInterval = 64;
+
+  /// Cutoff value in cents at or above which the filter is effectively open.
+  static inline constexpr int maximumCutoff = 13'500;
+
+  /// Largest resonance value in centiBels.
+  static inline constexpr int maximumResonance = 960;
+
   LowPassFilter(Float sampleRate) noexcept;
 
+  /**
+   Count down the samples until the next control-rate update. Must be called once per sample.
+
+   @returns true if new settings should be given to `update`
+   */
+  inline bool updateDue() noexcept {
+    if (countdown_ == 0) {
+      countdown_ = controlInterval - 1;
+      return true;
+    }
+    --countdown_;
+    return false;
+  }
+
+  /// Make the next call to `updateDue` return true so that an update happens at the start of a block of samples.
+  void alignUpdate() noexcept { countdown_ = 0; }
+
   /**
    Update the filter to use the given frequency and resonance settings.
 
    @param frequency frequency represented in cents
    @param resonance resonance in centiBels
    */
-  inline Float transform(Float frequency, Float resonance, Float sample) noexcept {
-    if (lastFrequency_ != frequency || lastResonance_ != resonance) updateSettings(frequency, resonance);
-    return filter_.transform(sample);
+  void update(Float frequency, Float resonance) noexcept;
+
+  /**
+   Filter a sample.
+
+   @param sample the value to filter
+   @returns filtered value
+   */
+  inline Float transform(Float sample) noexcept {
+    if (bypassed_) {
+      trackBypassed(sample);
+      return sample;
+    }
+    switch (lane_.rampRemaining) {
+      case 0:
+        break;
+      case 1:
+        lane_.rampRemaining = 0;
+        lane_.coefficients = lane_.goal;
+        break;
+      default:
+        lane_.rampRemaining -= 1;
+        lane_.coefficients += lane_.change;
+        break;
+    }
+    return DSPHeaders::Biquad::Transform::Direct<Float>::transform(sample, lane_.state, lane_.coefficients);
   }
 
-  void reset() noexcept { filter_.reset(); }
+  /**
+   Note the samples of a block that bypassed the filter, as done by the engine when it skips `FilterBank` for a voice.
+   The filter keeps the last two so that it can leave bypass without a step.
+
+   @param samples the samples that were not filtered
+   @param frameCount the number of samples in the block
+   */
+  void bypassBlock(const Float* samples, size_t frameCount) noexcept {
+    if (frameCount > 1) trackBypassed(samples[frameCount - 2]);
+    if (frameCount > 0) trackBypassed(samples[frameCount - 1]);
+  }
+
+  /// @returns the coefficients and state of the filter
+  Lane& lane() noexcept { return lane_; }
+
+  /// @returns true if the filter is currently passing samples through untouched
+  bool isBypassed() const noexcept { return bypassed_; }
+
+  /// Clear the filter state so that no decaying values linger in it while the voice is idle.
+  void flush() noexcept { lane_.state = State(); }
+
+  /// Reset the filter state for a new note.
+  void reset() noexcept {
+    flush();
+    if (lane_.rampRemaining) {
+      lane_.rampRemaining = 0;
+      lane_.coefficients = lane_.goal;
+    }
+    countdown_ = 0;
+    primed_ = false;
+  }
 
   void setSampleRate(Float sampleRate) noexcept;
 
+  /**
+   Obtain the filter coefficients for the given settings using the lookup tables.
+
+   @param frequency frequency represented in cents
+   @param resonance resonance in centiBels
+   @returns filter coefficients
+   */
+  Coefficients coefficients(Float frequency, Float resonance) const noexcept;
+
 private:
+  struct CutoffTable;
 
-  void updateSettings(Float frequency, Float resonance) noexcept;
+  void setCoefficients(const Coefficients& goal, size_t rampDuration) noexcept;
+
+  /// While bypassed, the input history of the filter state holds the latest samples.
+  void trackBypassed(Float sample) noexcept {
+    lane_.state.x_z2 = lane_.state.x_z1;
+    lane_.state.x_z1 = sample;
+  }
 
-  DSPHeaders::Biquad::Direct<Float> filter_;
+  Lane lane_{};
+  std::shared_ptr<const CutoffTable> cutoffTable_;
   Float sampleRate_;
-  Float lastFrequency_;
-  Float lastResonance_;
+  int lastFrequency_;
+  int lastResonance_;
+  size_t countdown_{0};
+  bool primed_{false};
+  bool bypassed_{false};
 };
 
 } // end namespace SF2::Render
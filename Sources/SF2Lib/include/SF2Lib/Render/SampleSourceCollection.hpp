@@ -36,6 +36,9 @@ public:
     return checkedVectorIndexing(collection_, index);
   }
 
+  /// @return the number of sample sources in the collection
+  size_t size() const noexcept { return collection_.size(); }
+
   /// @return true if the collection is empty. This is true after File loading due to lazy-loading of the rendering
   /// entities such as this.
   bool empty() const noexcept { return collection_.empty(); }
@@ -0,0 +1,54 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "SF2Lib/IO/File.hpp"
+#include "SF2Lib/Render/PresetCollection.hpp"
+
+namespace SF2::Render {
+
+/**
+ An SF2 file together with the presets built from it. Once loaded, nothing in it changes, so any number of engines may
+ render from one instance at the same time, each on its own thread. Engines hold it through a `std::shared_ptr`, which
+ keeps it alive until the last one lets go.
+ */
+class SoundFont
+{
+public:
+
+  /**
+   Load an SF2 file and build its presets.
+
+   @param path the file to load
+   @param response set to the result of the load
+   @returns the loaded sound font or nullptr if the load failed
+   */
+  static std::shared_ptr<const SoundFont> load(const std::string& path, IO::File::LoadResponse& response) noexcept;
+
+  /// @returns the SF2 file
+  const IO::File& file() const noexcept { return *file_; }
+
+  /// @returns the presets of the file
+  const PresetCollection& presets() const noexcept { return presets_; }
+
+  /// @returns the sample sources of the file
+  const SampleSourceCollection& sampleSources() const noexcept { return *sampleSources_; }
+
+  /// @returns an empty collection of presets for engines that have nothing loaded
+  static const PresetCollection& noPresets() noexcept;
+
+  SoundFont(const SoundFont&) = delete;
+  SoundFont& operator=(const SoundFont&) = delete;
+
+private:
+  explicit SoundFont(std::unique_ptr<IO::File> file);
+
+  std::unique_ptr<IO::File> file_;
+  PresetCollection presets_{};
+  const SampleSourceCollection* sampleSources_{nullptr};
+};
+
+} // namespace SF2::Render
@@ -2,9 +2,7 @@
 
 #pragma once
 
-#include <os/log.h>
-#include <os/signpost.h>
-#include <AudioToolbox/AudioToolbox.h>
+#include <algorithm>
 #include <vector>
 
 #include "SF2Lib/DSP.hpp"
@@ -49,6 +47,25 @@ public:
    */
   void configure(const NormalizedSampleSource& sampleSource, const State& state) noexcept;
 
+  /**
+   Render a second sample source in step with the configured one, such as the other half of a stereo pair. Both
+   sources are read at the same position, so they must have the same length and loop. NOTE: this must be done after
+   `configure`, which removes any linked source.
+
+   @param sampleSource the samples to render along with the configured ones
+   */
+  void link(const NormalizedSampleSource& sampleSource) noexcept { linkedSource_ = &sampleSource; }
+
+  /// @returns true if a second sample source is rendered along with the configured one
+  bool isLinked() const noexcept { return linkedSource_ != nullptr; }
+
+  /**
+   Change the interpolation to apply to the samples. NOTE: this should only be done before `configure`.
+
+   @param kind the interpolation to apply to the samples
+   */
+  void setInterpolator(Interpolator kind) noexcept { interpolatorProc_ = interpolator(kind); }
+
   /// Begin rendering samples from the generator.
   void start() noexcept { index_.start(); }
 
@@ -68,7 +85,28 @@ public:
     auto whole{index_.whole()};
     auto partial{index_.partial()};
     index_.increment(increment, canLoop);
-    return (this->*interpolatorProc_)(whole, partial, canLoop);
+    return (this->*interpolatorProc_)(*sampleSource_, whole, partial, canLoop);
+  }
+
+  /**
+   Obtain interpolated sample values at the current index from the configured sample source and the linked one.
+
+   @param increment the increment to use to move to the next sample
+   @param canLoop true if the generator is permitted to loop for more samples
+   @param linked the sample value from the linked sample source
+   @returns new sample value from the configured sample source
+   */
+  inline Float generate(Float increment, bool canLoop, Float& linked) noexcept
+  {
+    if (index_.finished()) {
+      linked = 0_F;
+      return 0_F;
+    }
+    auto whole{index_.whole()};
+    auto partial{index_.partial()};
+    index_.increment(increment, canLoop);
+    linked = (this->*interpolatorProc_)(*linkedSource_, whole, partial, canLoop);
+    return (this->*interpolatorProc_)(*sampleSource_, whole, partial, canLoop);
   }
 
   /// @returns true if sill generating samples
@@ -77,8 +115,22 @@ public:
   /// @returns true if generator has looped during rendering.
   bool looped() const noexcept { return index_.looped(); }
 
+  /**
+   Obtain the largest magnitude of the samples that remain to be rendered. Once the generator is looping over the
+   loop defined in the sample header, only the loop samples will ever be rendered.
+
+   @param canLoop true if the generator is permitted to loop
+   @returns largest sample magnitude
+   */
+  Float peak(bool canLoop) const noexcept {
+    auto loop = canLoop && looped() && headerLoop_;
+    auto value = loop ? sampleSource_->loopPeak() : sampleSource_->peak();
+    if (linkedSource_ != nullptr) value = std::max(value, loop ? linkedSource_->loopPeak() : linkedSource_->peak());
+    return value;
+  }
+
 private:
-  using InterpolatorProc = Float (Generator::*)(size_t, Float, bool) const;
+  using InterpolatorProc = Float (Generator::*)(const NormalizedSampleSource&, size_t, Float, bool) const;
 
   inline static InterpolatorProc interpolator(Interpolator kind) noexcept {
     return kind == Interpolator::linear ? &Generator::linearInterpolate : &Generator::cubic4thOrderInterpolate;
@@ -87,43 +139,52 @@ private:
   /**
    Obtain a linearly interpolated sample for a given index value.
 
+   @param source the samples to interpolate
    @param whole the index of the first sample to use
    @param partial the non-integral part of the index
    @param canLoop true if wrapping around in loop is allowed
    @returns interpolated sample result
    */
-  inline Float linearInterpolate(size_t whole, Float partial, bool canLoop) const noexcept {
-    return Float(DSPHeaders::DSP::Interpolation::linear(partial, sample(whole, canLoop), sample(whole + 1, canLoop)));
+  inline Float linearInterpolate(const NormalizedSampleSource& source, size_t whole, Float partial,
+                                 bool canLoop) const noexcept {
+    return Float(DSPHeaders::DSP::Interpolation::linear(partial, sample(source, whole, canLoop),
+                                                        sample(source, whole + 1, canLoop)));
   }
 
   /**
    Obtain a cubic 4th-order interpolated sample for a given index value.
 
+   @param source the samples to interpolate
    @param whole the index of the first sample to use
    @param partial the non-integral part of the index
    @param canLoop true if wrapping around in loop is allowed
    @returns interpolated sample result
    */
-  inline Float cubic4thOrderInterpolate(size_t whole, Float partial, bool canLoop) const noexcept {
-    return Float(DSPHeaders::DSP::Interpolation::cubic4thOrder(partial, before(whole, canLoop), sample(whole, canLoop),
-                                                               sample(whole + 1, canLoop), sample(whole + 2, canLoop)));
+  inline Float cubic4thOrderInterpolate(const NormalizedSampleSource& source, size_t whole, Float partial,
+                                        bool canLoop) const noexcept {
+    return Float(DSPHeaders::DSP::Interpolation::cubic4thOrder(partial, before(source, whole, canLoop),
+                                                               sample(source, whole, canLoop),
+                                                               sample(source, whole + 1, canLoop),
+                                                               sample(source, whole + 2, canLoop)));
   }
 
-  Float sample(size_t whole, bool canLoop) const noexcept {
+  Float sample(const NormalizedSampleSource& source, size_t whole, bool canLoop) const noexcept {
     if (whole == bounds_.endLoopPos() && canLoop) { whole = bounds_.startLoopPos(); }
-    return whole < sampleSource_->size() ? (*sampleSource_)[whole] : 0_F;
+    return whole < source.size() ? source[whole] : 0_F;
   }
 
-  Float before(size_t whole, bool canLoop) const noexcept {
+  Float before(const NormalizedSampleSource& source, size_t whole, bool canLoop) const noexcept {
     if (whole == 0) { return 0_F; }
     if (whole == bounds_.startLoopPos() && canLoop) { whole = bounds_.endLoopPos(); }
-    return (*sampleSource_)[whole - 1];
+    return source[whole - 1];
   }
 
   Bounds bounds_{};
+  bool headerLoop_{false};
   Index index_;
-  const InterpolatorProc interpolatorProc_;
+  InterpolatorProc interpolatorProc_;
   const NormalizedSampleSource* sampleSource_{nullptr};
+  const NormalizedSampleSource* linkedSource_{nullptr};
 };
 
 } // namespace SF2::Render::Sample
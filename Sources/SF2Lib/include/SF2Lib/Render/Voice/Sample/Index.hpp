@@ -12,7 +12,7 @@ namespace SF2::Render::Voice::Sample {
 
 /**
  Interpolatable index into a NormalizedSampleSource. Maintains two counters, an integral one (`size_t`) and a partial
- one (`Float`) that indicates how close the index is to a sample index. These two values are then used by other
+ one (`PhaseFloat`) that indicates how close the index is to a sample index. These two values are then used by other
  routines to fetch the appropriate samples and interpolate over them.
 
  Updates to the index honor loops in the sample stream if allowed. The index can also signal when it has reached the
@@ -37,7 +37,7 @@ public:
   /// Start rendering.
   void start() noexcept {
     whole_ = 0;
-    partial_ = 0_F;
+    partial_ = 0.0;
     looped_ = false;
   }
 
@@ -56,7 +56,7 @@ public:
    @param increment the increment to apply to the internal index
    @param canLoop true if looping is allowed
    */
-  inline void increment(Float increment, bool canLoop) noexcept {
+  inline void increment(PhaseFloat increment, bool canLoop) noexcept {
     if (finished()) return;
 
     auto wholeIncrement{size_t(increment)};
@@ -65,7 +65,7 @@ public:
     whole_ += wholeIncrement;
     partial_ += partialIncrement;
 
-    if (partial_ >= 1_F) {
+    if (partial_ >= 1.0) {
       auto carry{size_t(partial_)};
       whole_ += carry;
       partial_ -= carry;
@@ -84,11 +84,11 @@ public:
   inline size_t whole() const noexcept { return whole_; }
 
   /// @returns normalized position between 2 samples. For instance, 0.5 indicates half-way between two samples.
-  inline Float partial() const noexcept { return partial_; }
+  inline Float partial() const noexcept { return Float(partial_); }
 
 private:
   size_t whole_{0};
-  Float partial_{0_F};
+  PhaseFloat partial_{0.0};
   Bounds bounds_{};
   bool looped_{false};
 };
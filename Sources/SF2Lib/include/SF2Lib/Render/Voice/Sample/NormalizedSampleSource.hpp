@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <span>
 #include <vector>
 
@@ -30,7 +31,9 @@ public:
   NormalizedSampleSource(const SampleVector& allSamples, const Entity::SampleHeader& header) noexcept :
   header_{header},
   span_(std::ranges::next(allSamples.begin(), long(header.startIndex())),
-        std::ranges::next(allSamples.begin(), long(header.endIndex() + sizePaddingAfterEnd)))
+        std::ranges::next(allSamples.begin(), long(header.endIndex() + sizePaddingAfterEnd))),
+  peak_{calculatePeak(allSamples, header.startIndex(), header.endIndex())},
+  loopPeak_{calculatePeak(allSamples, header.startLoopIndex(), header.endLoopIndex())}
   {
   }
 
@@ -50,9 +53,34 @@ public:
   /// @returns the sample header ('shdr') of the sample stream being rendered
   const Entity::SampleHeader& header() const noexcept { return header_; }
 
+  /// @returns the largest magnitude of all of the samples
+  Float peak() const noexcept { return peak_; }
+
+  /// @returns the largest magnitude of the samples in the loop defined by the sample header
+  Float loopPeak() const noexcept { return loopPeak_; }
+
 private:
+
+  /**
+   Calculate the largest magnitude in a range of samples. If the range is not valid, returns 1.0 which is the largest
+   value a normalized sample can have.
+
+   @param allSamples collection of normalized samples in the SF2 file
+   @param begin the index of the first sample to examine
+   @param end the index after the last sample to examine
+   @returns the largest magnitude
+   */
+  static Float calculatePeak(const SampleVector& allSamples, size_t begin, size_t end) noexcept {
+    if (begin >= end || end > allSamples.size()) return 1_F;
+    Float peak{0_F};
+    Accelerated<Float>::magnitudeProc(allSamples.data() + begin, 1, &peak, end - begin);
+    return std::min(peak, 1_F);
+  }
+
   const Entity::SampleHeader& header_;
   const std::span<const Float> span_;
+  const Float peak_;
+  const Float loopPeak_;
 };
 
 } // namespace SF2::Render::Sample::Source
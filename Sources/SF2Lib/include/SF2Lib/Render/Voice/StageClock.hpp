@@ -0,0 +1,122 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "SF2Lib/Utils/CycleCounter.hpp"
+
+namespace SF2::Render::Voice {
+
+/// The stages of the voice rendering pipeline that are timed in a profiling build.
+enum struct Stage {
+  /// Update of the LFOs and envelopes
+  modulation = 0,
+  /// Calculation of the sample phase increment from the pitch
+  pitch,
+  /// Fetching and interpolating samples
+  sample,
+  /// Calculation of the gain to apply to a sample
+  gain,
+  /// Low-pass filter update and processing
+  filter,
+  /// Panning and mixing into the output busses
+  mix
+};
+
+/// The number of entries in the `Stage` enum
+static inline constexpr size_t stageCount = 6;
+
+/**
+ @param stage the stage to look up
+ @returns name of the stage
+ */
+inline const char* stageName(Stage stage) noexcept
+{
+  switch (stage) {
+    case Stage::modulation: return "modulation";
+    case Stage::pitch: return "pitch";
+    case Stage::sample: return "sample";
+    case Stage::gain: return "gain";
+    case Stage::filter: return "filter";
+    case Stage::mix: return "mix";
+  }
+  return "unknown";
+}
+
+/**
+ Attributes the time spent rendering a voice to the stages of its pipeline. The time between successive calls to
+ `lap` is added to the stage given to `lap`. Times are in `Utils::cycleCount` ticks.
+
+ Only active when built with SF2_VOICE_PROFILING=1. Otherwise all of the methods do nothing and the compiler removes
+ them from the render path.
+ */
+class StageClock
+{
+public:
+  /// True if the clock is measuring
+#if SF2_VOICE_PROFILING == 1
+  static inline constexpr bool enabled = true;
+#else
+  static inline constexpr bool enabled = false;
+#endif
+
+  using Ticks = std::array<uint64_t, stageCount>;
+
+  /// Start timing the next stage.
+  inline void mark() noexcept {
+    if constexpr (enabled) last_ = Utils::cycleCount();
+  }
+
+  /**
+   Add the time since the last `mark` or `lap` to the given stage and start timing the next stage.
+
+   @param stage the stage that just finished
+   */
+  inline void lap(Stage stage) noexcept {
+    if constexpr (enabled) {
+      auto now = Utils::cycleCount();
+      ticks_[size_t(stage)] += now - last_;
+      last_ = now;
+    }
+  }
+
+  /**
+   Add a measured time to a stage.
+
+   @param stage the stage to update
+   @param ticks the amount of time to add
+   */
+  inline void add(Stage stage, uint64_t ticks) noexcept {
+    if constexpr (enabled) ticks_[size_t(stage)] += ticks;
+  }
+
+  /**
+   Record the number of samples rendered.
+
+   @param count the number of samples
+   */
+  inline void addSamples(uint64_t count) noexcept {
+    if constexpr (enabled) samples_ += count;
+  }
+
+  /// @returns the time spent in each stage since the last `clear`
+  const Ticks& ticks() const noexcept { return ticks_; }
+
+  /// @returns the number of samples rendered since the last `clear`
+  uint64_t samples() const noexcept { return samples_; }
+
+  /// Forget all measurements.
+  void clear() noexcept {
+    ticks_.fill(0);
+    samples_ = 0;
+  }
+
+private:
+  uint64_t last_{0};
+  Ticks ticks_{};
+  uint64_t samples_{0};
+};
+
+} // end namespace SF2::Render::Voice
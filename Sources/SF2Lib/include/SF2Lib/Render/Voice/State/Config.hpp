@@ -46,6 +46,9 @@ public:
   /// @returns original MIDI velocity that triggered the voice
   int eventVelocity() const noexcept { return eventVelocity_; }
 
+  /// @returns the instrument zone that matched the key/velocity search
+  const Zone::Instrument& instrument() const noexcept { return instrument_; }
+
   /// @returns value of `exclusiveClass` generator for an instrument if it is set, or 0 if not found.
   int exclusiveClass() const noexcept { return exclusiveClass_; }
 
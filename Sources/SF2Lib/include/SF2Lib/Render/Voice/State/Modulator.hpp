@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <bitset>
 #include <iostream>
 
 #include "SF2Lib/Entity/Modulator/Modulator.hpp"
@@ -15,6 +16,34 @@ namespace SF2::Render::Voice::State {
 
 class State;
 
+/**
+ Identifies where a modulator obtains a value from. The first 128 values map directly to the MIDI continuous
+ controllers so that a CC index can be used as-is.
+ */
+enum struct SourceId : uint8_t {
+  firstContinuousController = 0,
+  lastContinuousController = 127,
+  none,
+  noteOnKey,
+  noteOnVelocity,
+  keyPressure,
+  channelPressure,
+  pitchWheel,
+  pitchWheelSensitivity,
+  numValues
+};
+
+/// Set of SourceId values, used to quickly determine if a modulator or voice depends on a changed value.
+using SourceIdSet = std::bitset<static_cast<size_t>(SourceId::numValues)>;
+
+/**
+ Obtain the SourceId that corresponds to a MIDI continuous controller.
+
+ @param cc the controller to convert
+ @returns SourceId value
+ */
+inline SourceId sourceIdFor(MIDI::ControlChange cc) noexcept { return SourceId(SF2::valueOf(cc) & 0x7F); }
+
 /**
  Render-side modulator that understands how to fetch source values that will be used to modulate voice state. Per the
  SF2 spec, a modulator does the following:
@@ -63,47 +92,54 @@ public:
   const Entity::Modulator::Modulator& configuration() const noexcept { return configuration_; }
 
   /// @returns the generator index that this modulator affects.
-  Entity::Generator::Index destination() const noexcept { return configuration_.generatorDestination(); }
+  Entity::Generator::Index destination() const noexcept { return destination_; }
+
+  /// @returns the set of sources that the modulator obtains values from
+  SourceIdSet sources() const noexcept {
+    SourceIdSet sources;
+    if (primarySource_ != SourceId::none) sources.set(static_cast<size_t>(primarySource_));
+    if (secondarySource_ != SourceId::none) sources.set(static_cast<size_t>(secondarySource_));
+    return sources;
+  }
+
+  /**
+   Determine if the modulator obtains a value from the given source.
+
+   @param source the source to check
+   @returns true if so
+   */
+  bool dependsOn(SourceId source) const noexcept { return primarySource_ == source || secondarySource_ == source; }
 
   /// @returns a textual description of the modulator.
   std::string description() const noexcept;
 
 private:
 
-  // Holds a pointer to member function that determines how to generate a value for a modulator.
-  struct ValueProvider {
-    using Proc = int (ValueProvider::*)(const State&) const;
-
-    Proc proc_{nullptr};
-    const MIDI::ControlChange cc_{0};
-
-    bool isActive() const noexcept { return proc_ != nullptr; }
-    int operator()(const State& state) const noexcept { return (this->*proc_)(state); }
-
-    int ccValue(const State&) const noexcept;
-    int noteOnKey(const State&) const noexcept;
-    int noteOnVelocity(const State&) const noexcept;
-    int keyPressure(const State&) const noexcept;
-    int channelPressure(const State&) const noexcept;
-    int pitchWheelValue(const State&) const noexcept;
-    int pitchWheelSensitivity(const State&) const noexcept;
-  };
-
   /**
-   Obtain a generic callable entity that returns an integral value. This is used to obtain both the `source` and
+   Obtain the SourceId to use for a given modulator source definition. This is used to obtain both the `source` and
    `amount` values, regardless of their actual source.
 
    @param source the modulator source definition from the SF2 file
-   @returns ValueProvider instance for obtaining the value
+   @returns SourceId value for obtaining the value
+   */
+  static SourceId makeSourceId(const Entity::Modulator::Source& source) noexcept;
+
+  /**
+   Fetch the current raw value from the given source.
+
+   @param source the source to read from
+   @param state the voice state to use for voice-specific values
+   @returns integral source value
    */
-  static ValueProvider makeValueProvider(const Entity::Modulator::Source& source) noexcept;
+  static int fetch(SourceId source, const State& state) noexcept;
 
   const Entity::Modulator::Modulator& configuration_;
   int amount_;
+  Entity::Generator::Index destination_;
 
-  const ValueProvider primaryValue_;
+  SourceId primarySource_;
+  SourceId secondarySource_;
   const MIDI::ValueTransformer primaryTransform_;
-  const ValueProvider secondaryValue_;
   const MIDI::ValueTransformer secondaryTransform_;
 };
 
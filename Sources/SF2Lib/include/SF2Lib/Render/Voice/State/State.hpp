@@ -49,7 +49,7 @@ public:
    @param channelState the MIDI channel that is in control
    */
   State(Float sampleRate, const MIDI::ChannelState& channelState) noexcept :
-  sampleRate_{sampleRate}, eventKey_{}, eventVelocity_{}, channelState_{channelState}
+  sampleRate_{sampleRate}, eventKey_{}, eventVelocity_{}, channelState_{&channelState}
   {
     clear();
   }
@@ -63,7 +63,7 @@ public:
    @param velocity the MIDI velocity to use
    */
   State(Float sampleRate, const MIDI::ChannelState& channelState, int key, int velocity = 64) noexcept :
-  sampleRate_{sampleRate}, eventKey_{key}, eventVelocity_{velocity}, channelState_{channelState}
+  sampleRate_{sampleRate}, eventKey_{key}, eventVelocity_{velocity}, channelState_{&channelState}
   {
     clear();
   }
@@ -147,7 +147,15 @@ public:
   }
 
   /// @returns the MIDI channel state associated with the rendering
-  const MIDI::ChannelState& channelState() const noexcept { return channelState_; }
+  const MIDI::ChannelState& channelState() const noexcept { return *channelState_; }
+
+  /**
+   Change the MIDI channel state that provides values to modulators. Used by a multi-timbral engine to bind a voice
+   to the channel that started it. Must be called before `prepareForVoice`.
+
+   @param channelState the MIDI channel state to use
+   */
+  void setChannelState(const MIDI::ChannelState& channelState) noexcept { channelState_ = &channelState; }
 
   /// @returns sample rate defined at construction
   Float sampleRate() const noexcept { return sampleRate_; }
@@ -155,6 +163,23 @@ public:
   /// Update the modulator values due to a change in the channel state.
   void updateStateMods() noexcept;
 
+  /**
+   Update the modulator values due to a change in one specific source value. Only the generators that are the
+   destination of a modulator that depends on the source are recalculated. This is much cheaper than a full update
+   when a continuous controller changes.
+
+   @param source the source value that changed
+   */
+  void updateStateMods(SourceId source) noexcept;
+
+  /**
+   Determine if any modulator in the state depends on the given source.
+
+   @param source the source to check
+   @returns true if so
+   */
+  bool dependsOn(SourceId source) const noexcept { return sources_.test(static_cast<size_t>(source)); }
+
   /// @returns number of unique attached modulators
   size_t modulatorCount() const noexcept { return modulators_.size(); }
 
@@ -194,11 +219,12 @@ private:
 
   Entity::Generator::GeneratorValueArray<GenValue> gens_;
   std::vector<Modulator> modulators_;
+  SourceIdSet sources_{};
 
   Float sampleRate_;
   int eventKey_;
   int eventVelocity_;
-  const MIDI::ChannelState& channelState_;
+  const MIDI::ChannelState* channelState_;
 };
 
 } // namespace SF2::Render
@@ -3,6 +3,7 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 
 #include "SF2Lib/MIDI/ChannelState.hpp"
 #include "SF2Lib/Render/Engine/Mixer.hpp"
@@ -11,6 +12,7 @@
 #include "SF2Lib/Render/LFO.hpp"
 #include "SF2Lib/Render/LowPassFilter.hpp"
 #include "SF2Lib/Render/Voice/Sample/Generator.hpp"
+#include "SF2Lib/Render/Voice/StageClock.hpp"
 #include "SF2Lib/Render/Voice/State/Modulator.hpp"
 #include "SF2Lib/Render/Voice/State/State.hpp"
 
@@ -28,6 +30,9 @@ class Voice
 public:
   using Index = Entity::Generator::Index;
 
+  /// Number of frames over which to move to new pan gains
+  static inline constexpr SF2::AUAudioFrameCount panRampFrameCount = 32;
+
   /**
    These are values for the sampleModes (#54) generator.
 
@@ -63,6 +68,7 @@ public:
   void setSampleRate(Float sampleRate) noexcept {
     state_.setSampleRate(sampleRate);
     filter_.setSampleRate(sampleRate);
+    linkedFilter_.setSampleRate(sampleRate);
   }
 
   /// @returns the unique index assigned to this voice instance.
@@ -78,6 +84,20 @@ public:
    */
   void configure(const State::Config& config) noexcept;
 
+  /**
+   Render the other half of a stereo sample pair along with the configured sample. Per SF2 7.10, the two halves play
+   in sync with their pitch controlled by one set of generators, so both sample streams are driven by the pitch,
+   envelopes and LFOs of this voice. Only the initial attenuation and pan of the other half are kept. Must be called
+   after `configure` and before `start`.
+
+   @param sampleSource the samples of the other half of the stereo pair
+   @param partnerState the state configured for the other half of the stereo pair
+   */
+  void link(const Sample::NormalizedSampleSource& sampleSource, const State::State& partnerState) noexcept;
+
+  /// @returns true if the voice renders both halves of a stereo sample pair
+  bool isLinked() const noexcept { return linked_; }
+
   /**
    Start voice rendering. This initializes the envelopes and other internal state using the based on the configured
    generators set up in the `configure` call.
@@ -91,6 +111,44 @@ public:
     active_ = false;
   }
 
+  /**
+   Begin a short fade-out of the voice. Used when a voice is stolen to make room for a new note so that there is no
+   audible click due to an abrupt stop. The voice will stop on its own once the fade-out completes.
+
+   @param durationSamples the number of samples over which to fade out
+   */
+  void fadeOut(size_t durationSamples) noexcept {
+    if (!active_ || fadeOutRemaining_ > 0) return;
+    fadeOutRemaining_ = std::max<size_t>(durationSamples, 1);
+    fadeOutScale_ = 1_F / Float(fadeOutRemaining_);
+    keyDown_ = false;
+  }
+
+  /// @returns true if this voice is fading out after being stolen
+  bool isFadingOut() const noexcept { return fadeOutRemaining_ > 0; }
+
+  /// @returns true if this voice is in the release stage of its volume envelope
+  bool isReleasing() const noexcept { return volumeEnvelope_.isRelease(); }
+
+  /// @returns the most recent gain (volume envelope and attenuation) applied to a sample by the voice
+  Float level() const noexcept { return level_; }
+
+  /**
+   Set the threshold used to stop a voice in its release stage. A voice stops once its predicted output -- the peak
+   magnitude of the sample being rendered multiplied by the current gain and pan -- falls below this value. A value
+   of zero disables the check.
+
+   @param threshold the minimum predicted output to keep rendering
+   */
+  void setCullThreshold(Float threshold) noexcept { cullThreshold_ = threshold; }
+
+  /**
+   Set the interpolation to use for the next note that the voice renders.
+
+   @param interpolator the interpolation to use
+   */
+  void setInterpolator(Sample::Interpolator interpolator) noexcept { sampleGenerator_.setInterpolator(interpolator); }
+
   /// @returns true if this voice is still rendering interesting samples
   bool isActive() const noexcept { return active_; }
 
@@ -100,9 +158,27 @@ public:
   /// @returns true if this voice is done processing and will no longer render meaningful samples.
   bool isDone() const noexcept { return !isActive(); }
 
+  /// @returns true if this voice stopped because its release fell below the noise floor or the cull threshold
+  bool wasCulled() const noexcept { return culled_; }
+
   /// @returns the MIDI key that started the voice. NOTE: not to be used for DSP processing.
   int initiatingKey() const noexcept { return state_.eventKey(); }
 
+  /// @returns the MIDI channel that started the voice.
+  size_t channel() const noexcept { return channel_; }
+
+  /**
+   Bind the voice to a MIDI channel. The channel's state will provide the values for the voice's modulators. This must
+   be done before `configure` is called.
+
+   @param channel the MIDI channel that is starting the voice
+   @param channelState the state of the MIDI channel
+   */
+  void assignChannel(size_t channel, const MIDI::ChannelState& channelState) noexcept {
+    channel_ = channel;
+    state_.setChannelState(channelState);
+  }
+
   /**
    Engine state that governs how a voice will react to a key release event.
    */
@@ -146,11 +222,224 @@ public:
    Vol Env ---------------------+
    ```
 
-   Note that in this routine, panning and effects are not performed.
+   Note that in this routine, panning and effects are not performed. For a voice that renders a stereo pair, only the
+   samples of the configured half are returned; use `renderBlock` to obtain both.
 
    @returns next sample
    */
   inline Float renderSample() noexcept {
+    Float linked;
+    stageClock_.mark();
+    return generate<true, false>(linked);
+  }
+
+  /**
+   Prepare for rendering samples via `renderBlock` or `renderUnfilteredBlock`. Obtains the effect send levels and pan
+   gains to use while mixing.
+   */
+  inline void prepareToRender() noexcept {
+    chorusSend_ = SF2::AUValue(DSP::tenthPercentageToNormalized(state_.modulated(Index::chorusEffectSend)));
+    reverbSend_ = SF2::AUValue(DSP::tenthPercentageToNormalized(state_.modulated(Index::reverbEffectSend)));
+    updatePanGains();
+  }
+
+  /**
+   Render filtered samples into the voice's scratch blocks.
+
+   @param frameCount the number of samples to render (must be <= `Engine::Mixer::blockSize`)
+   @returns the number of samples rendered, which is less than `frameCount` if the voice stopped
+   */
+  inline SF2::AUAudioFrameCount renderBlock(SF2::AUAudioFrameCount frameCount) noexcept {
+    return generateBlock<true>(frameCount);
+  }
+
+  /**
+   Render samples into the voice's scratch block without applying the low-pass filter. The filter settings are
+   updated at the start of the block so that the filter can be applied to the whole block afterwards, as done by
+   `FilterBank`.
+
+   @param frameCount the number of samples to render (must be <= `Engine::Mixer::blockSize`)
+   @returns the number of samples rendered, which is less than `frameCount` if the voice stopped
+   */
+  inline SF2::AUAudioFrameCount renderUnfilteredBlock(SF2::AUAudioFrameCount frameCount) noexcept {
+    static_assert(Engine::Mixer::blockSize <= LowPassFilter::controlInterval);
+    filter_.alignUpdate();
+    return generateBlock<false>(frameCount);
+  }
+
+  /**
+   Mix the samples in the voice's scratch block into the output busses.
+
+   @param mixer collection of buffers to mix into
+   @param frame the offset of the first frame to update
+   @param frameCount the number of samples in the scratch block
+   */
+  inline void mixBlock(Engine::Mixer& mixer, SF2::AUAudioFrameCount frame,
+                       SF2::AUAudioFrameCount frameCount) noexcept {
+    stageClock_.mark();
+    pan_.mix(mixer, frame, samples_.data(), frameCount, chorusSend_, reverbSend_);
+    if (linked_) linkedPan_.mix(mixer, frame, linkedSamples_.data(), frameCount, chorusSend_, reverbSend_);
+    stageClock_.lap(Stage::mix);
+  }
+
+  /// @returns the samples in the voice's scratch block
+  Float* block() noexcept { return samples_.data(); }
+
+  /// @returns the samples of the other half of a stereo pair in the voice's scratch block
+  Float* linkedBlock() noexcept { return linkedSamples_.data(); }
+
+  /// @returns the low-pass filter of the voice
+  LowPassFilter& filter() noexcept { return filter_; }
+
+  /// @returns the low-pass filter for the other half of a stereo pair
+  LowPassFilter& linkedFilter() noexcept { return linkedFilter_; }
+
+  /// @returns the time spent in each rendering stage (only measured when built with SF2_VOICE_PROFILING=1)
+  StageClock& stageClock() noexcept { return stageClock_; }
+
+  /**
+   Invoke `renderSample` up to `frameCount` times, mixing the results into the output busses one block at a time.
+
+   @param mixer collection of buffers to mix into
+   @param frameCount number of samples to render
+   */
+  void renderInto(Engine::Mixer& mixer, SF2::AUAudioFrameCount frameCount) noexcept {
+    prepareToRender();
+
+    // Render into the scratch block and then let the mixer pan and accumulate the whole block at once. Nothing is
+    // written for the frames that follow the end of the voice.
+    for (SF2::AUAudioFrameCount index = 0; index < frameCount && active_; ) {
+      auto rendered = renderBlock(std::min(frameCount - index, Engine::Mixer::blockSize));
+      mixBlock(mixer, index, rendered);
+      index += rendered;
+    }
+  }
+
+  /// @returns `State` instance for the voice.
+  State::State& state() noexcept { return state_; }
+
+  /// Notification to recalculate the mods for the voice due to a change in MIDI state.
+  void channelStateChanged() noexcept { state_.updateStateMods(); }
+
+  /**
+   Notification to recalculate the mods for the voice due to a change in one MIDI value. Does nothing if the voice
+   does not have a modulator that depends on the value.
+
+   @param source the source that changed
+   */
+  void channelStateChanged(State::SourceId source) noexcept { state_.updateStateMods(source); }
+
+  /// Flag the voice as being affected by the sostenuto pedal.
+  void useSostenuto() noexcept { sostenutoActive_ = true; }
+
+  /// @returns true if the key was released while a pedal held the voice
+  bool isReleasePostponed() const noexcept { return postponedRelease_; }
+
+private:
+
+  /**
+   Pan gains for one sample stream of the voice. When the gains change, they move to the new values over
+   `panRampFrameCount` frames to keep from generating clicks.
+   */
+  struct PanRamp {
+
+    /**
+     Obtain the gains for the given pan value, starting a ramp if they changed.
+
+     @param pan the pan value to use
+     @returns the larger of the left and right gains
+     */
+    Float update(Float pan) noexcept {
+      Float left, right;
+      DSP::panLookup(pan, left, right);
+      if (!valid) {
+        leftGain = leftTarget = left;
+        rightGain = rightTarget = right;
+        remaining = 0;
+        valid = true;
+      } else if (left != leftTarget || right != rightTarget) {
+        leftTarget = left;
+        rightTarget = right;
+        leftStep = (left - leftGain) / panRampFrameCount;
+        rightStep = (right - rightGain) / panRampFrameCount;
+        remaining = panRampFrameCount;
+      }
+      return std::max(left, right);
+    }
+
+    /**
+     Mix samples into the output busses using the current gains.
+
+     @param mixer collection of buffers to mix into
+     @param frame the offset of the first frame to update
+     @param samples the samples to mix
+     @param frameCount the number of samples to mix
+     @param chorusSend the amount of the samples to send to the chorus bus
+     @param reverbSend the amount of the samples to send to the reverb bus
+     */
+    void mix(Engine::Mixer& mixer, SF2::AUAudioFrameCount frame, const Float* samples,
+             SF2::AUAudioFrameCount frameCount, SF2::AUValue chorusSend, SF2::AUValue reverbSend) noexcept {
+      auto ramp = std::min(remaining, frameCount);
+      if (ramp > 0) {
+        mixer.addRamped(frame, samples, ramp, leftGain, rightGain, leftStep, rightStep, chorusSend, reverbSend);
+        remaining -= ramp;
+        if (remaining == 0) {
+          leftGain = leftTarget;
+          rightGain = rightTarget;
+        } else {
+          leftGain += leftStep * ramp;
+          rightGain += rightStep * ramp;
+        }
+      }
+
+      mixer.add(frame + ramp, samples + ramp, frameCount - ramp, leftGain, rightGain, chorusSend, reverbSend);
+    }
+
+    Float leftGain{0_F};
+    Float rightGain{0_F};
+    Float leftTarget{0_F};
+    Float rightTarget{0_F};
+    Float leftStep{0_F};
+    Float rightStep{0_F};
+    SF2::AUAudioFrameCount remaining{0};
+    bool valid{false};
+  };
+
+  /**
+   Generate samples into the voice's scratch blocks.
+
+   @param Filtered if true, apply the low-pass filter to the samples
+   @param frameCount the number of samples to render
+   @returns the number of samples rendered, which is less than `frameCount` if the voice stopped
+   */
+  template <bool Filtered>
+  inline SF2::AUAudioFrameCount generateBlock(SF2::AUAudioFrameCount frameCount) noexcept {
+    SF2::AUAudioFrameCount rendered = 0;
+    stageClock_.mark();
+    if (linked_) {
+      for (; rendered < frameCount && active_; ++rendered) {
+        samples_[rendered] = generate<Filtered, true>(linkedSamples_[rendered]);
+      }
+    } else {
+      for (; rendered < frameCount && active_; ++rendered) {
+        samples_[rendered] = generate<Filtered, false>(linkedSamples_[rendered]);
+      }
+    }
+    stageClock_.addSamples(rendered);
+    return rendered;
+  }
+
+  /**
+   Generate the next sample.
+
+   @param Filtered if true, apply the low-pass filter to the sample
+   @param Linked if true, also generate the sample of the other half of a stereo pair
+   @param linkedOutput holds the sample of the other half of a stereo pair (only set when `Linked` is true)
+   @returns next sample
+   */
+  template <bool Filtered, bool Linked>
+  inline Float generate([[maybe_unused]] Float& linkedOutput) noexcept {
+    if constexpr (Linked) linkedOutput = 0_F;
     if (! active_) { return 0_F; }
 
     // Capture the current state of the modulators and envelopes and advance them to the next sample.
@@ -158,17 +447,26 @@ public:
     auto vibLFO{vibratoLFO_.getNextValue()};
     auto modEnv{modulatorEnvelope_.getNextValue()};
     auto volEnv{volumeEnvelope_.getNextValue()};
+    stageClock_.lap(Stage::modulation);
 
     if (volumeEnvelope_.isDelayed()) return 0_F;
 
     // Calculate the pitch to render and then generate a new sample.
     //
     // NOTE: according the SF2 7.10, linked L/R voices should "be played entirely synchronously, with their pitch
-    // controlled by the right sample's generators. All non-pitch generators should apply as normal". We do not do
-    // this, and I'm not entirely sure how to do it given that modLFO and modEnv do not just affect pitch. It seems to
-    // make sense to have common LFOs and envelopes for stereo voices.
+    // controlled by the right sample's generators. All non-pitch generators should apply as normal". When the engine
+    // links a stereo pair, one voice renders both halves with common LFOs and envelopes, and only the attenuation and
+    // pan of the other half apply as normal.
     auto increment{pitch_.samplePhaseIncrement(modLFO, vibLFO, modEnv)};
-    auto sample{sampleGenerator_.generate(increment, canLoop())};
+    stageClock_.lap(Stage::pitch);
+    Float sample;
+    [[maybe_unused]] Float linkedSample;
+    if constexpr (Linked) {
+      sample = sampleGenerator_.generate(increment, canLoop(), linkedSample);
+    } else {
+      sample = sampleGenerator_.generate(increment, canLoop());
+    }
+    stageClock_.lap(Stage::sample);
 
     // Calculate gain / attenuation to apply to sample. Here we are deviating from FluidSynth: it treats the
     // attack stage of the volume envelope as special and just a linear ramp from 0.0 - 1.0. The other stages are
@@ -181,59 +479,70 @@ public:
     auto modLFOValCB{modLFO.val * -state_.modulated(Index::modulatorLFOToVolume)};
     auto gain{initialAttenuation_ * DSP::centibelsToAttenuation(modLFOValCB + volEnvCB)};
 
-    // FIXME: disable low-pass filter until settings are properly calculated
+    // Apply a linear ramp to zero if the voice was stolen.
+    if (fadeOutRemaining_ > 0) [[unlikely]] {
+      gain *= Float(fadeOutRemaining_) * fadeOutScale_;
+      if (--fadeOutRemaining_ == 0) stop();
+    }
+    level_ = gain;
+    stageClock_.lap(Stage::gain);
+
 #if ENABLE_LOWPASS_FILTER == 1
-    // Calculate the low-pass filter parameters. Only the frequency can be affected by an LFO or mod envelope, but both
-    // can have external modulators attached to their primary state value.
-    auto frequency{(state_.modulated(Index::initialFilterCutoff) +
-                    state_.modulated(Index::modulatorLFOToFilterCutoff) * modLFO.val +
-                    state_.modulated(Index::modulatorEnvelopeToFilterCutoff) * modEnv.val)};
-    auto resonance{state_.modulated(Index::initialFilterResonance)};
-    auto filtered{filter_.transform(frequency, resonance, sample * gain)};
+    // Calculate the low-pass filter parameters at control rate. Only the frequency can be affected by an LFO or mod
+    // envelope, but both can have external modulators attached to their primary state value.
+    if (filter_.updateDue()) {
+      auto frequency{(state_.modulated(Index::initialFilterCutoff) +
+                      state_.modulated(Index::modulatorLFOToFilterCutoff) * modLFO.val +
+                      state_.modulated(Index::modulatorEnvelopeToFilterCutoff) * modEnv.val)};
+      auto resonance{state_.modulated(Index::initialFilterResonance)};
+      filter_.update(frequency, resonance);
+      if constexpr (Linked) linkedFilter_.update(frequency, resonance);
+    }
+    Float output;
+    if constexpr (Filtered) {
+      output = filter_.transform(sample * gain);
+      if constexpr (Linked) linkedOutput = linkedFilter_.transform(linkedSample * gain * linkedGainRatio_);
+    } else {
+      output = sample * gain;
+      if constexpr (Linked) linkedOutput = linkedSample * gain * linkedGainRatio_;
+    }
+    stageClock_.lap(Stage::filter);
+#else
+    auto output{sample * gain};
+    if constexpr (Linked) linkedOutput = linkedSample * gain * linkedGainRatio_;
 #endif
 
-    if (!sampleGenerator_.isActive() ||
-        !volumeEnvelope_.isActive() ||
-        (volumeEnvelope_.isRelease() && gain < DSP::NoiseFloor)) {
+    if (!sampleGenerator_.isActive() || !volumeEnvelope_.isActive()) {
+      stop();
+    } else if (volumeEnvelope_.isRelease() && (gain < DSP::NoiseFloor || isInaudible(gain))) {
+      culled_ = true;
       stop();
     }
+    stageClock_.lap(Stage::gain);
 
-    return sample * gain; // filtered;
+    return output;
   }
 
   /**
-   Repeatedly invoke `renderSample` `frameCount` times.
-
-   @param mixer collection of buffers to mix into
-   @param frameCount number of samples to render
+   Obtain the pan gains for the current modulated pan value. The gains are only looked up once per render call since
+   the pan value only changes due to MIDI or parameter events.
    */
-  void renderInto(Engine::Mixer& mixer, SF2::AUAudioFrameCount frameCount) noexcept {
-    SF2::AUAudioFrameCount index = 0;
-    SF2::AUValue chorusSend = SF2::AUValue(DSP::tenthPercentageToNormalized(state_.modulated(Index::chorusEffectSend)));
-    SF2::AUValue reverbSend = SF2::AUValue(DSP::tenthPercentageToNormalized(state_.modulated(Index::reverbEffectSend)));
-    for (; index < frameCount && active_; ++index) {
-      Float sample{renderSample()};
-      Float pan{state_.modulated(Index::pan)};
-      Float leftPan, rightPan;
-      DSP::panLookup(pan, leftPan, rightPan);
-      mixer.add(index, SF2::AUValue(leftPan * sample), SF2::AUValue(rightPan * sample), chorusSend, reverbSend);
-    }
-
-    for (; index < frameCount; ++index) {
-      mixer.add(index, 0_F, 0_F, chorusSend, reverbSend);
-    }
+  inline void updatePanGains() noexcept {
+    auto pan{state_.modulated(Index::pan)};
+    panPeak_ = pan_.update(pan);
+    if (linked_) panPeak_ = std::max(panPeak_, linkedPan_.update(pan + linkedPanOffset_) * linkedGainRatio_);
   }
 
-  /// @returns `State` instance for the voice.
-  State::State& state() noexcept { return state_; }
-
-  /// Notification to recalculate the mods for the voice due to a change in MIDI state.
-  void channelStateChanged() noexcept { state_.updateStateMods(); }
+  /**
+   Determine if the voice output would be below the cull threshold.
 
-  /// Flag the voice as being affected by the sostenuto pedal.
-  void useSostenuto() noexcept { sostenutoActive_ = true; }
+   @param gain the current gain being applied to samples
+   @returns true if the voice is no longer audible
+   */
+  inline bool isInaudible(Float gain) const noexcept {
+    return cullThreshold_ > 0_F && gain * panPeak_ * sampleGenerator_.peak(canLoop()) < cullThreshold_;
+  }
 
-private:
   State::State state_;
   LoopingMode loopingMode_;
   Sample::Pitch pitch_;
@@ -243,17 +552,33 @@ private:
   ModLFO modulatorLFO_;
   VibLFO vibratoLFO_;
   LowPassFilter filter_;
+  LowPassFilter linkedFilter_;
   Float initialAttenuation_{1_F};
+  Float level_{0_F};
+  Float panPeak_{1_F};
+  alignas(16) std::array<Float, Engine::Mixer::blockSize> samples_;
+  alignas(16) std::array<Float, Engine::Mixer::blockSize> linkedSamples_;
+  SF2::AUValue chorusSend_{0_F};
+  SF2::AUValue reverbSend_{0_F};
+  PanRamp pan_{};
+  PanRamp linkedPan_{};
+  Float linkedAttenuation_{0_F};
+  Float linkedGainRatio_{0_F};
+  Float linkedPanOffset_{0_F};
+  Float cullThreshold_{0_F};
+  StageClock stageClock_{};
+  Float fadeOutScale_{0_F};
+  size_t fadeOutRemaining_{0};
 
   bool active_{false};
+  bool linked_{false};
+  bool culled_{false};
   bool keyDown_{false};
   bool postponedRelease_{false};
   bool sostenutoActive_{false};
 
   const size_t voiceIndex_;
-  const os_log_t log_{os_log_create("SF2Lib", "Voice")};
-  const os_signpost_id_t configSignpost_{os_signpost_id_generate(log_)};
-  const os_signpost_id_t startSignpost_{os_signpost_id_generate(log_)};
+  size_t channel_{0};
 };
 
 } // namespace SF2::Render::Voice
@@ -0,0 +1,127 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "SF2Lib/Trace/Event.hpp"
+#include "SF2Lib/Trace/RingBuffer.hpp"
+
+namespace SF2::Trace {
+
+/**
+ Gathers trace events from any number of threads. Each thread that records an event is given its own ring buffer the
+ first time it does so, which makes recording lock-free and free of memory allocation: all of the buffers are allocated
+ when the collector is created. A background thread (or explicit calls to `drain`) moves the events out of the buffers
+ and into a list that can then be exported with `writeChromeTrace` or `writeTextLog`.
+
+ A thread gives its buffer back when it exits. The next drain moves out whatever the thread left in it before the
+ buffer is used by another thread, so short-lived threads do not use up the buffers.
+
+ If there are more recording threads at once than buffers, or if a buffer fills up before it is drained, events are
+ dropped rather than blocking the thread that records them. The `dropped` method reports how many were lost.
+ */
+class Collector
+{
+public:
+  /// Maximum number of threads that can record events at the same time.
+  static constexpr size_t maxThreadCount = 16;
+  /// Number of events each thread can record between drains.
+  static constexpr size_t eventsPerThread = 4096;
+
+  using Buffer = RingBuffer<Event, eventsPerThread>;
+  using Clock = std::chrono::steady_clock;
+
+  /// @returns the collector used by the `SF2::Trace` recording functions.
+  static Collector& shared() noexcept;
+
+  /// Constructor. Allocates all of the per-thread buffers.
+  Collector() noexcept;
+
+  /// Destructor. Stops the background thread if it is running.
+  ~Collector() noexcept;
+
+  Collector(const Collector&) = delete;
+  Collector& operator=(const Collector&) = delete;
+
+  /**
+   Record an event for the current thread. Safe to call from a real-time thread.
+
+   @param kind the kind of event to record
+   @param id the identifier of the event
+   @param arg0 first event-specific value
+   @param arg1 second event-specific value
+   @returns true if recorded, false if dropped
+   */
+  bool record(Kind kind, Id id, int32_t arg0 = 0, int32_t arg1 = 0) noexcept
+  {
+    auto buffer = threadBuffer();
+    if (buffer == nullptr) {
+      unbuffered_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    return buffer->push(Event{uint64_t(timestamp), arg0, arg1, id, kind, uint8_t(buffer - buffers_)});
+  }
+
+  /**
+   Move pending events out of the per-thread buffers and into the list of collected events. Only one thread may drain
+   at a time, which is guaranteed when the background thread is the only caller.
+
+   @returns number of events moved
+   */
+  size_t drain() noexcept;
+
+  /**
+   Start a background thread that drains the per-thread buffers at a regular interval. Does nothing if already running.
+
+   @param interval the time between drains
+   */
+  void start(std::chrono::milliseconds interval = std::chrono::milliseconds(10)) noexcept;
+
+  /// Stop the background thread after a final drain. Does nothing if not running.
+  void stop() noexcept;
+
+  /// @returns true if the background thread is running
+  bool isRunning() const noexcept { return thread_.joinable(); }
+
+  /**
+   Obtain the events collected so far, ordered by time, and clear them from the collector.
+
+   @returns collected events
+   */
+  std::vector<Event> take() noexcept;
+
+  /// @returns the number of events dropped due to full buffers or too many recording threads
+  size_t dropped() const noexcept;
+
+private:
+  struct Pool;
+  struct ThreadSlot;
+
+  Buffer* threadBuffer() noexcept;
+
+  static thread_local ThreadSlot threadSlot_;
+
+  // The buffers are shared with the threads recording into them so that a thread can return its buffer when it exits,
+  // even if the collector is gone by then.
+  std::shared_ptr<Pool> pool_;
+  Buffer* buffers_;
+  std::atomic<size_t> unbuffered_{0};
+  const uint64_t generation_;
+
+  std::mutex mutex_{};
+  std::condition_variable wakeup_{};
+  bool stopping_{false};
+  std::thread thread_{};
+  std::vector<Event> events_{};
+};
+
+} // end namespace SF2::Trace
@@ -0,0 +1,69 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#pragma once
+
+#include <cstdint>
+
+namespace SF2::Trace {
+
+/// The places in the library that emit trace events.
+enum struct Id : uint16_t {
+  noteOn,
+  noteOff,
+  startVoice,
+  stopVoice,
+  voiceConfigure,
+  voiceStart,
+  render,
+  midiIgnored,
+  sysExIgnored
+};
+
+/// The kind of a trace event. A `begin` event must be matched by an `end` event on the same thread.
+enum struct Kind : uint8_t {
+  begin,
+  end,
+  instant
+};
+
+/**
+ A fixed-size trace record. Events are small POD values so that they can be copied into a ring buffer from the render
+ thread without allocating or taking a lock.
+ */
+struct Event {
+  /// Time of the event in nanoseconds from an arbitrary but fixed point in time (steady clock)
+  uint64_t timestamp;
+  /// Two event-specific values, such as the key and velocity of a MIDI note
+  int32_t arg0;
+  int32_t arg1;
+  Id id;
+  Kind kind;
+  /// The index of the per-thread buffer that recorded the event
+  uint8_t thread;
+};
+
+static_assert(sizeof(Event) == 24);
+
+/**
+ Obtain the display name of a trace event identifier.
+
+ @param id the identifier to look up
+ @returns the name of the identifier
+ */
+inline const char* name(Id id) noexcept
+{
+  switch (id) {
+    case Id::noteOn: return "noteOn";
+    case Id::noteOff: return "noteOff";
+    case Id::startVoice: return "startVoice";
+    case Id::stopVoice: return "stopVoice";
+    case Id::voiceConfigure: return "voiceConfigure";
+    case Id::voiceStart: return "voiceStart";
+    case Id::render: return "render";
+    case Id::midiIgnored: return "midiIgnored";
+    case Id::sysExIgnored: return "sysExIgnored";
+  }
+  return "unknown";
+}
+
+} // end namespace SF2::Trace
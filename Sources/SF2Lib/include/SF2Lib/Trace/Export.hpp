@@ -0,0 +1,29 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#pragma once
+
+#include <iosfwd>
+#include <vector>
+
+#include "SF2Lib/Trace/Event.hpp"
+
+namespace SF2::Trace {
+
+/**
+ Write events in the Chrome trace event JSON format, which can be loaded into chrome://tracing or Perfetto. Timestamps
+ are written in microseconds relative to the first event.
+
+ @param os the stream to write to
+ @param events the events to write, ordered by time
+ */
+void writeChromeTrace(std::ostream& os, const std::vector<Event>& events) noexcept;
+
+/**
+ Write events as lines of text, one per event, with the time in nanoseconds relative to the first event.
+
+ @param os the stream to write to
+ @param events the events to write, ordered by time
+ */
+void writeTextLog(std::ostream& os, const std::vector<Event>& events) noexcept;
+
+} // end namespace SF2::Trace
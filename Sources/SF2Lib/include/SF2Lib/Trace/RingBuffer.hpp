@@ -0,0 +1,92 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace SF2::Trace {
+
+/**
+ Fixed-capacity, lock-free ring buffer for one producer thread and one consumer thread. The producer never blocks or
+ allocates -- if the buffer is full the new value is dropped and counted. The consumer removes values in the order they
+ were added.
+
+ @tparam T the type of value to hold. Must be trivially copyable.
+ @tparam Capacity the maximum number of values held at once. Must be a power of 2.
+ */
+template <typename T, size_t Capacity>
+class RingBuffer
+{
+public:
+  static_assert(Capacity > 1 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+
+  RingBuffer() noexcept = default;
+
+  RingBuffer(const RingBuffer&) = delete;
+  RingBuffer& operator=(const RingBuffer&) = delete;
+
+  /**
+   Add a value to the buffer. Only call from the producer thread.
+
+   @param value the value to add
+   @returns true if added, false if the buffer was full and the value was dropped
+   */
+  bool push(const T& value) noexcept
+  {
+    auto head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) == Capacity) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    values_[head & mask] = value;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   Remove values from the buffer. Only call from the consumer thread.
+
+   @param proc the function to call with each value, oldest first
+   @param maxCount the most values to remove. Any others stay in the buffer for the next call.
+   @returns the number of values removed
+   */
+  template <typename Proc>
+  size_t drain(Proc&& proc, size_t maxCount = Capacity) noexcept(noexcept(proc(std::declval<const T&>())))
+  {
+    auto tail = tail_.load(std::memory_order_relaxed);
+    auto head = head_.load(std::memory_order_acquire);
+    auto end = tail + std::min(head - tail, maxCount);
+    for (auto pos = tail; pos != end; ++pos) {
+      proc(values_[pos & mask]);
+    }
+    tail_.store(end, std::memory_order_release);
+    return end - tail;
+  }
+
+  /// @returns number of values in the buffer
+  size_t size() const noexcept { return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire); }
+
+  /// @returns true if the buffer holds no values
+  bool empty() const noexcept { return size() == 0; }
+
+  /// @returns the maximum number of values held at once
+  static constexpr size_t capacity() noexcept { return Capacity; }
+
+  /// @returns number of values dropped because the buffer was full
+  size_t dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+  static constexpr size_t mask = Capacity - 1;
+
+  // Keep the producer and consumer counters on separate cache lines so that the two threads do not contend.
+  alignas(64) std::atomic<size_t> head_{0};
+  alignas(64) std::atomic<size_t> tail_{0};
+  std::atomic<size_t> dropped_{0};
+  std::array<T, Capacity> values_;
+};
+
+} // end namespace SF2::Trace
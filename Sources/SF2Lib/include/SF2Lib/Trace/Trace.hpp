@@ -0,0 +1,143 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#pragma once
+
+#include <cstdint>
+
+#include "SF2Lib/Trace/Event.hpp"
+
+/**
+ Tracing of library activity. The backend is chosen at compile time with the SF2_TRACE_BACKEND define:
+
+ - 0 -- tracing is compiled out
+ - 1 -- events become os_signpost intervals and events, viewable in Instruments (Apple platforms only)
+ - 2 -- events are recorded into the lock-free per-thread buffers of `Collector::shared()`, which can be exported as a
+   Chrome trace or a text log
+
+ All of the recording functions are safe to call from a real-time thread with the backends above.
+ */
+#if SF2_TRACE_BACKEND == 1 && defined(__APPLE__)
+#include <os/log.h>
+#include <os/signpost.h>
+#elif SF2_TRACE_BACKEND == 2
+#include "SF2Lib/Trace/Collector.hpp"
+#endif
+
+namespace SF2::Trace {
+
+#if SF2_TRACE_BACKEND == 1 && defined(__APPLE__)
+
+/// @returns the log handle used for signposts
+inline os_log_t signpostLog() noexcept
+{
+  static const os_log_t log{os_log_create("SF2Lib", "Trace")};
+  return log;
+}
+
+// The os_signpost macros require the event name to be a string literal.
+#define SF2_TRACE_SIGNPOST(EMIT, ID, ARG0, ARG1) \
+switch (ID) { \
+case Id::noteOn: EMIT(signpostLog(), os_signpost_id_t(ID) + 1, "noteOn", "%d %d", ARG0, ARG1); break; \
+case Id::noteOff: EMIT(signpostLog(), os_signpost_id_t(ID) + 1, "noteOff", "%d %d", ARG0, ARG1); break; \
+case Id::startVoice: EMIT(signpostLog(), os_signpost_id_t(ID) + 1, "startVoice", "%d %d", ARG0, ARG1); break; \
+case Id::stopVoice: EMIT(signpostLog(), os_signpost_id_t(ID) + 1, "stopVoice", "%d %d", ARG0, ARG1); break; \
+case Id::voiceConfigure: EMIT(signpostLog(), os_signpost_id_t(ID) + 1, "voiceConfigure", "%d %d", ARG0, ARG1); break; \
+case Id::voiceStart: EMIT(signpostLog(), os_signpost_id_t(ID) + 1, "voiceStart", "%d %d", ARG0, ARG1); break; \
+case Id::render: EMIT(signpostLog(), os_signpost_id_t(ID) + 1, "render", "%d %d", ARG0, ARG1); break; \
+case Id::midiIgnored: EMIT(signpostLog(), os_signpost_id_t(ID) + 1, "midiIgnored", "%d %d", ARG0, ARG1); break; \
+case Id::sysExIgnored: EMIT(signpostLog(), os_signpost_id_t(ID) + 1, "sysExIgnored", "%d %d", ARG0, ARG1); break; \
+}
+
+inline void prepare() noexcept { signpostLog(); }
+
+inline void begin(Id id, int32_t arg0 = 0, int32_t arg1 = 0) noexcept {
+  SF2_TRACE_SIGNPOST(os_signpost_interval_begin, id, arg0, arg1)
+}
+
+inline void end(Id id, int32_t arg0 = 0, int32_t arg1 = 0) noexcept {
+  SF2_TRACE_SIGNPOST(os_signpost_interval_end, id, arg0, arg1)
+}
+
+inline void instant(Id id, int32_t arg0 = 0, int32_t arg1 = 0) noexcept {
+  SF2_TRACE_SIGNPOST(os_signpost_event_emit, id, arg0, arg1)
+}
+
+#undef SF2_TRACE_SIGNPOST
+
+#elif SF2_TRACE_BACKEND == 2
+
+/// Create the shared collector and its buffers. Call from a non-real-time thread before rendering starts.
+inline void prepare() noexcept { Collector::shared(); }
+
+/**
+ Record the start of an interval.
+
+ @param id the identifier of the interval
+ @param arg0 first event-specific value
+ @param arg1 second event-specific value
+ */
+inline void begin(Id id, int32_t arg0 = 0, int32_t arg1 = 0) noexcept {
+  Collector::shared().record(Kind::begin, id, arg0, arg1);
+}
+
+/**
+ Record the end of an interval.
+
+ @param id the identifier of the interval
+ @param arg0 first event-specific value
+ @param arg1 second event-specific value
+ */
+inline void end(Id id, int32_t arg0 = 0, int32_t arg1 = 0) noexcept {
+  Collector::shared().record(Kind::end, id, arg0, arg1);
+}
+
+/**
+ Record a single point in time.
+
+ @param id the identifier of the event
+ @param arg0 first event-specific value
+ @param arg1 second event-specific value
+ */
+inline void instant(Id id, int32_t arg0 = 0, int32_t arg1 = 0) noexcept {
+  Collector::shared().record(Kind::instant, id, arg0, arg1);
+}
+
+#else
+
+inline void prepare() noexcept {}
+inline void begin(Id, int32_t = 0, int32_t = 0) noexcept {}
+inline void end(Id, int32_t = 0, int32_t = 0) noexcept {}
+inline void instant(Id, int32_t = 0, int32_t = 0) noexcept {}
+
+#endif
+
+/**
+ Records an interval that lasts for the lifetime of the object.
+ */
+class Interval
+{
+public:
+  /**
+   Constructor. Records the start of the interval.
+
+   @param id the identifier of the interval
+   @param arg0 first event-specific value
+   @param arg1 second event-specific value
+   */
+  Interval(Id id, int32_t arg0 = 0, int32_t arg1 = 0) noexcept : id_{id}, arg0_{arg0}, arg1_{arg1} {
+    begin(id_, arg0_, arg1_);
+  }
+
+  /// Destructor. Records the end of the interval.
+  ~Interval() noexcept { end(id_, arg0_, arg1_); }
+
+  Interval(const Interval&) = delete;
+  Interval& operator=(const Interval&) = delete;
+
+private:
+  Id id_;
+  int32_t arg0_;
+  int32_t arg1_;
+};
+
+} // end namespace SF2::Trace
@@ -2,18 +2,40 @@
 
 #pragma once
 
-#include <AudioToolbox/AUParameters.h>
+#include <array>
 #include <cmath>
 #include <concepts>
+#include <cstdint>
 #include <vector>
 
+#if defined(__APPLE__)
+#include <AudioToolbox/AUParameters.h>
+#else
+/// Plain C++ definitions of the AudioToolbox types that the render core uses, for builds without Apple frameworks.
+/// They match the Apple definitions so that code using them is the same on all platforms.
+using AUValue = float;
+using AUAudioFrameCount = uint32_t;
+using AUParameterAddress = uint64_t;
+#endif
+
 namespace SF2 {
 
 /**
- Type to use for all floating-point operations in SF2. For precision we do everything in 64-bit and convert at AUValue
- (32-bit float) only when necessary.
+ Type to use for all floating-point operations in SF2. By default we do everything in 64-bit and convert to AUValue
+ (32-bit float) only when necessary. Defining SF2_SINGLE_PRECISION to 1 runs the rendering core in 32-bit instead,
+ which doubles the SIMD width and halves the memory traffic for samples and filter state.
  */
+#if SF2_SINGLE_PRECISION == 1
+using Float = float;
+#else
 using Float = double;
+#endif
+
+/**
+ Type to use for accumulating the position in a sample stream. This is always 64-bit so that long notes do not drift
+ in pitch when `Float` is 32-bit.
+ */
+using PhaseFloat = double;
 using SampleVector = std::vector<Float>;
 
 #ifndef __AVAudioTypes_h__
@@ -0,0 +1,39 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace SF2::Utils {
+
+/**
+ Read a free-running hardware counter that is cheap enough to sample several times per audio frame. On x86 this is
+ the time-stamp counter (TSC), which counts at a constant rate close to the nominal CPU clock. On ARM64 it is the
+ virtual counter (CNTVCT_EL0), which counts at a lower fixed rate (24 MHz on Apple silicon), so short intervals read as
+ 0 or 1 ticks, but sums over many intervals are still correct on average. Other platforms use the steady clock in
+ nanoseconds.
+
+ The values are only meaningful relative to each other on the same machine.
+
+ @returns the current counter value
+ */
+inline uint64_t cycleCount() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#elif defined(__aarch64__) || defined(__arm64__)
+  uint64_t value;
+  __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(value));
+  return value;
+#else
+  return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+} // end namespace SF2::Utils
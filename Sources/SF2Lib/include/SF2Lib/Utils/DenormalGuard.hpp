@@ -0,0 +1,59 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#pragma once
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <xmmintrin.h>
+#endif
+
+namespace SF2::Utils {
+
+/**
+ Makes the floating-point unit treat subnormal (denormal) values as zero for the lifetime of the guard, and restores
+ the previous mode when the guard goes away. Release tails, envelope-scaled gains, and filter state all decay towards
+ zero and can end up as subnormal values, which some CPUs process much more slowly than normal values. Flushing them
+ to zero keeps rendering times steady and has no audible effect.
+
+ On x86 this sets the FTZ (flush-to-zero) and DAZ (denormals-are-zero) bits of MXCSR. On ARM64 it sets the FZ bit of
+ FPCR, which covers both inputs and outputs. On other platforms the guard does nothing.
+ */
+class DenormalGuard
+{
+public:
+  DenormalGuard() noexcept : saved_{read()} { write(saved_ | flushBits); }
+
+  ~DenormalGuard() noexcept { write(saved_); }
+
+  DenormalGuard(const DenormalGuard&) = delete;
+  DenormalGuard(DenormalGuard&&) = delete;
+  DenormalGuard& operator=(const DenormalGuard&) = delete;
+  DenormalGuard& operator=(DenormalGuard&&) = delete;
+
+  /// @returns true if subnormal values are currently flushed to zero
+  static bool isActive() noexcept { return flushBits != 0 && (read() & flushBits) == flushBits; }
+
+private:
+#if defined(__x86_64__) || defined(__i386__)
+  static inline constexpr uint64_t flushBits = 0x8040; // FTZ (bit 15) + DAZ (bit 6)
+  static uint64_t read() noexcept { return _mm_getcsr(); }
+  static void write(uint64_t value) noexcept { _mm_setcsr(static_cast<unsigned int>(value)); }
+#elif defined(__aarch64__) || defined(__arm64__)
+  static inline constexpr uint64_t flushBits = uint64_t(1) << 24; // FZ
+  static uint64_t read() noexcept {
+    uint64_t value;
+    __asm__ __volatile__("mrs %0, fpcr" : "=r"(value));
+    return value;
+  }
+  static void write(uint64_t value) noexcept { __asm__ __volatile__("msr fpcr, %0" : : "r"(value)); }
+#else
+  static inline constexpr uint64_t flushBits = 0;
+  static uint64_t read() noexcept { return 0; }
+  static void write(uint64_t) noexcept {}
+#endif
+
+  uint64_t saved_;
+};
+
+} // end namespace SF2::Utils
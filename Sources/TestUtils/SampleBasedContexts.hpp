@@ -78,6 +78,23 @@ struct TestEngineHarness {
 
   Engine& engine() noexcept { return engine_; }
 
+  /// @returns the number of active voices that are still held by a key or a pedal
+  size_t heldVoiceCount() const noexcept {
+    size_t count = 0;
+    for (const auto& voice : engine_.voices_) {
+      if (voice.isActive() && voice.isKeyDown()) ++count;
+    }
+    return count;
+  }
+
+  /// @returns true if an active voice that is not fading out was started by the given key
+  bool isKeySounding(int key) const noexcept {
+    for (const auto& voice : engine_.voices_) {
+      if (voice.isActive() && !voice.isFadingOut() && voice.initiatingKey() == key) return true;
+    }
+    return false;
+  }
+
   SF2::IO::File::LoadResponse load(const std::string& path, size_t index) noexcept {
     return engine_.load(path, index);
   }
@@ -127,18 +144,18 @@ struct TestEngineHarness {
     engine_.doMIDIEvent(event);
   }
 
-  void sendNoteOn(uint8_t note, uint8_t velocity = 64) noexcept {
+  void sendNoteOn(uint8_t note, uint8_t velocity = 64, uint8_t channel = 0) noexcept {
     AUMIDIEvent midiEvent;
-    midiEvent.data[0] = SF2::valueOf(SF2::MIDI::CoreEvent::noteOn);
+    midiEvent.data[0] = SF2::valueOf(SF2::MIDI::CoreEvent::noteOn) | (channel & 0x0F);
     midiEvent.data[1] = note;
     midiEvent.data[2] = velocity;
     midiEvent.length = 3;
     engine_.doMIDIEvent(midiEvent);
   }
 
-  void sendNoteOff(uint8_t note) noexcept {
+  void sendNoteOff(uint8_t note, uint8_t channel = 0) noexcept {
     AUMIDIEvent midiEvent;
-    midiEvent.data[0] = SF2::valueOf(SF2::MIDI::CoreEvent::noteOff);
+    midiEvent.data[0] = SF2::valueOf(SF2::MIDI::CoreEvent::noteOff) | (channel & 0x0F);
     midiEvent.data[1] = note;
     midiEvent.length = 2;
     engine_.doMIDIEvent(midiEvent);
@@ -152,17 +169,11 @@ struct TestEngineHarness {
   }
 
   void setParameter(SF2::Render::Engine::Parameters::EngineParameterAddress address, AUValue value) noexcept {
-    auto event = AUParameterEvent();
-    event.parameterAddress = SF2::valueOf(address);
-    event.value = value;
-    engine_.doParameterEvent(event, 0);
+    engine_.doSetImmediateParameterValue(SF2::valueOf(address), value, 0);
   }
 
-  void setParameter(SF2::Entity::Generator::Index index, AUValue value) noexcept {
-    auto event = AUParameterEvent();
-    event.parameterAddress = SF2::valueOf(index);
-    event.value = value;
-    engine_.doParameterEvent(event, 0);
+  void setParameter(SF2::Entity::Generator::Index index, AUValue value, AUAudioFrameCount rampDuration = 0) noexcept {
+    engine_.doSetImmediateParameterValue(SF2::valueOf(index), value, rampDuration);
   }
 
 private:
@@ -0,0 +1,78 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#include <XCTest/XCTest.h>
+
+#include <limits>
+#include <vector>
+
+#include "SF2Lib/Utils/DenormalGuard.hpp"
+
+using namespace SF2::Utils;
+
+@interface DenormalGuardTests : XCTestCase
+
+@end
+
+namespace {
+
+/// Run a decaying recursion over values that start out subnormal, much like the tail of a released voice.
+double decay(std::vector<double>& values) {
+  double sum = 0.0;
+  for (int pass = 0; pass < 200; ++pass) {
+    for (auto& value : values) {
+      value = value * 0.999 + std::numeric_limits<double>::denorm_min() * 100.0;
+      sum += value;
+    }
+  }
+  return sum;
+}
+
+}
+
+@implementation DenormalGuardTests
+
+- (void)testFlushesSubnormals {
+  volatile double tiny = std::numeric_limits<double>::min() / 1024.0;
+  XCTAssertNotEqual(tiny * 0.5, 0.0);
+  bool wasActive = DenormalGuard::isActive();
+  {
+    DenormalGuard guard;
+    if (DenormalGuard::isActive()) {
+      XCTAssertEqual(tiny * 0.5, 0.0);
+    }
+  }
+  XCTAssertEqual(DenormalGuard::isActive(), wasActive);
+  XCTAssertNotEqual(tiny * 0.5, 0.0);
+}
+
+- (void)testNesting {
+  {
+    DenormalGuard outer;
+    auto active = DenormalGuard::isActive();
+    {
+      DenormalGuard inner;
+      XCTAssertEqual(DenormalGuard::isActive(), active);
+    }
+    XCTAssertEqual(DenormalGuard::isActive(), active);
+  }
+  XCTAssertFalse(DenormalGuard::isActive());
+}
+
+- (void)testSubnormalDecayPerformanceWithoutGuard {
+  std::vector<double> values(4096, std::numeric_limits<double>::min() / 1024.0);
+  [self measureBlock:^{
+    auto copy{values};
+    XCTAssertGreaterThan(decay(copy), 0.0);
+  }];
+}
+
+- (void)testSubnormalDecayPerformanceWithGuard {
+  std::vector<double> values(4096, std::numeric_limits<double>::min() / 1024.0);
+  [self measureBlock:^{
+    DenormalGuard guard;
+    auto copy{values};
+    XCTAssertGreaterThanOrEqual(decay(copy), 0.0);
+  }];
+}
+
+@end
@@ -0,0 +1,119 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#import <vector>
+
+#import <XCTest/XCTest.h>
+
+#import "SF2Lib/MIDI/MIDIFile.hpp"
+
+using namespace SF2::MIDI;
+
+@interface MIDIFileTests : XCTestCase
+@end
+
+@implementation MIDIFileTests
+
+/// @returns a format 1 file with 480 ticks per quarter note and the given tracks
+static std::vector<uint8_t> makeFile(std::vector<std::vector<uint8_t>> tracks) {
+  std::vector<uint8_t> data{'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 1, 0, uint8_t(tracks.size()), 0x01, 0xE0};
+  for (const auto& track : tracks) {
+    auto size = track.size();
+    data.insert(data.end(), {'M', 'T', 'r', 'k', uint8_t(size >> 24), uint8_t(size >> 16), uint8_t(size >> 8),
+      uint8_t(size)});
+    data.insert(data.end(), track.begin(), track.end());
+  }
+  return data;
+}
+
+- (void)testRunningStatusAndTempo {
+  auto data = makeFile({
+    // Tempo of 1 second per quarter note
+    {0x00, 0xFF, 0x51, 0x03, 0x0F, 0x42, 0x40, 0x00, 0xFF, 0x2F, 0x00},
+    // Note on, then note off one quarter note later with running status
+    {0x00, 0x90, 0x3C, 0x64, 0x83, 0x60, 0x3C, 0x00, 0x00, 0xFF, 0x2F, 0x00}
+  });
+  MIDIFile file{""};
+  XCTAssertEqual(file.parse(data), MIDIFile::LoadResponse::ok);
+  XCTAssertEqual(file.format(), 1);
+  XCTAssertEqual(file.trackCount(), 2);
+  XCTAssertEqual(file.events().size(), 2);
+
+  auto first = file.message(file.events()[0]);
+  XCTAssertEqual(first.size(), 3);
+  XCTAssertEqual(first[0], 0x90);
+  XCTAssertEqual(first[1], 0x3C);
+  XCTAssertEqual(first[2], 0x64);
+  XCTAssertEqualWithAccuracy(file.events()[0].seconds, 0.0, 1e-9);
+
+  auto second = file.message(file.events()[1]);
+  XCTAssertEqual(second.size(), 3);
+  XCTAssertEqual(second[0], 0x90);
+  XCTAssertEqual(second[2], 0x00);
+  XCTAssertEqualWithAccuracy(file.events()[1].seconds, 1.0, 1e-9);
+  XCTAssertEqualWithAccuracy(file.duration(), 1.0, 1e-9);
+}
+
+- (void)testTracksAreMergedInTimeOrder {
+  auto data = makeFile({
+    {0x83, 0x60, 0xC0, 0x05, 0x00, 0xFF, 0x2F, 0x00},
+    {0x00, 0xC1, 0x07, 0x00, 0xFF, 0x2F, 0x00}
+  });
+  MIDIFile file{""};
+  XCTAssertEqual(file.parse(data), MIDIFile::LoadResponse::ok);
+  XCTAssertEqual(file.events().size(), 2);
+  XCTAssertEqual(file.message(file.events()[0])[0], 0xC1);
+  XCTAssertEqual(file.message(file.events()[1])[0], 0xC0);
+  XCTAssertEqualWithAccuracy(file.events()[1].seconds, 0.5, 1e-9);
+}
+
+- (void)testSysExIsTerminated {
+  auto data = makeFile({{0x00, 0xF0, 0x03, 0x7E, 0x7F, 0x09, 0x00, 0xFF, 0x2F, 0x00}});
+  MIDIFile file{""};
+  XCTAssertEqual(file.parse(data), MIDIFile::LoadResponse::ok);
+  XCTAssertEqual(file.events().size(), 1);
+  auto message = file.message(file.events()[0]);
+  XCTAssertEqual(message.size(), 5);
+  XCTAssertEqual(message[0], 0xF0);
+  XCTAssertEqual(message[4], 0xF7);
+}
+
+- (void)testInvalidData {
+  MIDIFile file{""};
+  std::vector<uint8_t> garbage{'R', 'I', 'F', 'F', 0, 0, 0, 0};
+  XCTAssertEqual(file.parse(garbage), MIDIFile::LoadResponse::invalidFormat);
+
+  auto truncated = makeFile({{0x00, 0x90, 0x3C, 0x64}});
+  truncated.pop_back();
+  XCTAssertEqual(file.parse(truncated), MIDIFile::LoadResponse::invalidFormat);
+  XCTAssertTrue(file.events().empty());
+}
+
+- (void)testUnsupportedHeaders {
+  MIDIFile file{""};
+
+  // Format 2 holds independent sequences
+  auto data = makeFile({{0x00, 0xFF, 0x2F, 0x00}});
+  data[9] = 2;
+  XCTAssertEqual(file.parse(data), MIDIFile::LoadResponse::invalidFormat);
+
+  // SMPTE timing at 25 frames per second with no ticks per frame
+  data = makeFile({{0x00, 0xFF, 0x2F, 0x00}});
+  data[12] = 0xE7;
+  data[13] = 0x00;
+  XCTAssertEqual(file.parse(data), MIDIFile::LoadResponse::invalidFormat);
+
+  // SMPTE timing at 25 frames per second with 40 ticks per frame is one millisecond per tick
+  data = makeFile({{0x83, 0x60, 0x90, 0x3C, 0x64, 0x00, 0xFF, 0x2F, 0x00}});
+  data[12] = 0xE7;
+  data[13] = 0x28;
+  XCTAssertEqual(file.parse(data), MIDIFile::LoadResponse::ok);
+  XCTAssertEqual(file.events().size(), 1);
+  XCTAssertEqualWithAccuracy(file.events()[0].seconds, 0.48, 1e-9);
+}
+
+- (void)testMissingFile {
+  MIDIFile file{"/this/file/does/not/exist.mid"};
+  XCTAssertEqual(file.load(), MIDIFile::LoadResponse::notFound);
+}
+
+@end
@@ -0,0 +1,114 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#include <XCTest/XCTest.h>
+
+#include <string>
+#include <vector>
+
+#include "SF2Lib/Portable/Scalar.hpp"
+#include "SF2Lib/Portable/SIMD.hpp"
+
+using namespace SF2::Portable;
+
+/**
+ Checks that the SIMD kernels of every instruction set available on the test machine give exactly the same results as
+ the scalar reference. Every kernel rounds after each IEEE operation -- `scaleAdd` is a separate multiply and add, and
+ the scalar reference turns off fused multiply-add contraction to match -- so there is no rounding difference. Lengths
+ are chosen to exercise the scalar tail after the last full vector.
+ */
+@interface PortableSIMDTests : XCTestCase
+
+@end
+
+namespace {
+
+const std::vector<InstructionSet> instructionSets{InstructionSet::scalar, InstructionSet::sse2, InstructionSet::avx2,
+  InstructionSet::neon};
+const std::vector<unsigned long> lengths{0, 1, 3, 7, 8, 9, 31, 64, 1001};
+
+std::vector<int16_t> makeRaw(unsigned long count) {
+  std::vector<int16_t> values(count);
+  for (unsigned long index = 0; index < count; ++index) values[index] = int16_t((index * 7'919) % 65'536 - 32'768);
+  return values;
+}
+
+template <typename T>
+std::vector<T> makeValues(unsigned long count) {
+  std::vector<T> values(count);
+  for (unsigned long index = 0; index < count; ++index) values[index] = T((index * 104'729) % 2'001) / T(7) - T(140);
+  return values;
+}
+
+template <typename T>
+bool matchesScalar(const Kernels<T>& kernels) {
+  const T factor = T(1.0 / 32'768.0);
+  for (auto count : lengths) {
+    auto raw = makeRaw(count);
+    auto first = makeValues<T>(count);
+    auto second = makeValues<T>(count + 17);
+    std::vector<T> value(count), expected(count);
+
+    kernels.convertScale(raw.data(), 1, &factor, value.data(), 1, count);
+    Scalar::convertScale(raw.data(), 1, &factor, expected.data(), 1, count);
+    if (value != expected) return false;
+
+    kernels.convert(raw.data(), 1, value.data(), 1, count);
+    Scalar::convert(raw.data(), 1, expected.data(), 1, count);
+    if (value != expected) return false;
+
+    T peak = -1, expectedPeak = -1;
+    kernels.magnitude(first.data(), 1, &peak, count);
+    Scalar::magnitude(first.data(), 1, &expectedPeak, count);
+    if (peak != expectedPeak) return false;
+
+    kernels.add(first.data(), 1, second.data(), 1, value.data(), 1, count);
+    Scalar::add(first.data(), 1, second.data(), 1, expected.data(), 1, count);
+    if (value != expected) return false;
+
+    // In place, as the mixer does for its send busses
+    value.assign(second.begin(), second.begin() + long(count));
+    expected = value;
+    kernels.scaleAdd(first.data(), 1, &factor, value.data(), 1, value.data(), 1, count);
+    Scalar::scaleAdd(first.data(), 1, &factor, expected.data(), 1, expected.data(), 1, count);
+    if (value != expected) return false;
+
+    std::vector<float> narrowed(count), expectedNarrowed(count);
+    kernels.narrow(first.data(), 1, narrowed.data(), 1, count);
+    Scalar::narrow(first.data(), 1, expectedNarrowed.data(), 1, count);
+    if (narrowed != expectedNarrowed) return false;
+
+    // Strides other than 1 fall back to the scalar code
+    kernels.scale(first.data(), 2, &factor, value.data(), 2, count / 2);
+    Scalar::scale(first.data(), 2, &factor, expected.data(), 2, count / 2);
+    if (value != expected) return false;
+  }
+  return true;
+}
+
+}
+
+@implementation PortableSIMDTests
+
+- (void)testScalarIsAlwaysAvailable {
+  XCTAssertTrue(available(InstructionSet::scalar));
+  XCTAssertTrue(available(bestInstructionSet()));
+  XCTAssertEqual(std::string("scalar"), std::string(name(InstructionSet::scalar)));
+}
+
+- (void)testFloatKernelsMatchScalar {
+  for (auto instructionSet : instructionSets) {
+    if (auto kernels = SF2::Portable::kernels<float>(instructionSet)) {
+      XCTAssertTrue(matchesScalar(*kernels), @"%s", name(instructionSet));
+    }
+  }
+}
+
+- (void)testDoubleKernelsMatchScalar {
+  for (auto instructionSet : instructionSets) {
+    if (auto kernels = SF2::Portable::kernels<double>(instructionSet)) {
+      XCTAssertTrue(matchesScalar(*kernels), @"%s", name(instructionSet));
+    }
+  }
+}
+
+@end
@@ -0,0 +1,101 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#include <XCTest/XCTest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+#include "SF2Lib/DSP.hpp"
+#include "SF2Lib/Entity/SampleHeader.hpp"
+#include "SF2Lib/MIDI/ChannelState.hpp"
+#include "SF2Lib/Render/LowPassFilter.hpp"
+#include "SF2Lib/Render/Voice/Sample/Index.hpp"
+#include "SF2Lib/Render/Voice/State/State.hpp"
+
+using namespace SF2;
+using namespace SF2::Render;
+
+/**
+ Checks that the rendering core stays close to 64-bit reference values when built with SF2_SINGLE_PRECISION=1. The
+ references are calculated here in `double` so the same tests run in both builds. The tolerances are:
+
+ - conversions: relative difference of 1e-5 in 32-bit (under 100 ULPs of `float`) and 1e-12 in 64-bit
+ - filter coefficients: absolute difference of 1e-6 in 32-bit and 1e-9 in 64-bit
+ - sample position: absolute difference of 1e-6 in both builds since the position is always kept in 64-bit
+
+ Rendered samples are checked against the stored 64-bit renderings by the engine and voice tests using
+ `PresetTestContextBase::epsilonValue`, which is 1e-3 in 32-bit.
+ */
+@interface PrecisionTests : XCTestCase
+
+@end
+
+namespace {
+
+constexpr bool singlePrecision = std::is_same_v<Float, float>;
+constexpr double conversionTolerance = singlePrecision ? 1.0e-5 : 1.0e-12;
+constexpr double coefficientTolerance = singlePrecision ? 1.0e-6 : 1.0e-9;
+constexpr double positionTolerance = 1.0e-6;
+
+double relativeError(double value, double reference) {
+  return reference == 0.0 ? std::abs(value) : std::abs(value - reference) / std::abs(reference);
+}
+
+}
+
+@implementation PrecisionTests
+
+- (void)testCentsToFrequency {
+  for (int cents = 0; cents <= 13'500; cents += 7) {
+    double reference = 440.0 * std::exp2((cents - 6'900) / 1'200.0);
+    XCTAssertLessThan(relativeError(DSP::centsToFrequency(Float(cents)), reference), conversionTolerance);
+  }
+}
+
+- (void)testCentibelsToAttenuation {
+  for (int centibels = 0; centibels < 1'440; centibels += 3) {
+    double reference = std::pow(10.0, centibels / -200.0);
+    XCTAssertLessThan(relativeError(DSP::centibelsToAttenuation(Float(centibels)), reference), conversionTolerance);
+  }
+}
+
+- (void)testFilterCoefficients {
+  double sampleRate = 44'100.0;
+  LowPassFilter filter{Float(sampleRate)};
+  for (int cents = 1'500; cents <= 13'500; cents += 500) {
+    for (int centibels : {0, 240, 960}) {
+      double frequency = std::clamp(440.0 * std::exp2((cents - 6'900) / 1'200.0), 5.0, 0.45 * sampleRate);
+      double q = std::pow(10.0, (centibels - 30.1) / 200.0);
+      double theta = 2.0 * M_PI * frequency / sampleRate;
+      double d = 1.0 / q / 2.0 * std::sin(theta);
+      double beta = 0.5 * (1.0 - d) / (1.0 + d);
+      double gamma = (0.5 + beta) * std::cos(theta);
+      double alpha = (0.5 + beta - gamma) / 2.0;
+
+      auto found = filter.coefficients(Float(cents), Float(centibels));
+      XCTAssertEqualWithAccuracy(found.a0, alpha, coefficientTolerance);
+      XCTAssertEqualWithAccuracy(found.a1, 2.0 * alpha, coefficientTolerance);
+      XCTAssertEqualWithAccuracy(found.b1, -2.0 * gamma, coefficientTolerance);
+      XCTAssertEqualWithAccuracy(found.b2, 2.0 * beta, coefficientTolerance);
+    }
+  }
+}
+
+- (void)testSamplePositionDoesNotDrift {
+  Entity::SampleHeader header(0, 10'000'000, 10, 20, 44'100, 69, 0);
+  MIDI::ChannelState channelState;
+  Voice::Sample::Index index;
+  index.configure(Voice::Sample::Bounds::make(header, Voice::State::State(44'100.0, channelState)));
+
+  // A pitch ratio that is not exactly representable, applied for over 20 seconds of audio at 44.1 kHz.
+  Float increment = Float(1.0 / 3.0);
+  size_t steps = 3'000'000;
+  for (size_t step = 0; step < steps; ++step) index.increment(increment, false);
+
+  double expected = double(increment) * double(steps);
+  double position = double(index.whole()) + double(index.partial());
+  XCTAssertEqualWithAccuracy(position, expected, positionTolerance);
+}
+
+@end
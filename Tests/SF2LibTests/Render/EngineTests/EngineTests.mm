@@ -55,6 +55,29 @@ using namespace SF2::Render::Engine;
   XCTAssertFalse(engine.portamentoModeEnabled());
 }
 
+- (void)testLinkedStereoMode {
+  auto harness{TestEngineHarness{48000.0, 32, SF2::Render::Voice::Sample::Interpolator::linear}};
+  auto& engine{harness.engine()};
+
+  harness.load(contexts.context0.path(), 0);
+  auto mixer{harness.createMixer(1)};
+  XCTAssertFalse(engine.linkedStereoModeEnabled());
+  harness.sendNoteOn(60);
+  auto voiceCount = engine.activeVoiceCount();
+  XCTAssertTrue(voiceCount > 0);
+  harness.sendAllOff();
+
+  // Samples of the test font are all mono, so the mode does not change the number of voices used.
+  harness.setParameter(Parameters::EngineParameterAddress::linkedStereoModeEnabled, 1.0);
+  XCTAssertTrue(engine.linkedStereoModeEnabled());
+  harness.sendNoteOn(60);
+  XCTAssertEqual(engine.activeVoiceCount(), voiceCount);
+  harness.renderOnce(mixer);
+
+  harness.setParameter(Parameters::EngineParameterAddress::linkedStereoModeEnabled, 0.0);
+  XCTAssertFalse(engine.linkedStereoModeEnabled());
+}
+
 - (void)testPhonicMode {
   auto harness{TestEngineHarness{48000.0, 32, SF2::Render::Voice::Sample::Interpolator::linear}};
   auto& engine{harness.engine()};
@@ -507,6 +530,32 @@ using namespace SF2::Render::Engine;
   }];
 }
 
+// Render 2 seconds of audio at 48000.0 sample rate where all voices are released after a short time, so most of the
+// work happens while the voices decay in their release stage. Without flushing subnormal values to zero, the render
+// time of the release tails can spike on some CPUs.
+- (void)testEngineReleaseTailRenderPerformance
+{
+  NSArray* metrics = @[XCTPerformanceMetric_WallClockTime];
+  [self measureMetrics:metrics automaticallyStartMeasuring:NO forBlock:^{
+    auto harness{TestEngineHarness{48000.0, 96, SF2::Render::Voice::Sample::Interpolator::linear}};
+    auto& engine{harness.engine()};
+    harness.load(contexts.context0.path(), 0);
+
+    int seconds = 2;
+    auto mixer{harness.createMixer(seconds)};
+    for (int voice = 0; voice < engine.voiceCount(); ++voice) harness.sendNoteOn(12 + voice);
+    harness.renderUntil(mixer, harness.renders() * 0.1);
+    for (int voice = 0; voice < engine.voiceCount(); ++voice) harness.sendNoteOff(12 + voice);
+
+    [self startMeasuring];
+    harness.renderToEnd(mixer);
+    [self stopMeasuring];
+
+    XCTAssertFalse(SF2::Utils::DenormalGuard::isActive());
+    XCTAssertTrue(engine.activeVoiceCount() < engine.voiceCount());
+  }];
+}
+
 - (void)testEngineMIDINoteOnOffProcessing
 {
   auto harness{TestEngineHarness{48000.0}};
@@ -1879,4 +1928,438 @@ using namespace SF2::Render::Engine;
   XCTAssertEqual(0, engine.activeVoiceCount());
 }
 
+- (void)testEngineNoteOffWhileSustainedReleasesOnPedalUp
+{
+  auto harness{TestEngineHarness{48000.0}};
+  auto& engine{harness.engine()};
+  harness.load(contexts.context0.path(), 0);
+  auto mixer{harness.createMixer(1)};
+
+  harness.sendNoteOn(60);
+  harness.sendNoteOn(64);
+  harness.sendRaw(std::array<uint8_t, 3>{SF2::valueOf(MIDI::CoreEvent::controlChange),
+    SF2::valueOf(MIDI::ControlChange::sustainSwitch), 127});
+  harness.sendNoteOn(67);
+  harness.renderOnce(mixer);
+
+  // Keys released while the pedal is down keep sounding
+  harness.sendNoteOff(60);
+  harness.sendNoteOff(67);
+  XCTAssertEqual(3, engine.activeVoiceCount());
+  XCTAssertEqual(3, harness.heldVoiceCount());
+
+  // Pedal up releases them but not the key that is still down
+  harness.sendRaw(std::array<uint8_t, 3>{SF2::valueOf(MIDI::CoreEvent::controlChange),
+    SF2::valueOf(MIDI::ControlChange::sustainSwitch), 0});
+  XCTAssertEqual(3, engine.activeVoiceCount());
+  XCTAssertEqual(1, harness.heldVoiceCount());
+
+  harness.sendNoteOff(64);
+  XCTAssertEqual(0, harness.heldVoiceCount());
+}
+
+- (void)testEngineSostenutoOnlyHoldsKeysDownWhenPressed
+{
+  auto harness{TestEngineHarness{48000.0}};
+  auto& engine{harness.engine()};
+  harness.load(contexts.context0.path(), 0);
+  auto mixer{harness.createMixer(1)};
+
+  harness.sendNoteOn(60);
+  harness.sendRaw(std::array<uint8_t, 3>{SF2::valueOf(MIDI::CoreEvent::controlChange),
+    SF2::valueOf(MIDI::ControlChange::sostenutoSwitch), 127});
+  harness.sendNoteOn(64);
+  harness.renderOnce(mixer);
+
+  // Only the key that was down when the pedal was pressed is held after its note OFF
+  harness.sendNoteOff(60);
+  harness.sendNoteOff(64);
+  XCTAssertEqual(2, engine.activeVoiceCount());
+  XCTAssertEqual(1, harness.heldVoiceCount());
+
+  harness.sendRaw(std::array<uint8_t, 3>{SF2::valueOf(MIDI::CoreEvent::controlChange),
+    SF2::valueOf(MIDI::ControlChange::sostenutoSwitch), 0});
+  XCTAssertEqual(0, harness.heldVoiceCount());
+}
+
+- (void)testEngineExclusiveClassStopsVoicesOnSameChannel
+{
+  auto harness{TestEngineHarness{48000.0}};
+  auto& engine{harness.engine()};
+  harness.setParameter(Parameters::EngineParameterAddress::multiTimbralModeEnabled, 1.0);
+
+  // The "Standard" drum kit puts the closed (42) and open (46) hi-hats in exclusive class 1
+  harness.load(contexts.context0.path(), 226);
+  XCTAssertEqual("Standard", engine.activePresetName(1));
+
+  harness.sendNoteOn(46, 64, 2);
+  auto openVoices = engine.activeVoiceCount();
+  harness.sendNoteOn(42, 64, 0);
+  auto closedVoices = engine.activeVoiceCount() - openVoices;
+  XCTAssertGreaterThan(openVoices, 0);
+  XCTAssertGreaterThan(closedVoices, 0);
+  harness.sendNoteOn(42, 64, 1);
+  XCTAssertEqual(openVoices + 2 * closedVoices, engine.activeVoiceCount());
+
+  // The open hi-hat stops the closed one on its own channel only
+  harness.sendNoteOn(46, 64, 1);
+  XCTAssertEqual(2 * openVoices + closedVoices, engine.activeVoiceCount());
+}
+
+- (void)testEngineMultiTimbralMode
+{
+  auto harness{TestEngineHarness{48000.0}};
+  auto& engine{harness.engine()};
+  XCTAssertFalse(engine.multiTimbralModeEnabled());
+  harness.setParameter(Parameters::EngineParameterAddress::multiTimbralModeEnabled, 1.0);
+  XCTAssertTrue(engine.multiTimbralModeEnabled());
+  harness.load(contexts.context0.path(), 0);
+
+  XCTAssertEqual("Piano 1", engine.activePresetName(0));
+  XCTAssertEqual("Piano 1", engine.activePresetName(1));
+  XCTAssertTrue(engine.hasActivePreset(Engine::percussionChannel));
+  XCTAssertNotEqual("Piano 1", engine.activePresetName(Engine::percussionChannel));
+
+  // Program change only affects the channel it was sent on
+  harness.sendRaw(std::array<uint8_t, 3>{uint8_t(SF2::valueOf(MIDI::CoreEvent::programChange) | 1), 23, 0});
+  XCTAssertEqual("Piano 1", engine.activePresetName(0));
+  XCTAssertEqual("Bandoneon", engine.activePresetName(1));
+
+  // All channels share the same voices
+  harness.sendNoteOn(60, 64, 0);
+  harness.sendNoteOn(60, 64, 1);
+  XCTAssertEqual(2, engine.activeVoiceCount());
+
+  // Channel messages only affect their own channel
+  harness.sendRaw(std::array<uint8_t, 3>{uint8_t(SF2::valueOf(MIDI::CoreEvent::controlChange) | 1),
+    SF2::valueOf(MIDI::ControlChange::allSoundOff), 0});
+  XCTAssertEqual(1, engine.activeVoiceCount());
+
+  harness.sendRaw(std::array<uint8_t, 3>{uint8_t(SF2::valueOf(MIDI::CoreEvent::controlChange) | 2),
+    SF2::valueOf(MIDI::ControlChange::volumeMSB), 10});
+  XCTAssertEqual(100, engine.channelState(0).continuousControllerValue(MIDI::ControlChange::volumeMSB));
+  XCTAssertEqual(10, engine.channelState(2).continuousControllerValue(MIDI::ControlChange::volumeMSB));
+
+  harness.setParameter(Parameters::EngineParameterAddress::multiTimbralModeEnabled, 0.0);
+  XCTAssertFalse(engine.multiTimbralModeEnabled());
+  XCTAssertEqual(0, engine.activeVoiceCount());
+}
+
+- (void)testEngineMultiTimbralModeAfterLoad
+{
+  auto harness{TestEngineHarness{48000.0}};
+  auto& engine{harness.engine()};
+  harness.load(contexts.context0.path(), 0);
+  XCTAssertEqual("Piano 1", engine.activePresetName(Engine::percussionChannel));
+
+  harness.setParameter(Parameters::EngineParameterAddress::multiTimbralModeEnabled, 1.0);
+  XCTAssertEqual("Piano 1", engine.activePresetName(0));
+  XCTAssertEqual("Piano 1", engine.activePresetName(1));
+  XCTAssertTrue(engine.hasActivePreset(Engine::percussionChannel));
+  XCTAssertNotEqual("Piano 1", engine.activePresetName(Engine::percussionChannel));
+
+  harness.setParameter(Parameters::EngineParameterAddress::multiTimbralModeEnabled, 0.0);
+  XCTAssertEqual("Piano 1", engine.activePresetName(Engine::percussionChannel));
+}
+
+- (void)testEngineOldestVoiceStealing
+{
+  auto harness{TestEngineHarness{48000.0, 8}};
+  auto& engine{harness.engine()};
+  harness.load(contexts.context0.path(), 0);
+  XCTAssertEqual(Engine::StealingPolicy::oldest, engine.stealingPolicy());
+
+  for (int note = 60; note < 68; ++note) harness.sendNoteOn(note);
+  XCTAssertEqual(8, engine.activeVoiceCount());
+  XCTAssertEqual(0, engine.stolenVoiceCount());
+
+  harness.sendNoteOn(70);
+  XCTAssertEqual(8, engine.activeVoiceCount());
+  XCTAssertEqual(1, engine.stolenVoiceCount());
+}
+
+- (void)testEngineOldestVoiceStealingStopsOldestVoice
+{
+  auto harness{TestEngineHarness{48000.0, 8}};
+  auto& engine{harness.engine()};
+  harness.load(contexts.context0.path(), 0);
+  engine.setVoiceLimit(4);
+
+  for (int note = 60; note < 64; ++note) harness.sendNoteOn(note);
+  XCTAssertEqual(4, engine.activeVoiceCount());
+
+  // The first note played is the one that gives way, even though there are free voices under the limit.
+  harness.sendNoteOn(70);
+  XCTAssertEqual(4, engine.activeVoiceCount());
+  XCTAssertEqual(1, engine.stolenVoiceCount());
+  XCTAssertFalse(harness.isKeySounding(60));
+  for (int note : {61, 62, 63, 70}) XCTAssertTrue(harness.isKeySounding(note));
+}
+
+- (void)testEngineLoweringVoiceLimitShedsPlayingVoices
+{
+  for (auto policy : {0.0, 1.0}) {
+    auto harness{TestEngineHarness{48000.0, 16}};
+    auto& engine{harness.engine()};
+    harness.load(contexts.context0.path(), 0);
+    harness.setParameter(Parameters::EngineParameterAddress::stealingPolicy, policy);
+
+    auto mixer{harness.createMixer(1)};
+    for (int note = 48; note < 60; ++note) harness.sendNoteOn(note);
+    harness.renderOnce(mixer);
+    XCTAssertEqual(12, engine.activeVoiceCount());
+
+    // The voices over the new limit fade out during the next render.
+    engine.setVoiceLimit(6);
+    harness.renderOnce(mixer);
+    XCTAssertEqual(6, engine.activeVoiceCount());
+
+    // New notes now stay within the limit.
+    for (int note = 60; note < 66; ++note) harness.sendNoteOn(note);
+    harness.renderOnce(mixer);
+    XCTAssertTrue(engine.activeVoiceCount() <= 6);
+    XCTAssertTrue(harness.isKeySounding(65));
+  }
+}
+
+- (void)testEngineAudibilityVoiceStealing
+{
+  auto harness{TestEngineHarness{48000.0, 8}};
+  auto& engine{harness.engine()};
+  harness.load(contexts.context0.path(), 0);
+  harness.setParameter(Parameters::EngineParameterAddress::stealingPolicy, 1.0);
+  XCTAssertEqual(Engine::StealingPolicy::audibility, engine.stealingPolicy());
+
+  auto mixer{harness.createMixer(1)};
+
+  // With 8 voices, one is held in reserve for fading out stolen voices.
+  for (int note = 60; note < 67; ++note) harness.sendNoteOn(note);
+  harness.renderOnce(mixer);
+  harness.sendNoteOff(62);
+  harness.renderOnce(mixer);
+  XCTAssertEqual(7, engine.activeVoiceCount());
+
+  // The new note uses the reserve voice while the released voice fades out.
+  harness.sendNoteOn(70);
+  XCTAssertEqual(8, engine.activeVoiceCount());
+  XCTAssertEqual(1, engine.stolenVoiceCount());
+
+  harness.renderOnce(mixer);
+  XCTAssertEqual(7, engine.activeVoiceCount());
+
+  // All voices busy -- the next note must take over a voice right away.
+  harness.sendNoteOn(71);
+  harness.sendNoteOn(72);
+  XCTAssertEqual(8, engine.activeVoiceCount());
+  XCTAssertEqual(3, engine.stolenVoiceCount());
+}
+
+- (void)testEngineAudibilityVoiceStealingKeepsReserveWithFewVoices
+{
+  auto harness{TestEngineHarness{48000.0, 4}};
+  auto& engine{harness.engine()};
+  harness.load(contexts.context0.path(), 0);
+  harness.setParameter(Parameters::EngineParameterAddress::stealingPolicy, 1.0);
+  auto mixer{harness.createMixer(1)};
+
+  // Even with fewer than 8 voices, one is held in reserve so the stolen voice fades out instead of stopping.
+  for (int note = 60; note < 63; ++note) harness.sendNoteOn(note);
+  harness.renderOnce(mixer);
+  harness.sendNoteOn(63);
+  XCTAssertEqual(4, engine.activeVoiceCount());
+  XCTAssertEqual(1, engine.stolenVoiceCount());
+
+  // Only the voice that is already fading is cut short for the next note.
+  harness.sendNoteOn(64);
+  XCTAssertEqual(4, engine.activeVoiceCount());
+  XCTAssertEqual(2, engine.stolenVoiceCount());
+
+  harness.renderOnce(mixer);
+  XCTAssertEqual(3, engine.activeVoiceCount());
+}
+
+- (void)testEngineTelemetry
+{
+  auto harness{TestEngineHarness{48000.0, 8}};
+  auto& engine{harness.engine()};
+  auto mixer{harness.createMixer(1)};
+
+  // No preset loaded yet so the note is dropped
+  harness.sendNoteOn(60);
+  XCTAssertEqual(1, engine.telemetry().droppedNoteOnCount());
+
+  harness.load(contexts.context0.path(), 0);
+  for (int note = 60; note < 69; ++note) harness.sendNoteOn(note);
+  harness.renderOnce(mixer);
+
+  auto snapshot = engine.telemetry().snapshot();
+  XCTAssertEqual(1, snapshot.blockCount);
+  XCTAssertEqual(10, snapshot.midiEventCount);
+  XCTAssertEqual(10, snapshot.peakMIDIEventsPerBlock);
+  XCTAssertEqual(8, snapshot.peakActiveVoiceCount);
+  XCTAssertEqual(1, snapshot.stolenVoiceCount);
+  XCTAssertEqual(engine.stolenVoiceCount(), snapshot.stolenVoiceCount);
+  XCTAssertGreaterThan(snapshot.renderTimeMaximum, 0.0);
+  XCTAssertEqual(0, snapshot.culledVoiceCount);
+
+  // Released voices stop once they are inaudible
+  harness.setParameter(Parameters::EngineParameterAddress::voiceCullThreshold, -40.0);
+  for (int note = 61; note < 69; ++note) harness.sendNoteOff(note);
+  for (int block = 0; block < 200 && engine.activeVoiceCount() > 0; ++block) harness.renderOnce(mixer);
+  XCTAssertGreaterThan(engine.telemetry().culledVoiceCount(), 0);
+  XCTAssertEqual(engine.telemetry().snapshot().midiEventCount, 18);
+
+  engine.resetTelemetry();
+  XCTAssertEqual(0, engine.telemetry().blockCount());
+  XCTAssertEqual(0, engine.stolenVoiceCount());
+}
+
+- (void)testSynthesizerCoreWithoutAUv3
+{
+  Synthesizer synth(48000.0, 32, SF2::Render::Voice::Sample::Interpolator::linear);
+  XCTAssertEqual(48000.0, synth.sampleRate());
+
+  synth.processMIDIEvent(Synthesizer::createLoadFileUsePreset(contexts.context0.path(), 0));
+  std::array<uint8_t, 3> noteOn{0x90, 60, 127};
+  synth.processMIDIEvent(noteOn);
+  XCTAssertEqual(1, synth.activeVoiceCount());
+
+  synth.setParameter(valueOf(Parameters::EngineParameterAddress::portamentoModeEnabled), 1.0);
+  XCTAssertTrue(synth.portamentoModeEnabled());
+
+  synth.setSampleRate(44100.0);
+  XCTAssertEqual(44100.0, synth.sampleRate());
+}
+
+- (void)testSynthesizerRenderWithEventSpan
+{
+  std::array<uint8_t, 3> noteOn{0x90, 60, 127};
+  std::array<uint8_t, 3> noteOff{0x80, 60, 0};
+  auto pan = valueOf(Index::pan);
+
+  // Render the same events once through `render` and once by hand, splitting at the event frames.
+  Synthesizer first(48000.0, 32, SF2::Render::Voice::Sample::Interpolator::linear);
+  first.processMIDIEvent(Synthesizer::createLoadFileUsePreset(contexts.context0.path(), 0));
+  Synthesizer second(48000.0, 32, SF2::Render::Voice::Sample::Interpolator::linear);
+  second.processMIDIEvent(Synthesizer::createLoadFileUsePreset(contexts.context0.path(), 0));
+
+  std::vector<AUValue> firstLeft(512, 0.0f), firstRight(512, 0.0f);
+  std::vector<AUValue*> firstDry{firstLeft.data(), firstRight.data()};
+  std::vector<AUValue> secondLeft(512, 0.0f), secondRight(512, 0.0f);
+  std::vector<AUValue*> secondDry{secondLeft.data(), secondRight.data()};
+  std::vector<AUValue*> none{};
+
+  std::vector<RenderEvent> events{
+    RenderEvent::midi(100, noteOn),
+    RenderEvent::parameter(300, pan, 500),
+    RenderEvent::midi(400, noteOff)
+  };
+  first.render(events, Mixer(DSPHeaders::BusBuffers(firstDry), DSPHeaders::BusBuffers(none),
+                             DSPHeaders::BusBuffers(none)), 512);
+  XCTAssertEqual(firstDry[0], firstLeft.data());
+  XCTAssertEqual(firstDry[1], firstRight.data());
+
+  Mixer mixer{DSPHeaders::BusBuffers(secondDry), DSPHeaders::BusBuffers(none), DSPHeaders::BusBuffers(none)};
+  second.renderInto(mixer, 100);
+  mixer.shiftOver(100);
+  second.processMIDIEvent(noteOn);
+  second.renderInto(mixer, 200);
+  mixer.shiftOver(200);
+  second.setParameter(pan, 500);
+  second.renderInto(mixer, 100);
+  mixer.shiftOver(100);
+  second.processMIDIEvent(noteOff);
+  second.renderInto(mixer, 112);
+
+  XCTAssertEqual(firstLeft[99], 0.0f);
+  XCTAssertNotEqual(firstLeft[200], 0.0f);
+  for (size_t index = 0; index < firstLeft.size(); ++index) {
+    XCTAssertEqual(firstLeft[index], secondLeft[index]);
+    XCTAssertEqual(firstRight[index], secondRight[index]);
+  }
+}
+
+- (void)testSynthesizerCommandQueue
+{
+  IO::File::LoadResponse response;
+  auto soundFont = SF2::Render::SoundFont::load(contexts.context0.path(), response);
+  XCTAssertEqual(response, IO::File::LoadResponse::ok);
+  std::weak_ptr<const SF2::Render::SoundFont> watcher{soundFont};
+
+  Synthesizer synth(48000.0, 32, SF2::Render::Voice::Sample::Interpolator::linear);
+  std::vector<AUValue> left(64, 0.0f), right(64, 0.0f);
+  std::vector<AUValue*> dry{left.data(), right.data()};
+  std::vector<AUValue*> none{};
+  auto render = [&]() {
+    synth.renderInto(Mixer(DSPHeaders::BusBuffers(dry), DSPHeaders::BusBuffers(none), DSPHeaders::BusBuffers(none)),
+                     64);
+  };
+
+  // Nothing changes until the render thread picks up the commands.
+  XCTAssertTrue(synth.postSoundFont(soundFont, 1));
+  XCTAssertTrue(synth.post(Command::setVoiceLimit(4)));
+  XCTAssertTrue(synth.post(Command::setMode(Parameters::EngineParameterAddress::polyphonicModeEnabled, false)));
+  XCTAssertFalse(synth.hasActivePreset());
+  XCTAssertEqual(synth.voiceLimit(), 32);
+
+  render();
+  XCTAssertTrue(synth.commands().empty());
+  XCTAssertTrue(synth.hasActivePreset());
+  XCTAssertEqual(synth.soundFont(), soundFont);
+  XCTAssertEqual(synth.activePresetName(), soundFont->presets()[1].configuration().name());
+  XCTAssertEqual(synth.voiceLimit(), 4);
+  XCTAssertTrue(synth.monophonicModeEnabled());
+
+  // Only a bounded number of commands are applied per render.
+  for (size_t count = 0; count < Synthesizer::maxCommandsPerRender + 1; ++count) {
+    XCTAssertTrue(synth.post(Command::usePreset(0)));
+  }
+  render();
+  XCTAssertFalse(synth.commands().empty());
+  render();
+  XCTAssertTrue(synth.commands().empty());
+
+  // The control side keeps the sound font alive even when the caller lets go of it.
+  soundFont.reset();
+  XCTAssertFalse(watcher.expired());
+  XCTAssertEqual(synth.commands().retainedSoundFontCount(), 1);
+}
+
+- (void)testSynthesizerReportsSilenceWhenIdle
+{
+  std::array<uint8_t, 3> noteOn{0x90, 60, 127};
+  Synthesizer synth(48000.0, 32, SF2::Render::Voice::Sample::Interpolator::linear);
+  synth.processMIDIEvent(Synthesizer::createLoadFileUsePreset(contexts.context0.path(), 0));
+
+  // Fill the busses with a marker to show that an idle render does not touch them, not even the sends.
+  std::vector<AUValue> left(512, 1.0f), right(512, 1.0f), chorusLeft(512, 1.0f), chorusRight(512, 1.0f);
+  std::vector<AUValue*> dry{left.data(), right.data()};
+  std::vector<AUValue*> chorus{chorusLeft.data(), chorusRight.data()};
+  std::vector<AUValue*> none{};
+  Mixer mixer{DSPHeaders::BusBuffers(dry), DSPHeaders::BusBuffers(chorus), DSPHeaders::BusBuffers(none)};
+
+  XCTAssertTrue(synth.isIdle());
+  XCTAssertTrue(synth.renderInto(mixer, 512));
+  XCTAssertEqual(left[0], 1.0f);
+  XCTAssertEqual(chorusRight[511], 1.0f);
+  XCTAssertEqual(synth.telemetry().idleBlockCount(), 1);
+  XCTAssertEqual(synth.telemetry().blockCount(), 0);
+
+  std::vector<RenderEvent> events{RenderEvent::midi(256, noteOn)};
+  XCTAssertFalse(synth.render(events, mixer, 512));
+  XCTAssertFalse(synth.isIdle());
+  XCTAssertEqual(left[255], 1.0f);
+  XCTAssertNotEqual(left[511], 1.0f);
+
+  synth.processMIDIEvent(Synthesizer::createAllSoundOff());
+  XCTAssertTrue(synth.isIdle());
+  XCTAssertTrue(synth.renderInto(mixer, 512));
+
+  // Idle blocks stay out of the render times and averages. The part of the second block before the note ON is idle too.
+  auto snapshot = synth.telemetry().snapshot();
+  XCTAssertEqual(snapshot.idleBlockCount, 3);
+  XCTAssertEqual(snapshot.blockCount, 1);
+  XCTAssertEqual(snapshot.averageActiveVoiceCount, double(snapshot.peakActiveVoiceCount));
+}
+
 @end
@@ -0,0 +1,86 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#include <XCTest/XCTest.h>
+
+#include "SF2Lib/Render/Engine/Governor.hpp"
+
+using namespace SF2::Render::Engine;
+
+@interface GovernorTests : XCTestCase
+
+@end
+
+@implementation GovernorTests
+
+- (void)testDisabledByDefault {
+  Governor governor;
+  XCTAssertFalse(governor.enabled());
+  XCTAssertFalse(governor.update(2.0, 1.0));
+  XCTAssertEqual(governor.level(), 0);
+  XCTAssertEqual(governor.overloadCount(), 0);
+  XCTAssertEqual(governor.voiceLimit(32), 32);
+  XCTAssertEqual(governor.interpolator(Governor::Interpolator::cubic4thOrder), Governor::Interpolator::cubic4thOrder);
+}
+
+- (void)testDegradesUnderLoad {
+  Governor governor;
+  governor.setEnabled(true);
+  XCTAssertTrue(governor.update(1.5, 1.0));
+  XCTAssertEqual(governor.level(), 1);
+  XCTAssertEqual(governor.overloadCount(), 1);
+  XCTAssertEqual(governor.interpolator(Governor::Interpolator::cubic4thOrder), Governor::Interpolator::linear);
+  XCTAssertFalse(governor.shortenReleases());
+
+  // Level is held for a few blocks before rising again
+  for (size_t count = 1; count < Governor::degradeHoldBlockCount; ++count) {
+    XCTAssertFalse(governor.update(0.9, 1.0));
+  }
+  XCTAssertTrue(governor.update(0.9, 1.0));
+  XCTAssertEqual(governor.level(), 2);
+  XCTAssertTrue(governor.shortenReleases());
+  XCTAssertEqual(governor.voiceLimit(32), 32);
+
+  for (size_t count = 0; count < Governor::degradeHoldBlockCount * Governor::maxLevel; ++count) {
+    governor.update(0.9, 1.0);
+  }
+  XCTAssertEqual(governor.level(), Governor::maxLevel);
+  XCTAssertEqual(governor.voiceLimit(32), 16);
+  XCTAssertEqual(governor.degradeCount(), Governor::maxLevel);
+}
+
+- (void)testRestoresWhenLoadDrops {
+  Governor governor;
+  governor.setEnabled(true);
+  governor.update(1.5, 1.0);
+  XCTAssertEqual(governor.level(), 1);
+
+  // Let the smoothed load decay below half of the limit and then wait for the restore period.
+  size_t blocks = 0;
+  while (governor.level() > 0 && blocks < 1000) {
+    governor.update(0.0, 1.0);
+    ++blocks;
+  }
+  XCTAssertEqual(governor.level(), 0);
+  XCTAssertTrue(blocks >= Governor::restoreBlockCount);
+}
+
+- (void)testDisablingRestoresQuality {
+  Governor governor;
+  governor.setEnabled(true);
+  governor.update(1.5, 1.0);
+  XCTAssertEqual(governor.level(), 1);
+  governor.setEnabled(false);
+  XCTAssertEqual(governor.level(), 0);
+  XCTAssertEqual(governor.load(), 0.0);
+}
+
+- (void)testLoadLimit {
+  Governor governor;
+  XCTAssertEqual(governor.loadLimit(), Governor::defaultLoadLimit);
+  governor.setLoadLimit(2.0);
+  XCTAssertEqual(governor.loadLimit(), 1.0);
+  governor.setLoadLimit(0.0);
+  XCTAssertEqualWithAccuracy(governor.loadLimit(), 0.1, 1e-6);
+}
+
+@end
@@ -0,0 +1,73 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#include <XCTest/XCTest.h>
+
+#include "SF2Lib/Render/Engine/Mixer.hpp"
+
+using namespace SF2::Render::Engine;
+
+@interface MixerTests : XCTestCase
+
+@end
+
+@implementation MixerTests
+
+- (void)testAddBlock {
+  std::array<AUValue, 8> dryLeft{}, dryRight{}, chorusLeft{}, chorusRight{};
+  std::vector<AUValue*> dryBuffers{dryLeft.data(), dryRight.data()};
+  std::vector<AUValue*> chorusBuffers{chorusLeft.data(), chorusRight.data()};
+  std::vector<AUValue*> reverbBuffers{};
+
+  Mixer mixer{DSPHeaders::BusBuffers(dryBuffers), DSPHeaders::BusBuffers(chorusBuffers),
+    DSPHeaders::BusBuffers(reverbBuffers)};
+
+  std::array<SF2::Float, 4> samples{1.0, -1.0, 0.5, 0.25};
+  mixer.add(2, samples.data(), samples.size(), 0.5, 0.25, 0.5, 1.0);
+  mixer.add(2, samples.data(), 2, 0.5, 0.25, 0.5, 1.0);
+
+  XCTAssertEqual(dryLeft[0], 0.0);
+  XCTAssertEqual(dryLeft[1], 0.0);
+  XCTAssertEqual(dryLeft[2], 1.0);
+  XCTAssertEqual(dryLeft[3], -1.0);
+  XCTAssertEqual(dryLeft[4], 0.25);
+  XCTAssertEqual(dryLeft[5], 0.125);
+  XCTAssertEqual(dryLeft[6], 0.0);
+
+  XCTAssertEqual(dryRight[2], 0.5);
+  XCTAssertEqual(dryRight[3], -0.5);
+  XCTAssertEqual(dryRight[4], 0.125);
+  XCTAssertEqual(dryRight[5], 0.0625);
+
+  XCTAssertEqual(chorusLeft[2], 0.5);
+  XCTAssertEqual(chorusLeft[5], 0.0625);
+  XCTAssertEqual(chorusRight[2], 0.25);
+  XCTAssertEqual(chorusRight[6], 0.0);
+}
+
+- (void)testAddRamped {
+  std::array<AUValue, 4> left{}, right{};
+  std::vector<AUValue*> dryBuffers{left.data(), right.data()};
+  std::vector<AUValue*> empty{};
+
+  Mixer mixer{DSPHeaders::BusBuffers(dryBuffers), DSPHeaders::BusBuffers(empty), DSPHeaders::BusBuffers(empty)};
+  std::array<SF2::Float, 4> samples{1.0, 1.0, 1.0, 1.0};
+  mixer.addRamped(0, samples.data(), samples.size(), 0.0, 1.0, 0.25, -0.25, 0.0, 0.0);
+  XCTAssertEqual(left[0], 0.25);
+  XCTAssertEqual(left[3], 1.0);
+  XCTAssertEqual(right[0], 0.75);
+  XCTAssertEqual(right[3], 0.0);
+}
+
+- (void)testAddNothing {
+  std::array<AUValue, 4> left{}, right{};
+  std::vector<AUValue*> dryBuffers{left.data(), right.data()};
+  std::vector<AUValue*> empty{};
+
+  Mixer mixer{DSPHeaders::BusBuffers(dryBuffers), DSPHeaders::BusBuffers(empty), DSPHeaders::BusBuffers(empty)};
+  std::array<SF2::Float, 1> samples{1.0};
+  mixer.add(0, samples.data(), 0, 1.0, 1.0, 1.0, 1.0);
+  XCTAssertEqual(left[0], 0.0);
+  XCTAssertEqual(right[0], 0.0);
+}
+
+@end
@@ -31,6 +31,18 @@ using namespace SF2::Render::Engine;
   XCTAssertEqual(cache.size(), 3);
 }
 
+- (void)testOldest {
+  OldestVoiceCollection<96> cache{4};
+  auto v1 = cache.voiceOn();
+  auto v2 = cache.voiceOn();
+  auto v3 = cache.voiceOn();
+  XCTAssertEqual(cache.oldest(), v1);
+  cache.voiceOff(v1);
+  XCTAssertEqual(cache.oldest(), v2);
+  cache.voiceOff(v3);
+  XCTAssertEqual(cache.oldest(), v2);
+}
+
 static int countActive(const OldestVoiceCollection<96>& cache) noexcept {
   auto active = 0;
   for (auto _ : cache) ++active;
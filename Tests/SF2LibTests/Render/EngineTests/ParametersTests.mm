@@ -0,0 +1,119 @@
+// Copyright © 2023 Brad Howes. All rights reserved.
+
+#include <XCTest/XCTest.h>
+
+#include "SF2Lib/Render/Engine/Parameters.hpp"
+
+using namespace SF2::Render::Engine;
+using Index = SF2::Entity::Generator::Index;
+
+@interface ParametersTests : XCTestCase
+
+- (void)testChangesGatherUntilCleared {
+  Parameters parameters;
+  XCTAssertEqual(parameters.pendingCount(), 0);
+  parameters.setLiveValue(Index::pan, 100);
+  parameters.setLiveValue(Index::initialAttenuation, 20);
+  parameters.setLiveValue(Index::pan, 200);
+  XCTAssertEqual(parameters.pendingCount(), 2);
+  XCTAssertEqual(parameters.liveValue(Index::pan), 200);
+
+  parameters.clearPending();
+  XCTAssertEqual(parameters.pendingCount(), 0);
+  parameters.setLiveValue(Index::pan, 300);
+  XCTAssertEqual(parameters.pendingCount(), 1);
+
+  parameters.reset();
+  XCTAssertEqual(parameters.pendingCount(), 0);
+}
+
+@end
+
+@implementation ParametersTests
+
+- (void)testRampWithoutLiveValueIsImmediate {
+  Parameters parameters;
+  XCTAssertFalse(parameters.startRamp(Index::pan, 250, 1'000));
+  XCTAssertFalse(parameters.isRamping());
+  XCTAssertEqual(parameters.liveValue(Index::pan), 250);
+}
+
+- (void)testRampAdvancesPerBlock {
+  Parameters parameters;
+  parameters.setLiveValue(Index::pan, -500);
+  XCTAssertTrue(parameters.startRamp(Index::pan, 500, 640));
+  XCTAssertTrue(parameters.isRamping());
+  XCTAssertEqual(parameters.liveValue(Index::pan), -500);
+
+  parameters.clearPending();
+  size_t changes = 0;
+  auto advance = [&](AUAudioFrameCount frameCount) {
+    parameters.advanceRamps(frameCount);
+    changes += parameters.pendingCount();
+    parameters.clearPending();
+  };
+
+  advance(64);
+  XCTAssertEqual(parameters.liveValue(Index::pan), -400);
+  XCTAssertEqual(changes, 1);
+
+  for (int block = 1; block < 9; ++block) advance(64);
+  XCTAssertEqual(parameters.liveValue(Index::pan), 400);
+  XCTAssertTrue(parameters.isRamping());
+
+  // Advancing past the end lands exactly on the target.
+  advance(512);
+  XCTAssertEqual(parameters.liveValue(Index::pan), 500);
+  XCTAssertFalse(parameters.isRamping());
+  XCTAssertEqual(changes, 10);
+}
+
+- (void)testSetLiveValueStopsRamp {
+  Parameters parameters;
+  parameters.setLiveValue(Index::initialAttenuation, 0);
+  parameters.setLiveValue(Index::pan, 0);
+  XCTAssertTrue(parameters.startRamp(Index::initialAttenuation, 960, 960));
+  XCTAssertTrue(parameters.startRamp(Index::pan, 100, 100));
+  parameters.setLiveValue(Index::initialAttenuation, 10);
+  XCTAssertTrue(parameters.isRamping());
+
+  parameters.clearPending();
+  parameters.advanceRamps(100);
+  XCTAssertEqual(parameters.liveValue(Index::initialAttenuation), 10);
+  XCTAssertEqual(parameters.liveValue(Index::pan), 100);
+  XCTAssertEqual(parameters.pendingCount(), 1);
+  XCTAssertFalse(parameters.isRamping());
+}
+
+- (void)testNewRampContinuesFromCurrentValue {
+  Parameters parameters;
+  parameters.setLiveValue(Index::pan, 0);
+  XCTAssertTrue(parameters.startRamp(Index::pan, 400, 400));
+  parameters.advanceRamps(100);
+  XCTAssertEqual(parameters.liveValue(Index::pan), 100);
+  XCTAssertTrue(parameters.startRamp(Index::pan, -100, 200));
+  parameters.advanceRamps(100);
+  XCTAssertEqual(parameters.liveValue(Index::pan), 0);
+  parameters.reset();
+  XCTAssertFalse(parameters.isRamping());
+}
+
+- (void)testChangesGatherUntilCleared {
+  Parameters parameters;
+  XCTAssertEqual(parameters.pendingCount(), 0);
+  parameters.setLiveValue(Index::pan, 100);
+  parameters.setLiveValue(Index::initialAttenuation, 20);
+  parameters.setLiveValue(Index::pan, 200);
+  XCTAssertEqual(parameters.pendingCount(), 2);
+  XCTAssertEqual(parameters.liveValue(Index::pan), 200);
+
+  parameters.clearPending();
+  XCTAssertEqual(parameters.pendingCount(), 0);
+  parameters.setLiveValue(Index::pan, 300);
+  XCTAssertEqual(parameters.pendingCount(), 1);
+
+  parameters.reset();
+  XCTAssertEqual(parameters.pendingCount(), 0);
+}
+
+@end
@@ -0,0 +1,124 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#include <XCTest/XCTest.h>
+
+#include <memory>
+
+#include "SF2Lib/Render/Engine/RenderProfile.hpp"
+
+using namespace SF2::Render;
+using namespace SF2::Render::Engine;
+
+@interface RenderProfileTests : XCTestCase
+
+@end
+
+namespace {
+using Profile = RenderProfile<8>;
+int zoneA;
+int zoneB;
+}
+
+@implementation RenderProfileTests
+
+- (void)testStageClock {
+  Voice::StageClock clock;
+  clock.add(Voice::Stage::sample, 100);
+  clock.add(Voice::Stage::mix, 20);
+  clock.addSamples(16);
+  if constexpr (Voice::StageClock::enabled) {
+    XCTAssertEqual(clock.ticks()[size_t(Voice::Stage::sample)], 100);
+    XCTAssertEqual(clock.ticks()[size_t(Voice::Stage::mix)], 20);
+    XCTAssertEqual(clock.samples(), 16);
+  } else {
+    XCTAssertEqual(clock.ticks()[size_t(Voice::Stage::sample)], 0);
+    XCTAssertEqual(clock.samples(), 0);
+  }
+  clock.clear();
+  XCTAssertEqual(clock.ticks()[size_t(Voice::Stage::sample)], 0);
+  XCTAssertEqual(clock.samples(), 0);
+  XCTAssertEqual(std::string(Voice::stageName(Voice::Stage::modulation)), "modulation");
+}
+
+- (void)testAssignCountsVoices {
+  auto profile = std::make_unique<Profile>();
+  profile->assign(0, 3, &zoneA, 0, 59, "Piano C3");
+  profile->assign(1, 3, &zoneB, 60, 127, "Piano C5");
+  profile->assign(2, 3, &zoneB, 60, 127, "Piano C5");
+
+  auto snapshot = profile->snapshot();
+  XCTAssertEqual(snapshot.presets.size(), 1);
+  XCTAssertEqual(snapshot.presets[0].presetIndex, 3);
+  XCTAssertEqual(snapshot.presets[0].voiceCount, 3);
+  XCTAssertEqual(snapshot.zones.size(), 2);
+  for (const auto& zone : snapshot.zones) {
+    if (zone.keyLow == 0) {
+      XCTAssertEqual(zone.keyHigh, 59);
+      XCTAssertEqual(zone.sampleName, "Piano C3");
+      XCTAssertEqual(zone.voiceCount, 1);
+    } else {
+      XCTAssertEqual(zone.keyHigh, 127);
+      XCTAssertEqual(zone.sampleName, "Piano C5");
+      XCTAssertEqual(zone.voiceCount, 2);
+    }
+  }
+}
+
+- (void)testRecordAttributesTicks {
+  if constexpr (!Voice::StageClock::enabled) return;
+  auto profile = std::make_unique<Profile>();
+  profile->assign(0, 1, &zoneA, 0, 127, "A");
+  profile->assign(1, 2, &zoneB, 0, 127, "B");
+
+  Voice::StageClock clock;
+  clock.add(Voice::Stage::sample, 100);
+  clock.add(Voice::Stage::filter, 50);
+  clock.addSamples(10);
+  profile->record(0, clock);
+  XCTAssertEqual(clock.samples(), 0);
+
+  clock.add(Voice::Stage::sample, 400);
+  clock.addSamples(20);
+  profile->record(1, clock);
+
+  auto snapshot = profile->snapshot();
+  XCTAssertEqual(snapshot.stageTicks[size_t(Voice::Stage::sample)], 500);
+  XCTAssertEqual(snapshot.stageTicks[size_t(Voice::Stage::filter)], 50);
+  XCTAssertEqual(snapshot.sampleCount, 30);
+  XCTAssertEqual(snapshot.overflowTicks, 0);
+
+  // Most expensive first
+  XCTAssertEqual(snapshot.presets.size(), 2);
+  XCTAssertEqual(snapshot.presets[0].presetIndex, 2);
+  XCTAssertEqual(snapshot.presets[0].ticks, 400);
+  XCTAssertEqual(snapshot.presets[0].sampleCount, 20);
+  XCTAssertEqual(snapshot.presets[1].ticks, 150);
+  XCTAssertEqual(snapshot.zones[0].sampleName, "B");
+}
+
+- (void)testOverflowAndReset {
+  auto profile = std::make_unique<Profile>();
+  for (size_t preset = 0; preset < Profile::presetCapacity; ++preset) profile->assign(0, preset, &zoneA, 0, 127, "A");
+  profile->assign(1, Profile::presetCapacity, &zoneA, 0, 127, "A");
+
+  Voice::StageClock clock;
+  clock.add(Voice::Stage::gain, 7);
+  profile->record(1, clock);
+
+  auto snapshot = profile->snapshot();
+  XCTAssertEqual(snapshot.presets.size(), Profile::presetCapacity);
+  XCTAssertEqual(snapshot.zones.size(), 1);
+  XCTAssertEqual(snapshot.zones[0].voiceCount, Profile::presetCapacity + 1);
+  if constexpr (Voice::StageClock::enabled) {
+    XCTAssertEqual(snapshot.overflowTicks, 7);
+    XCTAssertEqual(snapshot.zones[0].ticks, 7);
+  }
+
+  profile->reset();
+  snapshot = profile->snapshot();
+  XCTAssertTrue(snapshot.presets.empty());
+  XCTAssertTrue(snapshot.zones.empty());
+  XCTAssertEqual(snapshot.overflowTicks, 0);
+}
+
+@end
@@ -0,0 +1,105 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#include <XCTest/XCTest.h>
+
+#include "SF2Lib/Render/Engine/Telemetry.hpp"
+
+using namespace SF2::Render::Engine;
+
+@interface TelemetryTests : XCTestCase
+
+@end
+
+@implementation TelemetryTests
+
+- (void)testEmpty {
+  Telemetry telemetry;
+  auto snapshot = telemetry.snapshot();
+  XCTAssertEqual(snapshot.blockCount, 0);
+  XCTAssertEqual(snapshot.overrunCount, 0);
+  XCTAssertEqual(snapshot.renderTimeP50, 0.0);
+  XCTAssertEqual(snapshot.renderTimeP99, 0.0);
+  XCTAssertEqual(snapshot.averageActiveVoiceCount, 0.0);
+  XCTAssertEqual(snapshot.averageMIDIEventsPerBlock, 0.0);
+}
+
+- (void)testBucketIndex {
+  XCTAssertEqual(Telemetry::bucketIndex(0.0), 0);
+  XCTAssertEqual(Telemetry::bucketIndex(-1.0), 0);
+  XCTAssertEqual(Telemetry::bucketIndex(1.5e-6), 2);
+  XCTAssertEqual(Telemetry::bucketIndex(2.0e-6), Telemetry::bucketsPerOctave);
+  XCTAssertEqual(Telemetry::bucketIndex(1.0e3), Telemetry::histogramBucketCount - 1);
+  for (size_t index = 0; index < Telemetry::histogramBucketCount - 1; ++index) {
+    XCTAssertEqual(Telemetry::bucketIndex(Telemetry::bucketUpperBound(index) * 0.99), index);
+  }
+}
+
+- (void)testBlockStatistics {
+  Telemetry telemetry;
+  double deadline = 512.0 / 48'000.0;
+  for (int block = 0; block < 100; ++block) {
+    telemetry.recordBlock(block < 90 ? 100.0e-6 : 1.0e-3, deadline, size_t(block % 10), 2);
+  }
+  telemetry.recordBlock(20.0e-3, deadline, 32, 7);
+
+  auto snapshot = telemetry.snapshot();
+  XCTAssertEqual(snapshot.blockCount, 101);
+  XCTAssertEqual(snapshot.overrunCount, 1);
+  XCTAssertEqualWithAccuracy(snapshot.renderTimeP50, 100.0e-6, 20.0e-6);
+  XCTAssertEqualWithAccuracy(snapshot.renderTimeP99, 1.0e-3, 0.2e-3);
+  XCTAssertEqual(snapshot.renderTimeMaximum, 20.0e-3);
+  XCTAssertEqual(telemetry.renderTimePercentile(1.0), 20.0e-3);
+  XCTAssertEqual(snapshot.peakActiveVoiceCount, 32);
+  XCTAssertEqualWithAccuracy(snapshot.averageActiveVoiceCount, (450.0 + 32.0) / 101.0, 1.0e-9);
+  XCTAssertEqual(snapshot.midiEventCount, 207);
+  XCTAssertEqual(snapshot.peakMIDIEventsPerBlock, 7);
+  XCTAssertEqualWithAccuracy(snapshot.averageMIDIEventsPerBlock, 207.0 / 101.0, 1.0e-9);
+}
+
+- (void)testIdleBlocksAreOnlyCounted {
+  Telemetry telemetry;
+  double deadline = 512.0 / 48'000.0;
+  telemetry.recordBlock(200.0e-6, deadline, 4, 2);
+  for (int block = 0; block < 9; ++block) telemetry.recordIdleBlock(block == 0 ? 3 : 0);
+
+  auto snapshot = telemetry.snapshot();
+  XCTAssertEqual(snapshot.blockCount, 1);
+  XCTAssertEqual(snapshot.idleBlockCount, 9);
+  XCTAssertEqualWithAccuracy(snapshot.renderTimeP50, 200.0e-6, 40.0e-6);
+  XCTAssertEqual(snapshot.averageActiveVoiceCount, 4.0);
+  XCTAssertEqual(snapshot.midiEventCount, 5);
+  XCTAssertEqual(snapshot.peakMIDIEventsPerBlock, 3);
+  XCTAssertEqual(snapshot.averageMIDIEventsPerBlock, 2.0);
+
+  telemetry.reset();
+  snapshot = telemetry.snapshot();
+  XCTAssertEqual(snapshot.idleBlockCount, 0);
+  XCTAssertEqual(snapshot.midiEventCount, 0);
+}
+
+- (void)testCountersAndReset {
+  Telemetry telemetry;
+  telemetry.voiceStolen();
+  telemetry.voiceStolen();
+  telemetry.voiceCulled();
+  telemetry.noteOnDropped();
+  telemetry.recordBlock(1.0, 0.5, 4, 1);
+
+  auto snapshot = telemetry.snapshot();
+  XCTAssertEqual(snapshot.stolenVoiceCount, 2);
+  XCTAssertEqual(snapshot.culledVoiceCount, 1);
+  XCTAssertEqual(snapshot.droppedNoteOnCount, 1);
+  XCTAssertEqual(snapshot.overrunCount, 1);
+
+  telemetry.reset();
+  snapshot = telemetry.snapshot();
+  XCTAssertEqual(snapshot.blockCount, 0);
+  XCTAssertEqual(snapshot.overrunCount, 0);
+  XCTAssertEqual(snapshot.stolenVoiceCount, 0);
+  XCTAssertEqual(snapshot.culledVoiceCount, 0);
+  XCTAssertEqual(snapshot.droppedNoteOnCount, 0);
+  XCTAssertEqual(snapshot.peakActiveVoiceCount, 0);
+  XCTAssertEqual(snapshot.renderTimeMaximum, 0.0);
+}
+
+@end
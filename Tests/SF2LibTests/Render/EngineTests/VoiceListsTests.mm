@@ -0,0 +1,69 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#include <vector>
+
+#include <XCTest/XCTest.h>
+
+#include "SF2Lib/Render/Engine/VoiceLists.hpp"
+
+using namespace SF2::Render::Engine;
+
+@interface VoiceListsTests : XCTestCase
+
+@end
+
+@implementation VoiceListsTests
+
+static std::vector<size_t> contents(VoiceLists<4, 8>& lists, size_t list) noexcept {
+  std::vector<size_t> found;
+  lists.visit(list, [&](size_t voiceIndex) { found.push_back(voiceIndex); });
+  return found;
+}
+
+- (void)testInsertAndRemove {
+  VoiceLists<4, 8> lists;
+  XCTAssertTrue(lists.empty(0));
+  lists.insert(0, 3);
+  lists.insert(0, 5);
+  lists.insert(1, 2);
+  XCTAssertTrue(lists.contains(3));
+  XCTAssertFalse(lists.contains(4));
+  XCTAssertTrue(contents(lists, 0) == (std::vector<size_t>{5, 3}));
+  XCTAssertTrue(contents(lists, 1) == (std::vector<size_t>{2}));
+
+  lists.remove(5);
+  XCTAssertTrue(contents(lists, 0) == (std::vector<size_t>{3}));
+  lists.remove(5);
+  lists.remove(3);
+  XCTAssertTrue(lists.empty(0));
+  XCTAssertFalse(lists.contains(3));
+}
+
+- (void)testInsertMovesBetweenLists {
+  VoiceLists<4, 8> lists;
+  lists.insert(0, 1);
+  lists.insert(0, 2);
+  lists.insert(0, 3);
+  lists.insert(2, 2);
+  XCTAssertTrue(contents(lists, 0) == (std::vector<size_t>{3, 1}));
+  XCTAssertTrue(contents(lists, 2) == (std::vector<size_t>{2}));
+}
+
+- (void)testVisitorMayRemoveVisitedVoice {
+  VoiceLists<4, 8> lists;
+  for (size_t voiceIndex = 0; voiceIndex < 8; ++voiceIndex) lists.insert(voiceIndex % 2, voiceIndex);
+  size_t visited = 0;
+  lists.visit(0, [&](size_t voiceIndex) {
+    ++visited;
+    lists.remove(voiceIndex);
+  });
+  XCTAssertEqual(visited, 4);
+  XCTAssertTrue(lists.empty(0));
+  XCTAssertTrue(contents(lists, 1) == (std::vector<size_t>{7, 5, 3, 1}));
+
+  lists.clear();
+  XCTAssertTrue(lists.empty(1));
+  XCTAssertFalse(lists.contains(7));
+}
+
+@end
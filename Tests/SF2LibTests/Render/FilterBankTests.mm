@@ -0,0 +1,90 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#include <XCTest/XCTest.h>
+
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+#include "SF2Lib/Render/FilterBank.hpp"
+
+using namespace SF2;
+using namespace SF2::Render;
+
+@interface FilterBankTests : XCTestCase
+
+@end
+
+namespace {
+// The banked and scalar filters may round differently in 32-bit, and resonant filters amplify the difference.
+constexpr double sampleTolerance = std::is_same_v<Float, float> ? 1.0e-3 : 1.0e-9;
+}
+
+@implementation FilterBankTests
+
+- (void)testMatchesScalarFilters {
+  constexpr size_t lanes = 4;
+  constexpr size_t frames = 64;
+  FilterBank<lanes, frames> bank;
+
+  std::vector<LowPassFilter> scalar(lanes, LowPassFilter{44100.0});
+  std::vector<LowPassFilter> banked(lanes, LowPassFilter{44100.0});
+  std::array<Float, lanes> cutoffs{3000.0, 6000.0, 9000.0, 12000.0};
+  std::array<Float, lanes> resonances{0.0, 100.0, 200.0, 960.0};
+  for (size_t lane = 0; lane < lanes; ++lane) {
+    scalar[lane].update(cutoffs[lane], resonances[lane]);
+    banked[lane].update(cutoffs[lane], resonances[lane]);
+  }
+
+  std::array<std::array<Float, frames>, lanes> samples;
+  for (size_t block = 0; block < 3; ++block) {
+
+    // Change the settings of two filters so that their coefficients ramp during the block.
+    if (block == 1) {
+      scalar[1].update(7000.0, 300.0);
+      banked[1].update(7000.0, 300.0);
+      scalar[3].update(4000.0, 0.0);
+      banked[3].update(4000.0, 0.0);
+    }
+
+    for (size_t lane = 0; lane < lanes; ++lane) {
+      for (size_t frame = 0; frame < frames; ++frame) {
+        samples[lane][frame] = std::sin(Float(frame + block * frames) * 0.1 * (lane + 1));
+      }
+      bank.assign(banked[lane].lane(), samples[lane].data(), frames);
+    }
+
+    XCTAssertTrue(bank.full());
+    bank.process(frames);
+    XCTAssertEqual(bank.size(), 0);
+
+    for (size_t lane = 0; lane < lanes; ++lane) {
+      for (size_t frame = 0; frame < frames; ++frame) {
+        auto expected = scalar[lane].transform(std::sin(Float(frame + block * frames) * 0.1 * (lane + 1)));
+        XCTAssertEqualWithAccuracy(samples[lane][frame], expected, sampleTolerance);
+      }
+    }
+  }
+}
+
+- (void)testPartialLanes {
+  FilterBank<4, 8> bank;
+  LowPassFilter scalar{44100.0};
+  LowPassFilter banked{44100.0};
+  scalar.update(5000.0, 100.0);
+  banked.update(5000.0, 100.0);
+
+  std::array<Float, 8> samples{1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+  bank.assign(banked.lane(), samples.data(), 5);
+  bank.process(8);
+
+  XCTAssertEqualWithAccuracy(samples[0], scalar.transform(1.0), 1.0e-12);
+  for (size_t frame = 1; frame < 5; ++frame) {
+    XCTAssertEqualWithAccuracy(samples[frame], scalar.transform(0.0), 1.0e-12);
+  }
+
+  // Samples past the assigned count are left alone
+  XCTAssertEqual(samples[5], 0.0);
+}
+
+@end
@@ -0,0 +1,89 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#include <algorithm>
+#include <cmath>
+
+#include <XCTest/XCTest.h>
+
+#include "SF2Lib/DSP.hpp"
+#include "SF2Lib/Render/LowPassFilter.hpp"
+
+using namespace SF2;
+using namespace SF2::Render;
+
+@interface LowPassFilterTests : XCTestCase
+
+@end
+
+namespace {
+constexpr double coefficientTolerance = std::is_same_v<Float, float> ? 1.0e-6 : 1.0e-9;
+}
+
+@implementation LowPassFilterTests
+
+- (void)testCoefficientsMatchDirectCalculation {
+  Float sampleRate = 44100.0;
+  LowPassFilter filter{sampleRate};
+  for (auto cents : {0, 1500, 6000, 9876, 13500}) {
+    for (auto centibels : {0, 100, 480, 960}) {
+      auto frequency = DSP::clamp(DSP::centsToFrequency(cents), 5_F, 0.45_F * sampleRate);
+      auto expected = LowPassFilter::Coefficients::LPF2(sampleRate, frequency, DSP::centibelsToResonance(centibels));
+      auto found = filter.coefficients(cents, centibels);
+      XCTAssertEqualWithAccuracy(found.a0, expected.a0, coefficientTolerance);
+      XCTAssertEqualWithAccuracy(found.a1, expected.a1, coefficientTolerance);
+      XCTAssertEqualWithAccuracy(found.a2, expected.a2, coefficientTolerance);
+      XCTAssertEqualWithAccuracy(found.b1, expected.b1, coefficientTolerance);
+      XCTAssertEqualWithAccuracy(found.b2, expected.b2, coefficientTolerance);
+    }
+  }
+}
+
+- (void)testControlRateUpdates {
+  LowPassFilter filter{44100.0};
+  XCTAssertTrue(filter.updateDue());
+  for (size_t count = 1; count < LowPassFilter::controlInterval; ++count) {
+    XCTAssertFalse(filter.updateDue());
+  }
+  XCTAssertTrue(filter.updateDue());
+  filter.reset();
+  XCTAssertTrue(filter.updateDue());
+}
+
+- (void)testBypass {
+  LowPassFilter filter{44100.0};
+  filter.update(LowPassFilter::maximumCutoff, 0.0);
+#if ENABLE_LOWPASS_FILTER_BYPASS == 1
+  XCTAssertTrue(filter.isBypassed());
+  XCTAssertEqual(filter.transform(0.5), 0.5);
+#else
+  XCTAssertFalse(filter.isBypassed());
+#endif
+  filter.update(6000.0, 100.0);
+  XCTAssertFalse(filter.isBypassed());
+}
+
+- (void)testLeavingBypassDoesNotStep {
+  Float sampleRate = 44100.0;
+  LowPassFilter filter{sampleRate};
+  auto signal = [=](size_t index) { return 0.5_F * std::sin(2_F * Float(M_PI) * 440_F * Float(index) / sampleRate); };
+
+  size_t index = 0;
+  filter.update(LowPassFilter::maximumCutoff, 0.0);
+  Float last = 0.0;
+  for (; index < 125; ++index) last = filter.transform(signal(index));
+
+  // Cross the bypass threshold near a peak of the sine. The output must not jump from where the bypassed signal was.
+  filter.update(9000.0, 0.0);
+  XCTAssertFalse(filter.isBypassed());
+  Float largestStep = 0.0;
+  for (auto end = index + 4 * LowPassFilter::controlInterval; index < end; ++index) {
+    auto value = filter.transform(signal(index));
+    largestStep = std::max(largestStep, std::abs(value - last));
+    last = value;
+  }
+
+  // Largest change between two samples of the unfiltered sine is about 0.031
+  XCTAssertLessThan(largestStep, 0.04);
+}
+
+@end
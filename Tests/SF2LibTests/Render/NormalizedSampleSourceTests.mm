@@ -1,6 +1,8 @@
 // Copyright © 2021 Brad Howes. All rights reserved.
 
 #include <XCTest/XCTest.h>
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 #include "SampleBasedContexts.hpp"
@@ -49,6 +51,47 @@ static SF2::SampleVector values = {1.0, -1.0, 0.5, 0.25, -0.25, -0.5, -0.6, -0.7
   XCTAssertEqual(source[1], values[1]);
 }
 
+- (void)testPeaks {
+  NormalizedSampleSource source{values, header};
+  XCTAssertEqualWithAccuracy(source.peak(), 1.0, epsilon);
+  XCTAssertEqualWithAccuracy(source.loopPeak(), 0.25, epsilon);
+}
+
+- (void)testLinkedSources {
+  SF2::SampleVector all(200, 0.0);
+  for (size_t index = 0; index < all.size(); ++index) all[index] = std::sin(index * 0.1);
+  SF2::Entity::SampleHeader right{0, 60, 10, 50, 44100, 69, 0, 1, SF2::Entity::SampleHeader::Type::rightSample};
+  SF2::Entity::SampleHeader left{100, 160, 110, 150, 44100, 69, 0, 0, SF2::Entity::SampleHeader::Type::leftSample};
+  NormalizedSampleSource rightSource{all, right};
+  NormalizedSampleSource leftSource{all, left};
+  State::State state{44100.0, channelState, 69};
+
+  Generator linked{Interpolator::cubic4thOrder};
+  linked.configure(rightSource, state);
+  XCTAssertFalse(linked.isLinked());
+  linked.link(leftSource);
+  XCTAssertTrue(linked.isLinked());
+
+  Generator rightOnly{Interpolator::cubic4thOrder};
+  rightOnly.configure(rightSource, state);
+  Generator leftOnly{Interpolator::cubic4thOrder};
+  leftOnly.configure(leftSource, state);
+
+  // One position drives both streams, and each stream matches an independent generator of the same source.
+  for (int count = 0; count < 120; ++count) {
+    SF2::Float leftSample;
+    auto rightSample = linked.generate(1.3, true, leftSample);
+    XCTAssertEqual(rightSample, rightOnly.generate(1.3, true));
+    XCTAssertEqual(leftSample, leftOnly.generate(1.3, true));
+  }
+
+  XCTAssertEqual(linked.peak(false), std::max(rightSource.peak(), leftSource.peak()));
+
+  // Configuring again removes the link.
+  linked.configure(rightSource, state);
+  XCTAssertFalse(linked.isLinked());
+}
+
 - (void)testLoadSamplesPerformance0 {
   auto& file = contexts->context0.file();
   auto sampleEntries = file.sampleHeaders().size();
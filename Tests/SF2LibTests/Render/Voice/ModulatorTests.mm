@@ -227,4 +227,42 @@ using namespace SF2::Entity::Generator;
   XCTAssertEqualWithAccuracy(2.9765625, mod.value(*state), epsilon);
 }
 
+- (void)testSourceDependencies {
+  auto src = Source(Source::GeneralIndex::keyPressure);
+  State::Modulator mod{Modulator(src, Index::sustainVolumeEnvelope, 3.0,
+                                 Source(Source::CC(7)), Transformer())};
+  XCTAssertTrue(mod.dependsOn(State::SourceId::keyPressure));
+  XCTAssertTrue(mod.dependsOn(State::sourceIdFor(MIDI::ControlChange::volumeMSB)));
+  XCTAssertFalse(mod.dependsOn(State::SourceId::channelPressure));
+  XCTAssertEqual(2, mod.sources().count());
+}
+
+- (void)testStateSourceDependencies {
+  XCTAssertTrue(state->dependsOn(State::SourceId::noteOnVelocity));
+  XCTAssertTrue(state->dependsOn(State::SourceId::pitchWheel));
+  XCTAssertTrue(state->dependsOn(State::sourceIdFor(MIDI::ControlChange::volumeMSB)));
+  XCTAssertFalse(state->dependsOn(State::sourceIdFor(MIDI::ControlChange::sustainSwitch)));
+}
+
+- (void)testPartialUpdateMatchesFullUpdate {
+  MIDI::ChannelState otherChannelState;
+  State::State other{44100.0, otherChannelState};
+  state->updateStateMods();
+  other.updateStateMods();
+
+  channelState->setContinuousControllerValue(MIDI::ControlChange::volumeMSB, 37);
+  otherChannelState.setContinuousControllerValue(MIDI::ControlChange::volumeMSB, 37);
+  state->updateStateMods(State::sourceIdFor(MIDI::ControlChange::volumeMSB));
+  other.updateStateMods();
+
+  channelState->setPitchWheelValue(1234);
+  otherChannelState.setPitchWheelValue(1234);
+  state->updateStateMods(State::SourceId::pitchWheel);
+  other.updateStateMods();
+
+  for (auto pos = IndexIterator::begin(); pos != IndexIterator::end(); ++pos) {
+    XCTAssertEqualWithAccuracy(other.modulated(*pos), state->modulated(*pos), epsilon);
+  }
+}
+
 @end
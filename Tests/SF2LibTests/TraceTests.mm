@@ -0,0 +1,173 @@
+// Copyright © 2022 Brad Howes. All rights reserved.
+
+#include <XCTest/XCTest.h>
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SF2Lib/Trace/Collector.hpp"
+#include "SF2Lib/Trace/Export.hpp"
+#include "SF2Lib/Trace/RingBuffer.hpp"
+
+using namespace SF2::Trace;
+
+@interface TraceTests : XCTestCase
+
+@end
+
+@implementation TraceTests
+
+- (void)testRingBufferOrdering {
+  RingBuffer<int, 4> buffer;
+  XCTAssertTrue(buffer.empty());
+  for (int value = 1; value <= 4; ++value) XCTAssertTrue(buffer.push(value));
+  XCTAssertFalse(buffer.push(5));
+  XCTAssertEqual(buffer.size(), 4);
+  XCTAssertEqual(buffer.dropped(), 1);
+
+  std::vector<int> found;
+  XCTAssertEqual(buffer.drain([&](int value) { found.push_back(value); }), 4);
+  XCTAssertEqual(found, (std::vector<int>{1, 2, 3, 4}));
+  XCTAssertTrue(buffer.empty());
+
+  // Wrap around the end of the storage
+  for (int value = 6; value <= 8; ++value) XCTAssertTrue(buffer.push(value));
+  found.clear();
+  buffer.drain([&](int value) { found.push_back(value); });
+  XCTAssertEqual(found, (std::vector<int>{6, 7, 8}));
+}
+
+- (void)testRingBufferBoundedDrain {
+  RingBuffer<int, 8> buffer;
+  for (int value = 1; value <= 5; ++value) XCTAssertTrue(buffer.push(value));
+
+  std::vector<int> found;
+  XCTAssertEqual(buffer.drain([&](int value) { found.push_back(value); }, 2), 2);
+  XCTAssertEqual(found, (std::vector<int>{1, 2}));
+  XCTAssertEqual(buffer.size(), 3);
+  XCTAssertEqual(buffer.drain([&](int value) { found.push_back(value); }, 8), 3);
+  XCTAssertEqual(found, (std::vector<int>{1, 2, 3, 4, 5}));
+  XCTAssertTrue(buffer.empty());
+}
+
+- (void)testRingBufferAcrossThreads {
+  RingBuffer<int, 64> buffer;
+  constexpr int count = 100'000;
+  std::thread producer([&]() {
+    for (int value = 0; value < count; ++value) {
+      while (!buffer.push(value)) std::this_thread::yield();
+    }
+  });
+
+  int expected = 0;
+  bool inOrder = true;
+  while (expected < count) {
+    buffer.drain([&](int value) { inOrder = inOrder && value == expected; ++expected; });
+  }
+  producer.join();
+  XCTAssertTrue(inOrder);
+  XCTAssertEqual(expected, count);
+}
+
+- (void)testCollectorGathersThreads {
+  Collector collector;
+  collector.start(std::chrono::milliseconds(1));
+  XCTAssertTrue(collector.isRunning());
+
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < 4; ++thread) {
+    threads.emplace_back([&collector, thread]() {
+      for (int index = 0; index < 1'000; ++index) {
+        collector.record(Kind::begin, Id::noteOn, thread, index);
+        collector.record(Kind::end, Id::noteOn, thread, index);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  collector.stop();
+  XCTAssertFalse(collector.isRunning());
+
+  auto events = collector.take();
+  XCTAssertEqual(events.size() + collector.dropped(), 8'000);
+  for (size_t index = 1; index < events.size(); ++index) {
+    XCTAssertLessThanOrEqual(events[index - 1].timestamp, events[index].timestamp);
+  }
+  XCTAssertTrue(collector.take().empty());
+}
+
+- (void)testCollectorReusesBuffersOfExitedThreads {
+  Collector collector;
+  constexpr size_t threadsPerRound = 12;
+  constexpr size_t rounds = 4;
+  static_assert(threadsPerRound * rounds > Collector::maxThreadCount);
+
+  for (size_t round = 0; round < rounds; ++round) {
+    std::vector<std::thread> threads;
+    for (size_t thread = 0; thread < threadsPerRound; ++thread) {
+      threads.emplace_back([&collector, thread]() {
+        for (int index = 0; index < 10; ++index) {
+          collector.record(Kind::instant, Id::render, int32_t(thread), index);
+        }
+      });
+    }
+    for (auto& thread : threads) thread.join();
+    collector.drain();
+  }
+
+  XCTAssertEqual(collector.dropped(), 0);
+  XCTAssertEqual(collector.take().size(), threadsPerRound * rounds * 10);
+}
+
+- (void)testCollectorDropsWhenFull {
+  Collector collector;
+  for (size_t index = 0; index < Collector::eventsPerThread + 10; ++index) {
+    collector.record(Kind::instant, Id::midiIgnored);
+  }
+  XCTAssertEqual(collector.dropped(), 10);
+  XCTAssertEqual(collector.drain(), Collector::eventsPerThread);
+  XCTAssertEqual(collector.take().size(), Collector::eventsPerThread);
+}
+
+- (void)testChromeTraceExport {
+  std::vector<Event> events{
+    {1'000'000, 60, 100, Id::noteOn, Kind::begin, 0},
+    {1'002'500, 60, 100, Id::noteOn, Kind::end, 0},
+    {1'003'000, 0xF5, 0, Id::midiIgnored, Kind::instant, 1}
+  };
+  std::ostringstream os;
+  writeChromeTrace(os, events);
+  auto json = os.str();
+  XCTAssertEqual(json.find("{\"traceEvents\":["), 0);
+  XCTAssertNotEqual(json.find("\"name\":\"noteOn\",\"cat\":\"SF2Lib\",\"ph\":\"B\",\"ts\":0.000"), std::string::npos);
+  XCTAssertNotEqual(json.find("\"ph\":\"E\",\"ts\":2.500"), std::string::npos);
+  XCTAssertNotEqual(json.find("\"name\":\"midiIgnored\",\"cat\":\"SF2Lib\",\"ph\":\"i\",\"ts\":3.000,\"pid\":1,\"tid\":1,\"s\":\"t\""),
+                    std::string::npos);
+  XCTAssertNotEqual(json.find("\"args\":{\"arg0\":60,\"arg1\":100}"), std::string::npos);
+}
+
+- (void)testTextLogExport {
+  std::vector<Event> events{
+    {500, 60, 100, Id::noteOn, Kind::begin, 0},
+    {750, 3, 0, Id::stopVoice, Kind::end, 2}
+  };
+  std::ostringstream os;
+  writeTextLog(os, events);
+  XCTAssertEqual(os.str(), "           0 [0] begin noteOn 60 100\n         250 [2] end stopVoice 3 0\n");
+}
+
+- (void)testRecordPerformance {
+  auto collector = std::make_unique<Collector>();
+  auto ptr = collector.get();
+  [self measureBlock:^{
+    for (size_t index = 0; index < Collector::eventsPerThread; ++index) {
+      ptr->record(Kind::instant, Id::render, int32_t(index));
+    }
+    ptr->drain();
+    ptr->take();
+  }];
+}
+
+@end